@@ -67,3 +67,15 @@ if (san)
   target_link_libraries (keys_opts INTERFACE ${SAN_FLAG} ${SAN_LIB})
 endif ()
 
+
+#[===================================================================[
+   io_uring for bulk key file I/O (BulkFileIO). Without it, or on a
+   kernel without the needed operations, blocking POSIX calls are used.
+#]===================================================================]
+option (io_uring "Use io_uring for bulk key file I/O (Linux, liburing >= 2.2)" OFF)
+if (io_uring)
+  find_package (PkgConfig REQUIRED)
+  pkg_check_modules (liburing REQUIRED IMPORTED_TARGET liburing>=2.2)
+  target_compile_definitions (keys_opts INTERFACE KEYS_IO_URING=1)
+  target_link_libraries (keys_opts INTERFACE PkgConfig::liburing)
+endif ()
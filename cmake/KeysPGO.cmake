@@ -0,0 +1,63 @@
+#[===================================================================[
+   Link-time and profile-guided optimization, both opt-in:
+
+     -Dlto=ON         link-time optimization
+     -Dpgo=generate   instrument the build to write profiles to pgo_dir
+     -Dpgo=use        optimize with the profiles in pgo_dir
+
+   cmake/KeysPGOBuild.cmake runs the whole flow: it builds an
+   instrumented binary, trains it and rebuilds with the profile and LTO.
+   Only the tool's own code is profiled; libxrpl is used as built.
+#]===================================================================]
+
+option (lto "Build with link-time optimization" OFF)
+set (pgo "" CACHE STRING "Profile-guided optimization: generate or use")
+set_property (CACHE pgo PROPERTY STRINGS "" generate use)
+set (pgo_dir "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH
+  "Directory the PGO profiles are written to and read from")
+
+if (lto)
+  include (CheckIPOSupported)
+  check_ipo_supported (RESULT lto_supported OUTPUT lto_output)
+  if (NOT lto_supported)
+    message (FATAL_ERROR "Link-time optimization is not supported: ${lto_output}")
+  endif ()
+  set (CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+endif ()
+
+# GCC names profiles after the object file path; relative to the build
+# directory, the instrumented and optimized builds agree on the names
+if (is_gcc AND pgo)
+  target_compile_options (keys_opts
+    INTERFACE -fprofile-prefix-path=${CMAKE_BINARY_DIR})
+endif ()
+
+if (pgo STREQUAL "generate")
+  target_compile_options (keys_opts
+    INTERFACE
+      -fprofile-generate=${pgo_dir}
+      # The batch commands profile from several threads
+      $<$<BOOL:${is_gcc}>:-fprofile-update=atomic>)
+  target_link_libraries (keys_opts INTERFACE -fprofile-generate=${pgo_dir})
+elseif (pgo STREQUAL "use")
+  if (is_clang)
+    set (pgo_profile "${pgo_dir}/default.profdata")
+    if (NOT EXISTS "${pgo_profile}")
+      message (FATAL_ERROR "No merged profile at ${pgo_profile}")
+    endif ()
+    target_compile_options (keys_opts
+      INTERFACE -fprofile-use=${pgo_profile} -Wno-profile-instr-unprofiled)
+  else ()
+    if (NOT EXISTS "${pgo_dir}")
+      message (FATAL_ERROR "No profiles in ${pgo_dir}")
+    endif ()
+    target_compile_options (keys_opts
+      INTERFACE
+        -fprofile-use=${pgo_dir}
+        # Counters from several threads are not exact
+        -fprofile-correction
+        -Wno-missing-profile)
+  endif ()
+elseif (pgo)
+  message (FATAL_ERROR "pgo must be generate or use, not ${pgo}")
+endif ()
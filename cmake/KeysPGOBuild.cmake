@@ -0,0 +1,121 @@
+#[===================================================================[
+   Profile-guided, link-time optimized release build.
+
+   Run in script mode from the source directory:
+
+     cmake -DBUILD_DIR=.build/pgo \
+       "-DCONFIGURE_ARGS=-DCMAKE_TOOLCHAIN_FILE=<conan_toolchain.cmake>" \
+       -P cmake/KeysPGOBuild.cmake
+
+   This builds, each in its own directory under BUILD_DIR:
+
+     release       a plain release build, for comparison
+     instrumented  a build that writes profiles (-Dpgo=generate)
+     optimized     the build trained with the profiles (-Dpgo=use -Dlto=ON)
+
+   The instrumented build is trained on the workload below, and the same
+   workload is then timed with the release and optimized builds. The
+   optimized binary is BUILD_DIR/optimized/validator-keys.
+#]===================================================================]
+
+cmake_minimum_required (VERSION 3.23)
+
+if (NOT BUILD_DIR)
+  message (FATAL_ERROR "Set BUILD_DIR to the directory to build in")
+endif ()
+get_filename_component (source_dir "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+get_filename_component (build_dir "${BUILD_DIR}" ABSOLUTE)
+separate_arguments (configure_args UNIX_COMMAND "${CONFIGURE_ARGS}")
+set (profile_dir "${build_dir}/profile")
+set (rounds 3)
+
+include (ProcessorCount)
+ProcessorCount (procs)
+
+function (build name)
+  message (STATUS "Building ${name}")
+  execute_process (
+    COMMAND ${CMAKE_COMMAND} -S ${source_dir} -B ${build_dir}/${name}
+      -DCMAKE_BUILD_TYPE=Release
+      ${configure_args} ${ARGN}
+    COMMAND_ERROR_IS_FATAL ANY)
+  execute_process (
+    COMMAND ${CMAKE_COMMAND} --build ${build_dir}/${name} -j ${procs}
+    COMMAND_ERROR_IS_FATAL ANY)
+endfunction ()
+
+#[=========================================================[
+   The workload: key generation, token creation and signing
+   (the TokenBench and SignBench suites), and key file
+   writing, parsing and signing in bulk.
+#]=========================================================]
+function (run_workload dir)
+  set (work "${build_dir}/workload")
+  file (REMOVE_RECURSE "${work}")
+  file (MAKE_DIRECTORY "${work}")
+  foreach (args
+      "validator-keys-tests;--unittest=TokenBench"
+      "validator-keys-tests;--unittest=SignBench"
+      "validator-keys;create_keys;--count;2000;--keyfile-dir;keys"
+      "validator-keys;sign;--keyfile-dir;keys;data"
+      "validator-keys;sign;--keyfile-dir;keys;--format=jsonl;data")
+    list (POP_FRONT args program)
+    execute_process (
+      COMMAND ${dir}/${program} ${args}
+      WORKING_DIRECTORY "${work}"
+      OUTPUT_QUIET ERROR_QUIET
+      COMMAND_ERROR_IS_FATAL ANY)
+  endforeach ()
+endfunction ()
+
+# Sets out_var to the best of a few workload runs, in microseconds
+function (time_workload dir out_var)
+  set (best "")
+  foreach (i RANGE 1 ${rounds})
+    string (TIMESTAMP start "%s%f")
+    run_workload (${dir})
+    string (TIMESTAMP stop "%s%f")
+    math (EXPR elapsed "${stop} - ${start}")
+    if (best STREQUAL "" OR elapsed LESS best)
+      set (best ${elapsed})
+    endif ()
+  endforeach ()
+  set (${out_var} ${best} PARENT_SCOPE)
+endfunction ()
+
+build (release)
+
+file (REMOVE_RECURSE "${profile_dir}")
+build (instrumented -Dpgo=generate -Dpgo_dir=${profile_dir})
+message (STATUS "Training the instrumented build")
+run_workload (${build_dir}/instrumented)
+
+# Clang writes raw profiles that have to be merged first
+file (GLOB raw_profiles "${profile_dir}/*.profraw")
+if (raw_profiles)
+  find_program (llvm_profdata NAMES llvm-profdata REQUIRED)
+  execute_process (
+    COMMAND ${llvm_profdata} merge -output=${profile_dir}/default.profdata
+      ${raw_profiles}
+    COMMAND_ERROR_IS_FATAL ANY)
+endif ()
+
+build (optimized -Dpgo=use -Dpgo_dir=${profile_dir} -Dlto=ON)
+
+message (STATUS "Timing the workload, best of ${rounds}")
+time_workload (${build_dir}/release release_us)
+time_workload (${build_dir}/optimized optimized_us)
+math (EXPR release_ms "${release_us} / 1000")
+math (EXPR optimized_ms "${optimized_us} / 1000")
+math (EXPR change "(${release_us} - ${optimized_us}) * 1000 / ${release_us}")
+set (direction faster)
+if (change LESS 0)
+  set (direction slower)
+  math (EXPR change "-${change}")
+endif ()
+math (EXPR change_whole "${change} / 10")
+math (EXPR change_tenth "${change} % 10")
+message (STATUS "release:   ${release_ms} ms")
+message (STATUS "optimized: ${optimized_ms} ms "
+  "(${change_whole}.${change_tenth}% ${direction})")
+message (STATUS "Optimized binary: ${build_dir}/optimized/validator-keys")
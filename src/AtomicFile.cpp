@@ -0,0 +1,124 @@
+#include <AtomicFile.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cerrno>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xrpl {
+
+namespace {
+
+#ifndef _WIN32
+
+bool
+writeAll(int fd, std::string_view contents)
+{
+    for (std::size_t done = 0; done < contents.size();)
+    {
+        auto const n =
+            ::write(fd, contents.data() + done, contents.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+#endif
+
+}  // namespace
+
+boost::filesystem::path
+atomicTempName(boost::filesystem::path const& file)
+{
+    return file.string() +
+        boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp").string();
+}
+
+bool
+syncDirectory(boost::filesystem::path const& dir)
+{
+#ifndef _WIN32
+    int const fd = ::open(
+        dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    bool const ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#else
+    return true;
+#endif
+}
+
+void
+writeFileAtomic(
+    boost::filesystem::path const& file,
+    std::string_view contents,
+    bool ownerOnly)
+{
+    using namespace boost::filesystem;
+
+    if (file.has_parent_path())
+        create_directories(file.parent_path());
+
+#ifndef _WIN32
+    // Created exclusively and with its final mode, so no other writer
+    // shares it and the contents are never readable by others, even
+    // briefly
+    path tmp;
+    int fd = -1;
+    for (int attempt = 0; fd < 0 && attempt < 16; ++attempt)
+    {
+        tmp = atomicTempName(file);
+        fd = ::open(
+            tmp.c_str(),
+            O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+            ownerOnly ? S_IRUSR | S_IWUSR : 0666);
+        if (fd < 0 && errno != EEXIST)
+            break;
+    }
+    if (fd < 0)
+        throw std::runtime_error("Cannot open file: " + tmp.string());
+
+    // The contents must be on disk before the rename makes them the file,
+    // or a crash could leave it empty
+    bool ok = writeAll(fd, contents) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    ok = ok && ::rename(tmp.c_str(), file.c_str()) == 0;
+    if (!ok)
+    {
+        ::unlink(tmp.c_str());
+        throw std::runtime_error("Cannot write file: " + file.string());
+    }
+
+    if (!syncDirectory(file.parent_path()))
+        throw std::runtime_error(
+            "Cannot sync directory of file: " + file.string());
+#else
+    auto const tmp = atomicTempName(file);
+    {
+        std::ofstream o(
+            tmp.string(), std::ios_base::binary | std::ios_base::trunc);
+        if (!o)
+            throw std::runtime_error("Cannot open file: " + tmp.string());
+        o.write(contents.data(), contents.size());
+        if (!o.flush())
+            throw std::runtime_error("Cannot write file: " + tmp.string());
+    }
+    if (ownerOnly)
+        permissions(tmp, owner_read | owner_write);
+    rename(tmp, file);
+#endif
+}
+
+}  // namespace xrpl
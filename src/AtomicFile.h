@@ -0,0 +1,48 @@
+#ifndef VALIDATOR_KEYS_ATOMICFILE_H_INCLUDED
+#define VALIDATOR_KEYS_ATOMICFILE_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+
+#include <string_view>
+
+namespace xrpl {
+
+/** Replaces the contents of a file atomically
+
+    The contents are written to a uniquely named temporary file in the same
+    directory, synced to disk and renamed over the file, and the directory
+    is synced, so readers and a crash leave either the old or the new
+    contents and never a partial write. Concurrent writers each use their
+    own temporary file. Parent directories are created as needed.
+
+    @param ownerOnly Make the file readable and writable by its owner only
+
+    @throws std::runtime_error if the file cannot be written
+*/
+void
+writeFileAtomic(
+    boost::filesystem::path const& file,
+    std::string_view contents,
+    bool ownerOnly = false);
+
+/** Returns a random name for a temporary file next to file
+
+    Create it exclusively, since another writer may draw the same name.
+*/
+boost::filesystem::path
+atomicTempName(boost::filesystem::path const& file);
+
+/** Syncs a directory to disk, so files renamed into it survive a crash
+
+    Does nothing on Windows.
+
+    @param dir The directory, or empty for the current one
+
+    @return false if the directory cannot be synced
+*/
+bool
+syncDirectory(boost::filesystem::path const& dir);
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,557 @@
+#include <AtomicFile.h>
+#include <BulkFileIO.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef KEYS_IO_URING
+#include <linux/fs.h>
+#include <liburing.h>
+#endif
+
+namespace xrpl {
+
+namespace {
+
+// Key files are far smaller; larger files are finished with read(2)
+std::size_t const readBufferSize = 64 * 1024;
+
+std::string
+readError(boost::filesystem::path const& file)
+{
+    return "Failed to read file: " + file.string();
+}
+
+std::string
+writeError(boost::filesystem::path const& file)
+{
+    return "Failed to write file: " + file.string();
+}
+
+#ifndef _WIN32
+
+// Appends the rest of an open file, from offset, to contents
+bool
+readRest(int fd, std::string& contents)
+{
+    char buf[readBufferSize];
+    for (;;)
+    {
+        auto const n = ::pread(fd, buf, sizeof(buf), contents.size());
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return false;
+        if (n == 0)
+            return true;
+        contents.append(buf, n);
+    }
+}
+
+// Appends the rest of a file, from offset, to contents
+bool
+readPosix(boost::filesystem::path const& file, std::string& contents)
+{
+    int const fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    bool const ok = readRest(fd, contents);
+    ::close(fd);
+    return ok;
+}
+
+// Moves a written temporary file into place. Unless replacing, an existing
+// file is kept, which link() guarantees where checking first could not.
+bool
+install(
+    boost::filesystem::path const& tmp,
+    boost::filesystem::path const& file,
+    bool replace,
+    bool& existed)
+{
+    if (replace)
+        return ::rename(tmp.c_str(), file.c_str()) == 0;
+
+    if (::link(tmp.c_str(), file.c_str()) != 0)
+    {
+        existed = errno == EEXIST;
+        return false;
+    }
+    ::unlink(tmp.c_str());
+    return true;
+}
+
+bool
+writePosix(
+    boost::filesystem::path const& file,
+    std::string const& contents,
+    bool replace,
+    bool& existed)
+{
+    // As in writeFileAtomic: created exclusively and owner-only, since the
+    // files are key files
+    boost::filesystem::path tmp;
+    int fd = -1;
+    for (int attempt = 0; fd < 0 && attempt < 16; ++attempt)
+    {
+        tmp = atomicTempName(file);
+        fd = ::open(
+            tmp.c_str(),
+            O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+            S_IRUSR | S_IWUSR);
+        if (fd < 0 && errno != EEXIST)
+            break;
+    }
+    if (fd < 0)
+        return false;
+
+    bool ok = true;
+    for (std::size_t done = 0; ok && done < contents.size();)
+    {
+        auto const n =
+            ::write(fd, contents.data() + done, contents.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        ok = n > 0;
+        done += ok ? n : 0;
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    ok = ok && install(tmp, file, replace, existed);
+    if (!ok)
+        ::unlink(tmp.c_str());
+    return ok;
+}
+
+#else
+
+bool
+readPosix(boost::filesystem::path const& file, std::string& contents)
+{
+    std::ifstream in(file.string(), std::ios_base::binary);
+    if (!in || !in.seekg(contents.size()))
+        return false;
+    contents.append(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+bool
+writePosix(
+    boost::filesystem::path const& file,
+    std::string const& contents,
+    bool replace,
+    bool& existed)
+{
+    using namespace boost::filesystem;
+
+    auto const tmp = atomicTempName(file);
+    {
+        std::ofstream o(
+            tmp.string(), std::ios_base::binary | std::ios_base::trunc);
+        if (!o || !o.write(contents.data(), contents.size()).flush())
+            return false;
+    }
+    boost::system::error_code ec;
+    permissions(tmp, owner_read | owner_write, ec);
+    bool ok = !ec;
+    if (ok && replace)
+    {
+        rename(tmp, file, ec);
+        ok = !ec;
+    }
+    else if (ok)
+    {
+        // Unlike boost's, the C rename fails if the file exists on Windows
+        ok = std::rename(tmp.string().c_str(), file.string().c_str()) == 0;
+        existed = !ok && exists(file, ec);
+    }
+    if (!ok)
+        remove(tmp, ec);
+    return ok;
+}
+
+#endif
+
+}  // namespace
+
+#ifdef KEYS_IO_URING
+
+struct BulkFileIO::Ring
+{
+    // Operations of a file's chain, kept in the low bits of user_data
+    enum Op : std::uint64_t {
+        openOp,
+        ioOp,
+        fsyncOp,
+        closeOp,
+        renameOp,
+        opCount
+    };
+
+    io_uring ring;
+
+    // Per file state of the batch in progress
+    std::vector<std::string> buffers;
+    std::vector<std::string> tmpNames;
+    std::vector<bool> opened;
+    std::vector<int> errors;
+    std::vector<int> bytes;
+    unsigned pending = 0;
+
+    static std::unique_ptr<Ring>
+    make(unsigned depth)
+    {
+        auto r = std::make_unique<Ring>();
+        if (io_uring_queue_init(depth * Op::opCount, &r->ring, 0) != 0)
+            return nullptr;
+
+        // Files are opened straight into a registered table, so a chain
+        // can use its file without a round trip to learn the descriptor
+        bool supported =
+            io_uring_register_files_sparse(&r->ring, depth) == 0;
+        if (auto const probe = io_uring_get_probe_ring(&r->ring))
+        {
+            for (auto const op :
+                 {IORING_OP_OPENAT,
+                  IORING_OP_READ,
+                  IORING_OP_WRITE,
+                  IORING_OP_FSYNC,
+                  IORING_OP_CLOSE,
+                  IORING_OP_RENAMEAT})
+                supported = supported && io_uring_opcode_supported(probe, op);
+            io_uring_free_probe(probe);
+        }
+        else
+            supported = false;
+
+        if (!supported)
+        {
+            io_uring_queue_exit(&r->ring);
+            return nullptr;
+        }
+        return r;
+    }
+
+    ~Ring()
+    {
+        io_uring_queue_exit(&ring);
+    }
+
+    io_uring_sqe*
+    next()
+    {
+        // The ring has room for a chain per file of a full batch
+        return io_uring_get_sqe(&ring);
+    }
+
+    // Called after the prep function, which clears the flags
+    void
+    tag(io_uring_sqe* sqe, std::size_t file, Op op, unsigned flags)
+    {
+        io_uring_sqe_set_data64(sqe, (file << 3) | op);
+        io_uring_sqe_set_flags(sqe, flags);
+        ++pending;
+    }
+
+    void
+    start(std::size_t n)
+    {
+        errors.assign(n, 0);
+        opened.assign(n, false);
+        bytes.assign(n, 0);
+        buffers.resize(n);
+        tmpNames.resize(n);
+        pending = 0;
+    }
+
+    void
+    submit()
+    {
+        if (io_uring_submit(&ring) < 0)
+            throw std::runtime_error("Unable to submit file I/O");
+    }
+
+    void
+    reap()
+    {
+        for (; pending != 0; --pending)
+        {
+            io_uring_cqe* cqe;
+            int rc;
+            while ((rc = io_uring_wait_cqe(&ring, &cqe)) == -EINTR)
+                ;
+            if (rc < 0)
+                throw std::runtime_error("Unable to complete file I/O");
+
+            auto const file = io_uring_cqe_get_data64(cqe) >> 3;
+            auto const op = io_uring_cqe_get_data64(cqe) & 7;
+            auto const res = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+
+            // Closing is not checked: a failed chain has nothing to close
+            if (op == Op::closeOp)
+                continue;
+            if (op == Op::openOp && res >= 0)
+                opened[file] = true;
+            if (op == Op::ioOp && res >= 0)
+                bytes[file] = res;
+            else if (
+                res < 0 && (errors[file] == 0 || errors[file] == -ECANCELED))
+                errors[file] = res;
+        }
+    }
+};
+
+BulkFileIO::BulkFileIO(unsigned depth)
+    : ring_(Ring::make(depth)), depth_(depth)
+{
+}
+
+#else
+
+struct BulkFileIO::Ring
+{
+};
+
+BulkFileIO::BulkFileIO(unsigned depth) : depth_(depth)
+{
+}
+
+#endif
+
+BulkFileIO::~BulkFileIO()
+{
+    // Let a batch in progress finish before its buffers go away
+    if (!files_.empty())
+    {
+        try
+        {
+            wait();
+        }
+        catch (std::exception const&)
+        {
+        }
+    }
+}
+
+void
+BulkFileIO::read(std::vector<boost::filesystem::path> files)
+{
+    if (!files_.empty() || files.size() > depth_)
+        throw std::logic_error("BulkFileIO::read: bad batch");
+
+    files_ = std::move(files);
+    writing_ = false;
+
+#ifdef KEYS_IO_URING
+    if (!ring_)
+        return;
+
+    auto& r = *ring_;
+    r.start(files_.size());
+    for (std::size_t i = 0; i < files_.size(); ++i)
+    {
+        r.buffers[i].resize(readBufferSize);
+
+        auto sqe = r.next();
+        io_uring_prep_openat_direct(
+            sqe, AT_FDCWD, files_[i].c_str(), O_RDONLY | O_CLOEXEC, 0, i);
+        r.tag(sqe, i, Ring::openOp, IOSQE_IO_LINK);
+
+        // The close is hard linked so it also runs after a short read
+        sqe = r.next();
+        io_uring_prep_read(sqe, i, r.buffers[i].data(), readBufferSize, 0);
+        r.tag(sqe, i, Ring::ioOp, IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK);
+
+        sqe = r.next();
+        io_uring_prep_close_direct(sqe, i);
+        r.tag(sqe, i, Ring::closeOp, 0);
+    }
+    r.submit();
+#endif
+}
+
+void
+BulkFileIO::write(
+    std::vector<std::pair<boost::filesystem::path, std::string>> files,
+    bool replace)
+{
+    if (!files_.empty() || files.size() > depth_)
+        throw std::logic_error("BulkFileIO::write: bad batch");
+
+    for (auto& [file, contents] : files)
+    {
+        files_.push_back(std::move(file));
+        contents_.push_back(std::move(contents));
+    }
+    writing_ = true;
+    replace_ = replace;
+
+#ifdef KEYS_IO_URING
+    if (!ring_)
+        return;
+
+    auto& r = *ring_;
+    r.start(files_.size());
+    for (std::size_t i = 0; i < files_.size(); ++i)
+    {
+        r.tmpNames[i] = atomicTempName(files_[i]).string();
+
+        // A failure cancels the rest of the chain, so a file is only
+        // renamed into place once it is completely written and synced
+        auto sqe = r.next();
+        io_uring_prep_openat_direct(
+            sqe,
+            AT_FDCWD,
+            r.tmpNames[i].c_str(),
+            O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+            S_IRUSR | S_IWUSR,
+            i);
+        r.tag(sqe, i, Ring::openOp, IOSQE_IO_LINK);
+
+        sqe = r.next();
+        io_uring_prep_write(
+            sqe, i, contents_[i].data(), contents_[i].size(), 0);
+        r.tag(sqe, i, Ring::ioOp, IOSQE_FIXED_FILE | IOSQE_IO_LINK);
+
+        sqe = r.next();
+        io_uring_prep_fsync(sqe, i, 0);
+        r.tag(sqe, i, Ring::fsyncOp, IOSQE_FIXED_FILE | IOSQE_IO_LINK);
+
+        sqe = r.next();
+        io_uring_prep_close_direct(sqe, i);
+        r.tag(sqe, i, Ring::closeOp, IOSQE_IO_LINK);
+
+        sqe = r.next();
+        io_uring_prep_renameat(
+            sqe,
+            AT_FDCWD,
+            r.tmpNames[i].c_str(),
+            AT_FDCWD,
+            files_[i].c_str(),
+            replace ? 0 : RENAME_NOREPLACE);
+        r.tag(sqe, i, Ring::renameOp, 0);
+    }
+    r.submit();
+#endif
+}
+
+std::vector<BulkFileIO::Result>
+BulkFileIO::waitPosix()
+{
+    std::vector<Result> results(files_.size());
+    for (std::size_t i = 0; i < files_.size(); ++i)
+    {
+        if (writing_)
+        {
+            if (!writePosix(
+                    files_[i], contents_[i], replace_, results[i].existed))
+                results[i].error = writeError(files_[i]);
+        }
+        else if (!readPosix(files_[i], results[i].contents))
+        {
+            results[i].contents.clear();
+            results[i].error = readError(files_[i]);
+        }
+    }
+    return results;
+}
+
+std::vector<BulkFileIO::Result>
+BulkFileIO::wait()
+{
+    std::vector<Result> results;
+
+#ifdef KEYS_IO_URING
+    if (ring_)
+    {
+        auto& r = *ring_;
+        r.reap();
+
+        results.resize(files_.size());
+        for (std::size_t i = 0; i < files_.size(); ++i)
+        {
+            auto& result = results[i];
+            if (writing_)
+            {
+                // A short write counts as a failure too
+                bool const written = r.opened[i] &&
+                    static_cast<std::size_t>(r.bytes[i]) ==
+                        contents_[i].size();
+                if (written && r.errors[i] == 0)
+                    continue;
+
+                // Only the rename is left to fail once the file is written.
+                // Filesystems without RENAME_NOREPLACE refuse it as invalid.
+                if (written && r.errors[i] == -EINVAL && !replace_ &&
+                    install(r.tmpNames[i], files_[i], false, result.existed))
+                    continue;
+                result.existed = result.existed ||
+                    (written && r.errors[i] == -EEXIST);
+
+                // Another writer's file if ours was never created
+                if (r.opened[i])
+                    ::unlink(r.tmpNames[i].c_str());
+                result.error = writeError(files_[i]);
+                continue;
+            }
+
+            if (r.errors[i] != 0)
+            {
+                result.error = readError(files_[i]);
+                continue;
+            }
+
+            result.contents = std::move(r.buffers[i]);
+            result.contents.resize(r.bytes[i]);
+            if (result.contents.size() == readBufferSize &&
+                !readPosix(files_[i], result.contents))
+            {
+                result.contents.clear();
+                result.error = readError(files_[i]);
+            }
+        }
+    }
+    else
+#endif
+        results = waitPosix();
+
+    // The renames only survive a crash once their directories are synced
+    if (writing_)
+    {
+        std::set<boost::filesystem::path> dirs;
+        for (std::size_t i = 0; i < files_.size(); ++i)
+        {
+            if (results[i].error.empty())
+                dirs.insert(files_[i].parent_path());
+        }
+        for (auto const& dir : dirs)
+        {
+            if (syncDirectory(dir))
+                continue;
+            for (std::size_t i = 0; i < files_.size(); ++i)
+            {
+                if (results[i].error.empty() && files_[i].parent_path() == dir)
+                    results[i].error = writeError(files_[i]);
+            }
+        }
+    }
+
+    files_.clear();
+    contents_.clear();
+    return results;
+}
+
+}  // namespace xrpl
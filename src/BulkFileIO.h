@@ -0,0 +1,118 @@
+#ifndef VALIDATOR_KEYS_BULKFILEIO_H_INCLUDED
+#define VALIDATOR_KEYS_BULKFILEIO_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xrpl {
+
+/**
+   Reads and replaces many small files, such as key files, at once.
+
+   Files are handled in batches of up to depth() files: start a batch with
+   read() or write(), then collect it with wait(). In between, the caller
+   is free to do other work, such as parsing or generating keys for another
+   batch.
+
+   When built with io_uring support (the io_uring CMake option) and the
+   kernel provides it, every file of a batch is one linked chain of
+   open, read or write, fsync, close and rename operations. The whole batch
+   is submitted with one system call, so read() and write() return at once
+   and the I/O overlaps the caller's work. Otherwise the same operations
+   are made with blocking POSIX calls in wait().
+ */
+class BulkFileIO
+{
+public:
+    struct Result
+    {
+        // The contents of a file read
+        std::string contents;
+
+        // Why the operation failed, empty if it succeeded
+        std::string error;
+
+        // Whether a file written without replacing was already there
+        bool existed = false;
+    };
+
+private:
+    struct Ring;
+
+    std::unique_ptr<Ring> ring_;
+    unsigned const depth_;
+
+    // The batch in progress
+    std::vector<boost::filesystem::path> files_;
+    std::vector<std::string> contents_;
+    bool writing_ = false;
+    bool replace_ = true;
+
+    std::vector<Result>
+    waitPosix();
+
+public:
+    /** @param depth Most files in one batch */
+    explicit BulkFileIO(unsigned depth = 64);
+
+    ~BulkFileIO();
+    BulkFileIO(BulkFileIO const&) = delete;
+    BulkFileIO&
+    operator=(BulkFileIO const&) = delete;
+
+    /** Returns true if batches are submitted through io_uring */
+    bool
+    async() const
+    {
+        return ring_ != nullptr;
+    }
+
+    /** Returns the most files in one batch */
+    unsigned
+    depth() const
+    {
+        return depth_;
+    }
+
+    /** Starts reading whole files
+
+        @throws std::logic_error if a batch is in progress or there are
+                more than depth() files
+    */
+    void
+    read(std::vector<boost::filesystem::path> files);
+
+    /** Starts replacing files
+
+        As writeFileAtomic does, each file is written to a uniquely named
+        temporary file next to it, created exclusively and readable by its
+        owner only, which is synced to disk and renamed over the file. The
+        directories are synced once the batch is done.
+
+        @param replace Whether to replace existing files. If not, a file
+                       that exists when it is put in place is left as it
+                       was, and its result has an error and existed set.
+
+        @throws std::logic_error if a batch is in progress or there are
+                more than depth() files
+    */
+    void
+    write(
+        std::vector<std::pair<boost::filesystem::path, std::string>> files,
+        bool replace = true);
+
+    /** Waits for the batch in progress to finish
+
+        @return One result per file, in the order they were given
+    */
+    std::vector<Result>
+    wait();
+};
+
+}  // namespace xrpl
+
+#endif
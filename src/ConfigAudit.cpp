@@ -0,0 +1,272 @@
+#include <ConfigAudit.h>
+#include <KeyDirectory.h>
+#include <ManifestDecoder.h>
+#include <MappedFile.h>
+#include <Parallel.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/basics/base64.h>
+#include <xrpl/json/json_reader.h>
+#include <xrpl/protocol/SecretKey.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <map>
+
+namespace xrpl {
+
+namespace {
+
+std::string_view
+trim(std::string_view s)
+{
+    auto const space = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    };
+    while (!s.empty() && space(s.front()))
+        s.remove_prefix(1);
+    while (!s.empty() && space(s.back()))
+        s.remove_suffix(1);
+    return s;
+}
+
+// Whether a secret key is one libxrpl can derive a public key from.
+// secp256k1 secrets must be scalars from 1 to the curve order less one,
+// or deriving the key is a logic error that ends the process.
+bool
+validSecret(KeyType type, Blob const& secret)
+{
+    static std::array<std::uint8_t, 32> const order = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48,
+        0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x41};
+
+    if (secret.size() != order.size())
+        return false;
+    if (type != KeyType::secp256k1)
+        return true;
+    return std::any_of(
+               secret.begin(),
+               secret.end(),
+               [](std::uint8_t b) { return b != 0; }) &&
+        std::lexicographical_compare(
+               secret.begin(), secret.end(), order.begin(), order.end());
+}
+
+// Decodes a validator token as written by ValidatorToken::toString
+bool
+decodeToken(
+    std::string const& token,
+    std::string& manifest,
+    boost::optional<ManifestFields>& fields,
+    bool& keyMatches)
+{
+    Json::Value jv;
+    Json::Reader reader;
+    if (!reader.parse(base64_decode(token), jv) || !jv.isObject() ||
+        !jv.isMember("validation_secret_key") || !jv.isMember("manifest") ||
+        !jv["validation_secret_key"].isString() || !jv["manifest"].isString())
+        return false;
+
+    manifest = base64_decode(jv["manifest"].asString());
+    fields = decodeManifest(makeSlice(manifest));
+    if (!fields || fields->revoked())
+        return false;
+
+    auto const type = publicKeyType(fields->signingKey);
+    auto const secret = strUnHex(jv["validation_secret_key"].asString());
+    if (!secret || !validSecret(*type, *secret))
+        return false;
+
+    keyMatches =
+        derivePublicKey(*type, SecretKey(makeSlice(*secret))) ==
+        PublicKey(fields->signingKey);
+    return true;
+}
+
+// Checks what a config claims about its validator, without the key files
+void
+auditSections(ConfigAudit& audit, ValidatorSections const& sections)
+{
+    if (!sections.token && !sections.revocation)
+    {
+        audit.issues.push_back("no_validator_token");
+        return;
+    }
+
+    if (sections.token)
+    {
+        std::string manifest;
+        boost::optional<ManifestFields> fields;
+        bool keyMatches = false;
+        if (!decodeToken(*sections.token, manifest, fields, keyMatches))
+        {
+            audit.issues.push_back("invalid_token");
+        }
+        else
+        {
+            audit.publicKey = PublicKey(fields->masterKey);
+            audit.tokenSequence = fields->sequence;
+            if (!keyMatches)
+                audit.issues.push_back("token_key_mismatch");
+        }
+    }
+
+    if (sections.revocation)
+    {
+        auto const revocation = base64_decode(*sections.revocation);
+        auto const fields = decodeManifest(makeSlice(revocation));
+        if (!fields || !fields->revoked())
+        {
+            audit.issues.push_back("invalid_revocation");
+        }
+        else if (!audit.publicKey)
+        {
+            audit.publicKey = PublicKey(fields->masterKey);
+        }
+        else if (*audit.publicKey != PublicKey(fields->masterKey))
+        {
+            audit.issues.push_back("revocation_key_mismatch");
+        }
+    }
+}
+
+// Checks a config against the key file of its master key
+void
+auditKeyFile(
+    ConfigAudit& audit,
+    bool hasRevocation,
+    KeyFileEntry const& entry)
+{
+    auto const& keys = *entry.keys;
+    audit.keyFile = entry.path;
+    audit.keySequence = keys.sequence();
+
+    if (keys.revoked())
+    {
+        if (!hasRevocation)
+            audit.issues.push_back("missing_revocation");
+        return;
+    }
+
+    if (hasRevocation)
+        audit.issues.push_back("unexpected_revocation");
+
+    if (audit.tokenSequence)
+    {
+        if (*audit.tokenSequence < keys.sequence())
+            audit.issues.push_back("stale_token");
+        else if (*audit.tokenSequence > keys.sequence())
+            audit.issues.push_back("token_ahead_of_key_file");
+    }
+}
+
+}  // namespace
+
+ValidatorSections
+parseValidatorSections(std::string_view config)
+{
+    ValidatorSections sections;
+    boost::optional<std::string>* current = nullptr;
+
+    while (!config.empty())
+    {
+        auto const eol = config.find('\n');
+        auto const line = trim(config.substr(0, eol));
+        config.remove_prefix(
+            eol == std::string_view::npos ? config.size() : eol + 1);
+
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        if (line.front() == '[' && line.back() == ']')
+        {
+            auto const name = line.substr(1, line.size() - 2);
+            if (name == "validator_token")
+                current = &sections.token;
+            else if (name == "validator_key_revocation")
+                current = &sections.revocation;
+            else
+                current = nullptr;
+
+            if (current && !*current)
+                current->emplace();
+            continue;
+        }
+
+        if (current)
+            (*current)->append(line.data(), line.size());
+    }
+
+    return sections;
+}
+
+std::vector<ConfigAudit>
+auditConfigs(
+    boost::filesystem::path const& configsDir,
+    boost::filesystem::path const& keysDir,
+    unsigned threads)
+{
+    using namespace boost::filesystem;
+
+    if (!is_directory(configsDir))
+        throw std::runtime_error("Not a directory: " + configsDir.string());
+
+    std::vector<ConfigAudit> audits;
+    for (auto const& entry : recursive_directory_iterator(configsDir))
+    {
+        if (is_regular_file(entry.status()) &&
+            entry.path().extension() == ".cfg")
+        {
+            audits.emplace_back();
+            audits.back().config = entry.path();
+        }
+    }
+    std::sort(
+        audits.begin(), audits.end(), [](auto const& a, auto const& b) {
+            return a.config < b.config;
+        });
+
+    auto const keyFiles = loadKeyDirectory(keysDir, threads);
+    std::map<PublicKey, KeyFileEntry const*> byKey;
+    for (auto const& entry : keyFiles)
+    {
+        if (entry.keys)
+            byKey.emplace(entry.keys->publicKey(), &entry);
+    }
+
+    parallelFor(
+        audits.size(),
+        [&](std::size_t i) {
+            auto& audit = audits[i];
+            ValidatorSections sections;
+            try
+            {
+                MappedFile const file(audit.config);
+                sections = parseValidatorSections(file.contents());
+            }
+            catch (std::exception const&)
+            {
+                audit.issues.push_back("unreadable_config");
+                return;
+            }
+
+            auditSections(audit, sections);
+            if (!audit.publicKey)
+                return;
+
+            auto const it = byKey.find(*audit.publicKey);
+            if (it == byKey.end())
+                audit.issues.push_back("unknown_key");
+            else
+                auditKeyFile(
+                    audit, static_cast<bool>(sections.revocation), *it->second);
+        },
+        threads);
+
+    return audits;
+}
+
+}  // namespace xrpl
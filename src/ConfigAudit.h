@@ -0,0 +1,77 @@
+#ifndef VALIDATOR_KEYS_CONFIGAUDIT_H_INCLUDED
+#define VALIDATOR_KEYS_CONFIGAUDIT_H_INCLUDED
+
+#include <xrpl/protocol/PublicKey.h>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xrpl {
+
+/** Validator sections of a rippled.cfg file */
+struct ValidatorSections
+{
+    // The lines of each section joined together, if the section is present
+    boost::optional<std::string> token;
+    boost::optional<std::string> revocation;
+};
+
+/** Extracts [validator_token] and [validator_key_revocation] from a config
+
+    Leading and trailing whitespace, blank lines and lines starting with '#'
+    are ignored, like rippled does.
+*/
+ValidatorSections
+parseValidatorSections(std::string_view config);
+
+/** The outcome of auditing one config file */
+struct ConfigAudit
+{
+    boost::filesystem::path config;
+
+    // Master key named by the token or revocation in the config
+    boost::optional<PublicKey> publicKey;
+
+    // Sequence of the manifest in the config's validator token
+    boost::optional<std::uint32_t> tokenSequence;
+
+    // Key file holding the master key, if one was found
+    boost::filesystem::path keyFile;
+    boost::optional<std::uint32_t> keySequence;
+
+    /** Problems found, empty if the config is up to date
+
+        One of: unreadable_config, no_validator_token, invalid_token,
+        token_key_mismatch, invalid_revocation, revocation_key_mismatch,
+        unknown_key, stale_token, token_ahead_of_key_file,
+        missing_revocation, unexpected_revocation.
+    */
+    std::vector<std::string> issues;
+};
+
+/** Audits config files against key files
+
+    Every *.cfg file below configsDir is memory-mapped and scanned in
+    parallel. Its validator token is decoded the way rippled reads it
+    (see ValidatorToken::toString) and matched by master public key to a
+    key file in keysDir, whose manifest sequence and revocation state the
+    config must reflect.
+
+    @param threads Number of threads, 0 for one per core
+
+    @return one entry per config file, sorted by path
+*/
+std::vector<ConfigAudit>
+auditConfigs(
+    boost::filesystem::path const& configsDir,
+    boost::filesystem::path const& keysDir,
+    unsigned threads = 0);
+
+}  // namespace xrpl
+
+#endif
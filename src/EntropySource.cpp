@@ -0,0 +1,36 @@
+#include <EntropySource.h>
+
+namespace xrpl {
+
+#ifdef KEYS_ENTROPY_OVERRIDE
+
+namespace {
+
+thread_local EntropySource* installed = nullptr;
+
+}  // namespace
+
+ScopedEntropySource::ScopedEntropySource(EntropySource& source)
+    : previous_(installed)
+{
+    installed = &source;
+}
+
+ScopedEntropySource::~ScopedEntropySource()
+{
+    installed = previous_;
+}
+
+#endif
+
+Seed
+generateSeed()
+{
+#ifdef KEYS_ENTROPY_OVERRIDE
+    if (installed != nullptr)
+        return installed->nextSeed();
+#endif
+    return randomSeed();
+}
+
+}  // namespace xrpl
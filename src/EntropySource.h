@@ -0,0 +1,55 @@
+#ifndef VALIDATOR_KEYS_ENTROPYSOURCE_H_INCLUDED
+#define VALIDATOR_KEYS_ENTROPYSOURCE_H_INCLUDED
+
+#include <xrpl/protocol/Seed.h>
+
+namespace xrpl {
+
+#ifdef KEYS_ENTROPY_OVERRIDE
+
+/** Source of the seeds new master keys and token keys are generated from
+
+    Keys come from randomSeed() unless a source is installed on the calling
+    thread with ScopedEntropySource, so that every run of a test or
+    benchmark works on the same keys. Only the test build defines
+    KEYS_ENTROPY_OVERRIDE; the tool and libvalidatorkeys always use
+    randomSeed().
+*/
+class EntropySource
+{
+public:
+    virtual ~EntropySource() = default;
+
+    virtual Seed
+    nextSeed() = 0;
+};
+
+/** Installs a source on the calling thread for the lifetime of the object
+
+    Scopes nest: the source installed before is restored on destruction.
+    Threads the work is handed to do not inherit the source.
+*/
+class ScopedEntropySource
+{
+public:
+    explicit ScopedEntropySource(EntropySource& source);
+
+    ~ScopedEntropySource();
+
+    ScopedEntropySource(ScopedEntropySource const&) = delete;
+    ScopedEntropySource&
+    operator=(ScopedEntropySource const&) = delete;
+
+private:
+    EntropySource* previous_;
+};
+
+#endif
+
+/** Returns a seed from the source of this thread, or randomSeed() */
+Seed
+generateSeed();
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,41 @@
+#include <FileSignature.h>
+
+#include <xrpl/protocol/digest.h>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace xrpl {
+
+uint256
+fileDigest(boost::filesystem::path const& file)
+{
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> f(
+        std::fopen(file.string().c_str(), "rb"), &std::fclose);
+    if (!f)
+        throw std::runtime_error("Failed to open file: " + file.string());
+
+    sha512_half_hasher h;
+
+    std::array<std::uint8_t, 4> const prefix = {
+        {static_cast<std::uint8_t>(fileSignaturePrefix >> 24),
+         static_cast<std::uint8_t>(fileSignaturePrefix >> 16),
+         static_cast<std::uint8_t>(fileSignaturePrefix >> 8),
+         static_cast<std::uint8_t>(fileSignaturePrefix)}};
+    h(prefix.data(), prefix.size());
+
+    // Large sequential reads keep up with the disk without buffering the file
+    std::vector<std::uint8_t> block(1024 * 1024);
+    std::size_t n;
+    while ((n = std::fread(block.data(), 1, block.size(), f.get())) > 0)
+        h(block.data(), n);
+
+    if (std::ferror(f.get()))
+        throw std::runtime_error("Failed to read file: " + file.string());
+
+    return static_cast<uint256>(h);
+}
+
+}  // namespace xrpl
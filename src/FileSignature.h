@@ -0,0 +1,36 @@
+#ifndef VALIDATOR_KEYS_FILESIGNATURE_H_INCLUDED
+#define VALIDATOR_KEYS_FILESIGNATURE_H_INCLUDED
+
+#include <xrpl/basics/base_uint.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+
+namespace xrpl {
+
+/** Prefix hashed ahead of file contents ("VKF\0")
+
+    It keeps a file signature from also being a valid signature over any
+    ledger object, manifest or other data the same key signs.
+*/
+std::uint32_t const fileSignaturePrefix =
+    (std::uint32_t('V') << 24) | (std::uint32_t('K') << 16) |
+    (std::uint32_t('F') << 8);
+
+/** Returns the SHA-512Half of the prefix and the contents of a file
+
+    The file is read in fixed-size blocks, so memory use does not depend on
+    its size.
+
+    The signature of a file is ValidatorKeys::signDigest of this digest,
+    checked with verifySignedDigest.
+
+    @throws std::runtime_error if the file cannot be read
+*/
+uint256
+fileDigest(boost::filesystem::path const& file);
+
+}  // namespace xrpl
+
+#endif
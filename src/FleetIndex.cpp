@@ -0,0 +1,220 @@
+#include <AtomicFile.h>
+#include <FleetIndex.h>
+#include <Parallel.h>
+
+#include <xrpl/json/json_reader.h>
+#include <xrpl/protocol/tokens.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include <fstream>
+#include <map>
+
+#include <sys/stat.h>
+
+namespace xrpl {
+
+namespace {
+
+int const indexVersion = 1;
+
+boost::optional<FileStamp>
+stampOf(boost::filesystem::path const& file)
+{
+    struct stat st;
+    if (::stat(file.string().c_str(), &st) != 0)
+        return boost::none;
+
+    FileStamp stamp;
+    stamp.inode = st.st_ino;
+    stamp.size = st.st_size;
+#if defined(__linux__)
+    stamp.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    stamp.mtime =
+        st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    stamp.mtime = st.st_mtime * 1000000000LL;
+#endif
+    return stamp;
+}
+
+// 64-bit values are stored as strings, which Json::Value always holds
+std::uint64_t
+toUInt64(Json::Value const& v)
+{
+    return std::stoull(v.asString());
+}
+
+Json::Value
+toJson(FleetEntry const& e)
+{
+    Json::Value jv;
+    jv["inode"] = std::to_string(e.stamp.inode);
+    jv["size"] = std::to_string(e.stamp.size);
+    jv["mtime"] = std::to_string(e.stamp.mtime);
+    jv["public_key"] = e.publicKey;
+    jv["key_type"] = to_string(e.keyType);
+    jv["sequence"] = Json::UInt(e.sequence);
+    jv["revoked"] = e.revoked;
+    jv["domain"] = e.domain;
+    return jv;
+}
+
+boost::optional<FleetEntry>
+fromJson(boost::filesystem::path const& keyFile, Json::Value const& jv)
+{
+    try
+    {
+        auto const keyType = keyTypeFromString(jv["key_type"].asString());
+        if (!keyType || !jv["public_key"].isString() ||
+            !jv["sequence"].isIntegral() || !jv["revoked"].isBool() ||
+            !jv["domain"].isString())
+            return boost::none;
+
+        FleetEntry e;
+        e.keyFile = keyFile;
+        e.stamp.inode = toUInt64(jv["inode"]);
+        e.stamp.size = toUInt64(jv["size"]);
+        e.stamp.mtime = std::stoll(jv["mtime"].asString());
+        e.publicKey = jv["public_key"].asString();
+        e.keyType = *keyType;
+        e.sequence = jv["sequence"].asUInt();
+        e.revoked = jv["revoked"].asBool();
+        e.domain = jv["domain"].asString();
+        return e;
+    }
+    catch (std::exception const&)
+    {
+        return boost::none;
+    }
+}
+
+// Returns the valid entries of the index, by key file name
+std::map<std::string, FleetEntry>
+readIndex(boost::filesystem::path const& dir)
+{
+    std::map<std::string, FleetEntry> entries;
+
+    std::ifstream in(fleetIndexFile(dir).string());
+    Json::Value jv;
+    if (!in || !Json::Reader().parse(in, jv) || !jv.isObject() ||
+        jv["index_version"] != indexVersion || !jv["files"].isObject())
+        return entries;
+
+    auto const& files = jv["files"];
+    for (auto const& name : files.getMemberNames())
+    {
+        if (auto e = fromJson(dir / name, files[name]))
+            entries.emplace(name, std::move(*e));
+    }
+    return entries;
+}
+
+}  // namespace
+
+FleetEntry const*
+FleetIndex::find(std::string const& publicKey) const
+{
+    for (auto const& e : entries)
+    {
+        if (e.publicKey == publicKey)
+            return &e;
+    }
+    return nullptr;
+}
+
+boost::filesystem::path
+fleetIndexFile(boost::filesystem::path const& dir)
+{
+    return dir / ".validator-keys.index";
+}
+
+FleetIndex
+loadFleetIndex(boost::filesystem::path const& dir, unsigned threads)
+{
+    auto const files = listKeyFiles(dir);
+    auto indexed = readIndex(dir);
+
+    // Stat every key file; only those without a matching entry are parsed
+    std::vector<boost::optional<FleetEntry>> entries(files.size());
+    std::vector<std::string> errors(files.size());
+    std::vector<std::size_t> stale;
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        auto const stamp = stampOf(files[i]);
+        auto const it = indexed.find(files[i].filename().string());
+        if (stamp && it != indexed.end() && it->second.stamp == *stamp)
+            entries[i] = std::move(it->second);
+        else
+            stale.push_back(i);
+    }
+
+    parallelFor(
+        stale.size(),
+        [&](std::size_t j) {
+            auto const i = stale[j];
+            try
+            {
+                // Stamp first: a change while parsing is seen next time
+                auto const stamp = stampOf(files[i]);
+                auto const keys = ValidatorKeys::make_ValidatorKeys(files[i]);
+                if (!stamp)
+                    throw std::runtime_error(
+                        "Failed to open key file: " + files[i].string());
+
+                entries[i].emplace();
+                auto& e = *entries[i];
+                e.keyFile = files[i];
+                e.stamp = *stamp;
+                e.publicKey = toBase58(TokenType::NodePublic, keys.publicKey());
+                e.keyType = keys.keyType();
+                e.sequence = keys.sequence();
+                e.revoked = keys.revoked();
+                e.domain = keys.domain();
+            }
+            catch (std::exception const& e)
+            {
+                errors[i] = e.what();
+            }
+        },
+        threads);
+
+    FleetIndex index;
+    index.reloaded = stale.size();
+    Json::Value jv;
+    jv["index_version"] = indexVersion;
+    auto& jFiles = (jv["files"] = Json::Value(Json::objectValue));
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        if (!entries[i])
+        {
+            KeyFileEntry error;
+            error.path = files[i];
+            error.error = errors[i];
+            index.errors.push_back(std::move(error));
+            continue;
+        }
+
+        jFiles[files[i].filename().string()] = toJson(*entries[i]);
+        index.entries.push_back(std::move(*entries[i]));
+    }
+
+    // Rewrite the index if key files were parsed or have gone
+    if (!stale.empty() || indexed.size() > files.size() - stale.size())
+    {
+        try
+        {
+            writeFileAtomic(fleetIndexFile(dir), jv.toStyledString());
+        }
+        catch (std::exception const&)
+        {
+            // The index only saves work
+        }
+    }
+
+    return index;
+}
+
+}  // namespace xrpl
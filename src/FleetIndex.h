@@ -0,0 +1,87 @@
+#ifndef VALIDATOR_KEYS_FLEETINDEX_H_INCLUDED
+#define VALIDATOR_KEYS_FLEETINDEX_H_INCLUDED
+
+#include <KeyDirectory.h>
+
+#include <xrpl/protocol/KeyType.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xrpl {
+
+/** Identifies a version of a file without reading it */
+struct FileStamp
+{
+    std::uint64_t inode = 0;
+    std::uint64_t size = 0;
+    // Modification time, in nanoseconds where the platform has them
+    std::int64_t mtime = 0;
+
+    bool
+    operator==(FileStamp const&) const = default;
+};
+
+/** What the fleet index knows about a key file */
+struct FleetEntry
+{
+    boost::filesystem::path keyFile;
+    FileStamp stamp;
+
+    // Base58 node public key
+    std::string publicKey;
+    KeyType keyType = KeyType::ed25519;
+    std::uint32_t sequence = 0;
+    bool revoked = false;
+    std::string domain;
+};
+
+/**
+   The keys of a key directory, from a sidecar index.
+
+   The index is kept next to the key files in .validator-keys.index. Each
+   key file's entry is trusted as long as the file's inode, size and
+   modification time are unchanged; only new and changed key files are
+   parsed.
+ */
+struct FleetIndex
+{
+    // By key file path
+    std::vector<FleetEntry> entries;
+
+    // Key files that could not be loaded
+    std::vector<KeyFileEntry> errors;
+
+    // Number of key files that were parsed rather than taken from the index
+    std::size_t reloaded = 0;
+
+    /** Returns the entry of a base58 node public key, or nullptr */
+    FleetEntry const*
+    find(std::string const& publicKey) const;
+};
+
+/** Returns the path of a key directory's index */
+boost::filesystem::path
+fleetIndexFile(boost::filesystem::path const& dir);
+
+/** Loads the index of a key directory and brings it up to date
+
+    Key files that changed since the index was written are parsed in
+    parallel, and the index is rewritten if anything changed. A missing,
+    unreadable or outdated index is rebuilt. Failing to write the index
+    is not an error.
+
+    @param threads Number of threads, 0 for one per core
+
+    @throws std::runtime_error if dir is not a directory
+*/
+FleetIndex
+loadFleetIndex(boost::filesystem::path const& dir, unsigned threads = 0);
+
+}  // namespace xrpl
+
+#endif
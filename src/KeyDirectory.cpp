@@ -0,0 +1,85 @@
+#include <BulkFileIO.h>
+#include <KeyDirectory.h>
+#include <Parallel.h>
+
+#include <xrpl/json/json_reader.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+
+namespace xrpl {
+
+std::vector<boost::filesystem::path>
+listKeyFiles(boost::filesystem::path const& dir)
+{
+    using namespace boost::filesystem;
+
+    if (!is_directory(dir))
+        throw std::runtime_error("Not a directory: " + dir.string());
+
+    std::vector<path> files;
+    for (auto const& entry : directory_iterator(dir))
+    {
+        if (is_regular_file(entry.status()) &&
+            entry.path().extension() == ".json")
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::vector<KeyFileEntry>
+loadKeyDirectory(boost::filesystem::path const& dir, unsigned threads)
+{
+    auto const files = listKeyFiles(dir);
+
+    std::vector<KeyFileEntry> entries(files.size());
+    BulkFileIO io;
+    auto const batch = [&](std::size_t first) {
+        auto const last =
+            std::min<std::size_t>(first + io.depth(), files.size());
+        return std::vector<boost::filesystem::path>(
+            files.begin() + first, files.begin() + last);
+    };
+
+    // The next batch is read while the keys of this one are parsed
+    if (!files.empty())
+        io.read(batch(0));
+    for (std::size_t first = 0; first < files.size(); first += io.depth())
+    {
+        auto const contents = io.wait();
+        if (first + io.depth() < files.size())
+            io.read(batch(first + io.depth()));
+
+        parallelFor(
+            contents.size(),
+            [&](std::size_t i) {
+                auto& entry = entries[first + i];
+                entry.path = files[first + i];
+                try
+                {
+                    if (!contents[i].error.empty())
+                        throw std::runtime_error(
+                            "Failed to open key file: " + entry.path.string());
+
+                    Json::Value jKeys;
+                    if (!Json::Reader().parse(contents[i].contents, jKeys))
+                        throw std::runtime_error(
+                            "Unable to parse json key file: " +
+                            entry.path.string());
+
+                    entry.keys = ValidatorKeys::make_ValidatorKeys(
+                        jKeys, entry.path.string());
+                }
+                catch (std::exception const& e)
+                {
+                    entry.error = e.what();
+                }
+            },
+            threads);
+    }
+    return entries;
+}
+
+}  // namespace xrpl
@@ -0,0 +1,49 @@
+#ifndef VALIDATOR_KEYS_KEYDIRECTORY_H_INCLUDED
+#define VALIDATOR_KEYS_KEYDIRECTORY_H_INCLUDED
+
+#include <ValidatorKeys.h>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include <string>
+#include <vector>
+
+namespace xrpl {
+
+/** A key file found in a key directory */
+struct KeyFileEntry
+{
+    boost::filesystem::path path;
+
+    // The keys, if the file could be loaded
+    boost::optional<ValidatorKeys> keys;
+
+    // Why the file could not be loaded
+    std::string error;
+};
+
+/** Returns the key files in a directory, sorted by path
+
+    Key files are the regular files with a .json extension directly inside
+    the directory.
+
+    @throws std::runtime_error if dir is not a directory
+*/
+std::vector<boost::filesystem::path>
+listKeyFiles(boost::filesystem::path const& dir);
+
+/** Loads every key file in a directory in parallel
+
+    Files are read in batches with BulkFileIO, each batch read while the
+    keys of the previous one are parsed. Files that cannot be loaded are
+    returned with an error instead of keys.
+
+    @param threads Number of threads, 0 for one per core
+*/
+std::vector<KeyFileEntry>
+loadKeyDirectory(boost::filesystem::path const& dir, unsigned threads = 0);
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,118 @@
+#include <KeyFileLock.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+#ifdef _WIN32
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/interprocess/exceptions.hpp>
+
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace xrpl {
+
+boost::filesystem::path
+KeyFileLock::lockFile(boost::filesystem::path const& keyFile)
+{
+    return keyFile.string() + ".lock";
+}
+
+KeyFileLock::KeyFileLock(
+    boost::filesystem::path const& keyFile,
+    Mode mode,
+    std::chrono::milliseconds timeout)
+    : mode_(mode)
+{
+    using namespace boost::filesystem;
+
+    if (mode == shared && !exists(keyFile))
+        return;
+
+    auto const file = lockFile(keyFile);
+    if (file.has_parent_path())
+        create_directories(file.parent_path());
+
+#ifdef _WIN32
+    // file_lock needs an existing file; opening to append never truncates
+    // one another process is holding
+    if (!std::ofstream(file.string(), std::ios_base::app))
+        throw std::runtime_error("Cannot open lock file: " + file.string());
+
+    try
+    {
+        lock_ = boost::interprocess::file_lock(file.string().c_str());
+    }
+    catch (boost::interprocess::interprocess_exception const&)
+    {
+        throw std::runtime_error("Cannot open lock file: " + file.string());
+    }
+
+    auto const deadline = boost::posix_time::microsec_clock::universal_time() +
+        boost::posix_time::milliseconds(timeout.count());
+    locked_ = mode == shared ? lock_.timed_lock_sharable(deadline)
+                             : lock_.timed_lock(deadline);
+#else
+    // Created and locked through the one descriptor, which is only closed
+    // to release the lock
+    fd_ = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd_ < 0)
+        throw std::runtime_error("Cannot open lock file: " + file.string());
+
+    // flock() cannot wait with a timeout, so the lock is polled for
+    auto const deadline = std::chrono::steady_clock::now() + timeout;
+    auto const operation = mode == shared ? LOCK_SH : LOCK_EX;
+    for (;;)
+    {
+        if (::flock(fd_, operation | LOCK_NB) == 0)
+        {
+            locked_ = true;
+            break;
+        }
+        if (errno != EWOULDBLOCK && errno != EINTR)
+            break;
+
+        auto const now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+        std::this_thread::sleep_for(
+            std::min<std::chrono::steady_clock::duration>(
+                deadline - now, std::chrono::milliseconds(5)));
+    }
+
+    if (!locked_)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+
+    if (!locked_)
+        throw std::runtime_error(
+            "Timed out waiting for the lock on key file: " + keyFile.string());
+}
+
+KeyFileLock::~KeyFileLock()
+{
+    if (!locked_)
+        return;
+
+#ifdef _WIN32
+    if (mode_ == shared)
+        lock_.unlock_sharable();
+    else
+        lock_.unlock();
+#else
+    // Closing the descriptor releases the lock
+    ::close(fd_);
+#endif
+}
+
+}  // namespace xrpl
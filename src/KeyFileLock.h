@@ -0,0 +1,73 @@
+#ifndef VALIDATOR_KEYS_KEYFILELOCK_H_INCLUDED
+#define VALIDATOR_KEYS_KEYFILELOCK_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+
+#ifdef _WIN32
+#include <boost/interprocess/sync/file_lock.hpp>
+#endif
+
+#include <chrono>
+
+namespace xrpl {
+
+/** Advisory lock that coordinates processes sharing a key file
+
+    The lock is held on "<keyfile>.lock" rather than on the key file, which
+    may be replaced while it is held. The lock file is created on first use
+    and left in place, since removing it could let two processes lock
+    different files. Commands that only read the key file take it shared,
+    so they run in parallel; commands that update it take it exclusive for
+    the whole read-modify-write, so no two of them start from the same
+    token sequence.
+
+    Every lock is taken on a descriptor of its own, with flock() or, on
+    Windows, LockFileEx, so it keeps out other threads of the same process
+    as well as other processes, and a thread must not lock a key file it
+    already holds. POSIX record locks are not used: closing any descriptor
+    of the file would silently drop all of them in the process.
+*/
+class KeyFileLock
+{
+public:
+    enum Mode { shared, exclusive };
+
+    /** How long to wait for the lock unless told otherwise */
+    static constexpr std::chrono::milliseconds defaultTimeout{10000};
+
+    /** Waits up to timeout for the lock on keyFile
+
+        A shared lock on a key file that does not exist is not taken, and
+        no lock file is created for it.
+
+        @throws std::runtime_error if the lock file cannot be created or the
+                lock is not acquired in time
+    */
+    KeyFileLock(
+        boost::filesystem::path const& keyFile,
+        Mode mode,
+        std::chrono::milliseconds timeout = defaultTimeout);
+
+    ~KeyFileLock();
+
+    KeyFileLock(KeyFileLock const&) = delete;
+    KeyFileLock&
+    operator=(KeyFileLock const&) = delete;
+
+    /** Returns the name of the lock file of a key file */
+    static boost::filesystem::path
+    lockFile(boost::filesystem::path const& keyFile);
+
+private:
+#ifdef _WIN32
+    boost::interprocess::file_lock lock_;
+#else
+    int fd_ = -1;
+#endif
+    Mode mode_;
+    bool locked_ = false;
+};
+
+}  // namespace xrpl
+
+#endif
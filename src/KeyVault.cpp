@@ -0,0 +1,353 @@
+#include <AtomicFile.h>
+#include <KeyVault.h>
+#include <Parallel.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/json/json_reader.h>
+#include <xrpl/json/to_string.h>
+
+#include <boost/filesystem.hpp>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include <fstream>
+#include <memory>
+
+namespace xrpl {
+
+namespace {
+
+int const vaultVersion = 1;
+std::size_t const saltSize = 16;
+std::size_t const nonceSize = 12;
+std::size_t const tagSize = 16;
+
+using Key = std::array<std::uint8_t, 32>;
+
+// The scrypt parameters come from the vault file, so they are bounded to
+// keep an edited or corrupt vault from exhausting memory or time
+std::uint64_t const maxScryptN = 1 << 20;
+std::uint64_t const maxScryptR = 16;
+std::uint64_t const maxScryptP = 16;
+std::uint64_t const maxScryptMemory = (std::uint64_t(1) << 30) + (32 << 20);
+
+using CipherContext =
+    std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>;
+
+CipherContext
+makeContext()
+{
+    CipherContext ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+    if (!ctx)
+        throw std::runtime_error("Unable to create cipher context");
+    return ctx;
+}
+
+std::string
+randomBytes(std::size_t size)
+{
+    std::string bytes(size, '\0');
+    if (RAND_bytes(
+            reinterpret_cast<unsigned char*>(bytes.data()),
+            static_cast<int>(size)) != 1)
+        throw std::runtime_error("Unable to generate random bytes");
+    return bytes;
+}
+
+// Encrypts with AES-256-GCM under a fresh random nonce
+Json::Value
+seal(Key const& key, std::string const& plaintext, std::string const& aad)
+{
+    auto const nonce = randomBytes(nonceSize);
+    std::string out(plaintext.size() + tagSize, '\0');
+    auto const data = reinterpret_cast<unsigned char*>(out.data());
+    int len = 0;
+
+    auto const ctx = makeContext();
+    if (EVP_EncryptInit_ex(
+            ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1 ||
+        EVP_CIPHER_CTX_ctrl(
+            ctx.get(), EVP_CTRL_GCM_SET_IVLEN, nonceSize, nullptr) != 1 ||
+        EVP_EncryptInit_ex(
+            ctx.get(),
+            nullptr,
+            nullptr,
+            key.data(),
+            reinterpret_cast<unsigned char const*>(nonce.data())) != 1 ||
+        EVP_EncryptUpdate(
+            ctx.get(),
+            nullptr,
+            &len,
+            reinterpret_cast<unsigned char const*>(aad.data()),
+            aad.size()) != 1 ||
+        EVP_EncryptUpdate(
+            ctx.get(),
+            data,
+            &len,
+            reinterpret_cast<unsigned char const*>(plaintext.data()),
+            plaintext.size()) != 1 ||
+        EVP_EncryptFinal_ex(ctx.get(), data + len, &len) != 1 ||
+        EVP_CIPHER_CTX_ctrl(
+            ctx.get(),
+            EVP_CTRL_GCM_GET_TAG,
+            tagSize,
+            data + plaintext.size()) != 1)
+        throw std::runtime_error("Unable to encrypt vault entry");
+
+    Json::Value box;
+    box["nonce"] = strHex(nonce);
+    box["ciphertext"] = strHex(out);
+    return box;
+}
+
+// Decrypts and authenticates what seal produced
+boost::optional<std::string>
+unseal(Key const& key, Json::Value const& box, std::string const& aad)
+{
+    if (!box.isObject() || !box["nonce"].isString() ||
+        !box["ciphertext"].isString())
+        return boost::none;
+
+    auto const nonce = strUnHex(box["nonce"].asString());
+    auto const sealed = strUnHex(box["ciphertext"].asString());
+    if (!nonce || nonce->size() != nonceSize || !sealed ||
+        sealed->size() < tagSize)
+        return boost::none;
+
+    auto const size = sealed->size() - tagSize;
+    std::string out(size, '\0');
+    auto const data = reinterpret_cast<unsigned char*>(out.data());
+    int len = 0;
+
+    auto const ctx = makeContext();
+    if (EVP_DecryptInit_ex(
+            ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1 ||
+        EVP_CIPHER_CTX_ctrl(
+            ctx.get(), EVP_CTRL_GCM_SET_IVLEN, nonceSize, nullptr) != 1 ||
+        EVP_DecryptInit_ex(
+            ctx.get(), nullptr, nullptr, key.data(), nonce->data()) != 1 ||
+        EVP_DecryptUpdate(
+            ctx.get(),
+            nullptr,
+            &len,
+            reinterpret_cast<unsigned char const*>(aad.data()),
+            aad.size()) != 1 ||
+        EVP_DecryptUpdate(ctx.get(), data, &len, sealed->data(), size) !=
+            1 ||
+        EVP_CIPHER_CTX_ctrl(
+            ctx.get(),
+            EVP_CTRL_GCM_SET_TAG,
+            tagSize,
+            const_cast<std::uint8_t*>(sealed->data() + size)) != 1 ||
+        EVP_DecryptFinal_ex(ctx.get(), data + len, &len) != 1)
+    {
+        OPENSSL_cleanse(out.data(), out.size());
+        return boost::none;
+    }
+
+    return out;
+}
+
+Key
+deriveKey(std::string const& password, Json::Value const& kdf)
+{
+    auto const salt = strUnHex(kdf["salt"].asString());
+    if (kdf["name"].asString() != "scrypt" || !salt ||
+        !kdf["n"].isIntegral() || !kdf["r"].isIntegral() ||
+        !kdf["p"].isIntegral())
+        throw std::runtime_error("Unsupported vault key derivation");
+
+    std::uint64_t const n = kdf["n"].asUInt();
+    std::uint64_t const r = kdf["r"].asUInt();
+    std::uint64_t const p = kdf["p"].asUInt();
+    if (n > maxScryptN || r > maxScryptR || p > maxScryptP)
+        throw std::runtime_error(
+            "Vault key derivation parameters are too large");
+
+    Key key;
+    if (EVP_PBE_scrypt(
+            password.data(),
+            password.size(),
+            salt->data(),
+            salt->size(),
+            n,
+            r,
+            p,
+            maxScryptMemory,
+            key.data(),
+            key.size()) != 1)
+        throw std::runtime_error("Invalid vault key derivation parameters");
+    return key;
+}
+
+std::string
+entryData(std::string const& name)
+{
+    return "entry:" + name;
+}
+
+}  // namespace
+
+KeyVault::KeyVault(boost::filesystem::path path) : path_(std::move(path))
+{
+}
+
+KeyVault::~KeyVault()
+{
+    OPENSSL_cleanse(dataKey_.data(), dataKey_.size());
+}
+
+KeyVault::KeyVault(KeyVault&& other) noexcept
+    : path_(std::move(other.path_))
+    , vault_(std::move(other.vault_))
+    , dataKey_(other.dataKey_)
+    , unlocked_(other.unlocked_)
+{
+    OPENSSL_cleanse(other.dataKey_.data(), other.dataKey_.size());
+    other.unlocked_ = false;
+}
+
+KeyVault
+KeyVault::create(
+    boost::filesystem::path const& path,
+    std::string const& password,
+    VaultKdfParams const& params)
+{
+    if (exists(path))
+        throw std::runtime_error(
+            "Refusing to overwrite existing vault: " + path.string());
+
+    KeyVault vault(path);
+    auto& v = vault.vault_;
+    v["vault_version"] = vaultVersion;
+
+    auto& kdf = v["kdf"];
+    kdf["name"] = "scrypt";
+    kdf["n"] = static_cast<Json::UInt>(params.n);
+    kdf["r"] = static_cast<Json::UInt>(params.r);
+    kdf["p"] = static_cast<Json::UInt>(params.p);
+    kdf["salt"] = strHex(randomBytes(saltSize));
+
+    auto dataKey = randomBytes(vault.dataKey_.size());
+    std::copy(dataKey.begin(), dataKey.end(), vault.dataKey_.begin());
+
+    auto kek = deriveKey(password, kdf);
+    v["data_key"] = seal(kek, dataKey, "data_key");
+    OPENSSL_cleanse(kek.data(), kek.size());
+    OPENSSL_cleanse(dataKey.data(), dataKey.size());
+
+    v["entries"] = Json::Value(Json::objectValue);
+    vault.unlocked_ = true;
+    return vault;
+}
+
+KeyVault
+KeyVault::open(boost::filesystem::path const& path, std::string const& password)
+{
+    KeyVault vault(path);
+
+    std::ifstream in(path.string());
+    if (!in)
+        throw std::runtime_error("Failed to open vault: " + path.string());
+
+    auto& v = vault.vault_;
+    if (!Json::Reader().parse(in, v) || !v.isObject() ||
+        !v["vault_version"].isIntegral() || !v["entries"].isObject())
+        throw std::runtime_error("Not a key vault: " + path.string());
+
+    if (v["vault_version"].asInt() != vaultVersion)
+        throw std::runtime_error(
+            "Unsupported vault version: " + path.string());
+
+    auto kek = deriveKey(password, v["kdf"]);
+    auto dataKey = unseal(kek, v["data_key"], "data_key");
+    OPENSSL_cleanse(kek.data(), kek.size());
+
+    if (!dataKey || dataKey->size() != vault.dataKey_.size())
+        throw std::runtime_error(
+            "Wrong password for vault: " + path.string());
+
+    std::copy(dataKey->begin(), dataKey->end(), vault.dataKey_.begin());
+    OPENSSL_cleanse(dataKey->data(), dataKey->size());
+    vault.unlocked_ = true;
+    return vault;
+}
+
+std::vector<std::string>
+KeyVault::names() const
+{
+    auto names = vault_["entries"].getMemberNames();
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+bool
+KeyVault::contains(std::string const& name) const
+{
+    return vault_["entries"].isMember(name);
+}
+
+ValidatorKeys
+KeyVault::get(std::string const& name) const
+{
+    auto const source = path_.string() + ":" + name;
+    if (!unlocked_ || !contains(name))
+        throw std::runtime_error("No such vault entry: " + source);
+
+    auto plaintext =
+        unseal(dataKey_, vault_["entries"][name], entryData(name));
+    if (!plaintext)
+        throw std::runtime_error("Unable to decrypt vault entry: " + source);
+
+    Json::Value jKeys;
+    bool const parsed = Json::Reader().parse(*plaintext, jKeys);
+    OPENSSL_cleanse(plaintext->data(), plaintext->size());
+    if (!parsed)
+        throw std::runtime_error("Unable to parse vault entry: " + source);
+
+    return ValidatorKeys::make_ValidatorKeys(jKeys, source);
+}
+
+void
+KeyVault::put(std::string const& name, ValidatorKeys const& keys)
+{
+    if (!unlocked_)
+        throw std::runtime_error("Vault is locked: " + path_.string());
+
+    auto plaintext = to_string(keys.toJson());
+    vault_["entries"][name] = seal(dataKey_, plaintext, entryData(name));
+    OPENSSL_cleanse(plaintext.data(), plaintext.size());
+}
+
+void
+KeyVault::save() const
+{
+    writeFileAtomic(path_, vault_.toStyledString(), true);
+}
+
+std::vector<KeyFileEntry>
+loadKeyVault(KeyVault const& vault, unsigned threads)
+{
+    auto const names = vault.names();
+
+    std::vector<KeyFileEntry> entries(names.size());
+    parallelFor(
+        names.size(),
+        [&](std::size_t i) {
+            entries[i].path = names[i];
+            try
+            {
+                entries[i].keys = vault.get(names[i]);
+            }
+            catch (std::exception const& e)
+            {
+                entries[i].error = e.what();
+            }
+        },
+        threads);
+    return entries;
+}
+
+}  // namespace xrpl
@@ -0,0 +1,117 @@
+#ifndef VALIDATOR_KEYS_KEYVAULT_H_INCLUDED
+#define VALIDATOR_KEYS_KEYVAULT_H_INCLUDED
+
+#include <KeyDirectory.h>
+#include <ValidatorKeys.h>
+
+#include <xrpl/json/json_value.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xrpl {
+
+/** Cost parameters of the scrypt password KDF
+
+    Vaults are refused if n is above 2^20, r or p above 16, or the KDF
+    needs more than about 1 GiB of memory.
+*/
+struct VaultKdfParams
+{
+    // CPU/memory cost; memory use is 128 * r * n bytes (128 MiB by default)
+    std::uint64_t n = 1 << 17;
+    std::uint64_t r = 8;
+    std::uint64_t p = 1;
+};
+
+/**
+   Many validator key files in one password-protected file.
+
+   The password is stretched once with scrypt into a key that unwraps a
+   random 256-bit data key. Every entry is a key file's JSON encrypted with
+   the data key using AES-256-GCM, with the entry name as associated data,
+   so once the vault is unlocked each entry costs a single AES-GCM
+   decryption. The data key only ever exists in memory and is erased when
+   the vault is destroyed.
+ */
+class KeyVault
+{
+private:
+    boost::filesystem::path path_;
+    Json::Value vault_;
+    std::array<std::uint8_t, 32> dataKey_;
+    bool unlocked_ = false;
+
+    explicit KeyVault(boost::filesystem::path path);
+
+public:
+    /** Creates a new, empty and unlocked vault
+
+        Nothing is written until save() is called.
+
+        @throws std::runtime_error if the file already exists
+    */
+    static KeyVault
+    create(
+        boost::filesystem::path const& path,
+        std::string const& password,
+        VaultKdfParams const& params = {});
+
+    /** Opens an existing vault and unlocks it
+
+        @throws std::runtime_error if the file is not a vault or the
+                password is wrong
+    */
+    static KeyVault
+    open(boost::filesystem::path const& path, std::string const& password);
+
+    ~KeyVault();
+    KeyVault(KeyVault&& other) noexcept;
+    KeyVault(KeyVault const&) = delete;
+    KeyVault&
+    operator=(KeyVault const&) = delete;
+
+    /** Returns the entry names, sorted */
+    std::vector<std::string>
+    names() const;
+
+    /** Returns true if the vault has an entry of this name */
+    bool
+    contains(std::string const& name) const;
+
+    /** Decrypts an entry
+
+        Safe to call from several threads at once.
+
+        @throws std::runtime_error if there is no such entry or it does not
+                decrypt to valid keys
+    */
+    ValidatorKeys
+    get(std::string const& name) const;
+
+    /** Adds or replaces an entry */
+    void
+    put(std::string const& name, ValidatorKeys const& keys);
+
+    /** Writes the vault, replacing the file atomically */
+    void
+    save() const;
+};
+
+/** Decrypts every entry of a vault in parallel
+
+    Entries are returned by name, with the name as their path. Entries that
+    cannot be decrypted are returned with an error instead of keys.
+
+    @param threads Number of threads, 0 for one per core
+*/
+std::vector<KeyFileEntry>
+loadKeyVault(KeyVault const& vault, unsigned threads = 0);
+
+}  // namespace xrpl
+
+#endif
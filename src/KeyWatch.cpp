@@ -0,0 +1,195 @@
+#include <KeyDirectory.h>
+#include <KeyWatch.h>
+
+#include <boost/filesystem.hpp>
+
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace xrpl {
+
+namespace {
+
+bool
+isKeyFile(boost::filesystem::path const& p)
+{
+    return p.extension() == ".json";
+}
+
+#ifdef __linux__
+// Completed writes and renames, which is how key files are replaced
+std::uint32_t const watchMask =
+    IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+#endif
+
+}  // namespace
+
+#ifdef __linux__
+
+KeyFileWatcher::KeyFileWatcher(boost::filesystem::path dir)
+    : dir_(std::move(dir)), fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    if (fd_ < 0)
+        throw std::runtime_error("Unable to watch " + dir_.string());
+
+    if (inotify_add_watch(fd_, dir_.c_str(), watchMask) < 0)
+    {
+        ::close(fd_);
+        throw std::runtime_error("Unable to watch " + dir_.string());
+    }
+}
+
+KeyFileWatcher::~KeyFileWatcher()
+{
+    ::close(fd_);
+}
+
+std::vector<boost::filesystem::path>
+KeyFileWatcher::wait(
+    std::chrono::milliseconds timeout,
+    std::chrono::milliseconds settle)
+{
+    std::set<boost::filesystem::path> changed;
+
+    // Set when events were lost, so any key file may have changed
+    bool lost = false;
+
+    auto const readEvents = [&] {
+        alignas(inotify_event) char buf[4096];
+        for (;;)
+        {
+            auto const n = ::read(fd_, buf, sizeof(buf));
+            if (n <= 0)
+                return;
+
+            for (char const* p = buf; p < buf + n;)
+            {
+                auto const ev = reinterpret_cast<inotify_event const*>(p);
+
+                // The queue overflowed, or the watch went away, e.g. with
+                // the file system the directory is on
+                if (ev->mask & (IN_Q_OVERFLOW | IN_IGNORED))
+                    lost = true;
+                if ((ev->mask & IN_IGNORED) &&
+                    inotify_add_watch(fd_, dir_.c_str(), watchMask) < 0)
+                    throw std::runtime_error(
+                        "Unable to watch " + dir_.string());
+
+                if (ev->len != 0)
+                {
+                    boost::filesystem::path const name = ev->name;
+                    if (isKeyFile(name))
+                        changed.insert(dir_ / name);
+                }
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+    };
+
+    pollfd pfd{fd_, POLLIN, 0};
+    auto const deadline = std::chrono::steady_clock::now() + timeout;
+    while (changed.empty() && !lost)
+    {
+        auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0 ||
+            ::poll(&pfd, 1, static_cast<int>(left.count())) <= 0)
+            return {};
+        readEvents();
+    }
+
+    while (::poll(&pfd, 1, static_cast<int>(settle.count())) > 0)
+        readEvents();
+
+    if (lost)
+    {
+        for (auto& file : listKeyFiles(dir_))
+            changed.insert(std::move(file));
+    }
+
+    return {changed.begin(), changed.end()};
+}
+
+#else
+
+KeyFileWatcher::KeyFileWatcher(boost::filesystem::path dir)
+    : dir_(std::move(dir))
+{
+    if (!is_directory(dir_))
+        throw std::runtime_error("Unable to watch " + dir_.string());
+    seen_ = scan();
+}
+
+KeyFileWatcher::~KeyFileWatcher() = default;
+
+std::map<boost::filesystem::path, KeyFileWatcher::FileState>
+KeyFileWatcher::scan() const
+{
+    using namespace boost::filesystem;
+
+    std::map<path, FileState> files;
+    boost::system::error_code ec;
+    for (directory_iterator it(dir_, ec), end; !ec && it != end;
+         it.increment(ec))
+    {
+        auto const& p = it->path();
+        if (!isKeyFile(p))
+            continue;
+
+        // Files removed while scanning are picked up by the next scan
+        auto const mtime = last_write_time(p, ec);
+        auto const size = file_size(p, ec);
+        if (!ec)
+            files[p] = {mtime, size};
+    }
+    return files;
+}
+
+std::vector<boost::filesystem::path>
+KeyFileWatcher::wait(
+    std::chrono::milliseconds timeout,
+    std::chrono::milliseconds settle)
+{
+    auto const interval = std::chrono::milliseconds(500);
+    auto const deadline = std::chrono::steady_clock::now() + timeout;
+
+    std::set<boost::filesystem::path> changed;
+    auto const collect = [&] {
+        auto const now = scan();
+        for (auto const& [p, state] : now)
+        {
+            auto const it = seen_.find(p);
+            if (it == seen_.end() || !(it->second == state))
+                changed.insert(p);
+        }
+        for (auto const& [p, state] : seen_)
+        {
+            if (!now.count(p))
+                changed.insert(p);
+        }
+        seen_ = now;
+    };
+
+    for (collect(); changed.empty(); collect())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return {};
+        std::this_thread::sleep_for(interval);
+    }
+
+    std::this_thread::sleep_for(settle);
+    collect();
+
+    return {changed.begin(), changed.end()};
+}
+
+#endif
+
+}  // namespace xrpl
@@ -0,0 +1,80 @@
+#ifndef VALIDATOR_KEYS_KEYWATCH_H_INCLUDED
+#define VALIDATOR_KEYS_KEYWATCH_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <vector>
+
+namespace xrpl {
+
+/**
+   Reports key files (*.json) written, moved in or removed in a directory.
+
+   On Linux the directory is watched with inotify, so waiting costs nothing
+   until a key file changes. Elsewhere the directory is polled for changed
+   modification times and sizes.
+ */
+class KeyFileWatcher
+{
+private:
+    boost::filesystem::path dir_;
+
+#ifdef __linux__
+    int fd_ = -1;
+#else
+    struct FileState
+    {
+        std::time_t mtime;
+        std::uintmax_t size;
+
+        bool
+        operator==(FileState const&) const = default;
+    };
+
+    std::map<boost::filesystem::path, FileState> seen_;
+
+    std::map<boost::filesystem::path, FileState>
+    scan() const;
+#endif
+
+public:
+    /** Starts watching a directory
+
+        Changes made before the watcher exists are not reported.
+
+        @throws std::runtime_error if the directory cannot be watched
+    */
+    explicit KeyFileWatcher(boost::filesystem::path dir);
+
+    ~KeyFileWatcher();
+    KeyFileWatcher(KeyFileWatcher const&) = delete;
+    KeyFileWatcher&
+    operator=(KeyFileWatcher const&) = delete;
+
+    /** Waits for key files to change
+
+        Once a change is seen, changes following it within settle time are
+        collected too, so a burst of writes is reported at once.
+
+        If changes were lost, because the inotify queue overflowed or the
+        watch was dropped, every key file in the directory is reported.
+
+        @return The paths of the changed key files, sorted and without
+                duplicates, or none if nothing changed before the timeout
+
+        @throws std::runtime_error if the directory can no longer be
+                watched or listed
+    */
+    std::vector<boost::filesystem::path>
+    wait(
+        std::chrono::milliseconds timeout,
+        std::chrono::milliseconds settle = std::chrono::milliseconds(100));
+};
+
+}  // namespace xrpl
+
+#endif
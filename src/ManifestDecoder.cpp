@@ -0,0 +1,243 @@
+#include <ManifestDecoder.h>
+
+#include <xrpl/basics/base64.h>
+#include <xrpl/protocol/PublicKey.h>
+
+#include <limits>
+
+namespace xrpl {
+
+namespace {
+
+// Serialized type and field codes of the manifest fields
+int const stiUInt16 = 1;
+int const stiUInt32 = 2;
+int const stiVL = 7;
+
+int const fieldVersion = 16;
+int const fieldSequence = 4;
+int const fieldPublicKey = 1;
+int const fieldSigningPubKey = 3;
+int const fieldSignature = 6;
+int const fieldDomain = 7;
+int const fieldMasterSignature = 18;
+
+// Reads a field header, as written by Serializer::addFieldID
+bool
+readFieldID(Slice& s, int& type, int& field)
+{
+    if (s.empty())
+        return false;
+
+    std::uint8_t const b = s[0];
+    s += 1;
+    type = b >> 4;
+    field = b & 0x0F;
+
+    if (type == 0)
+    {
+        if (s.empty() || s[0] < 16)
+            return false;
+        type = s[0];
+        s += 1;
+    }
+
+    if (field == 0)
+    {
+        if (s.empty() || s[0] < 16)
+            return false;
+        field = s[0];
+        s += 1;
+    }
+
+    return true;
+}
+
+// Reads a variable length prefix, as written by Serializer::addEncoded
+bool
+readVL(Slice& s, Slice& out)
+{
+    if (s.empty())
+        return false;
+
+    std::size_t size;
+    std::uint8_t const b1 = s[0];
+    s += 1;
+
+    if (b1 <= 192)
+    {
+        size = b1;
+    }
+    else if (b1 <= 240)
+    {
+        if (s.empty())
+            return false;
+        size = 193 + (b1 - 193) * 256 + s[0];
+        s += 1;
+    }
+    else if (b1 <= 254)
+    {
+        if (s.size() < 2)
+            return false;
+        size = 12481 + (b1 - 241) * 65536 + s[0] * 256 + s[1];
+        s += 2;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (s.size() < size)
+        return false;
+
+    out = Slice(s.data(), size);
+    s += size;
+    return true;
+}
+
+int
+hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+bool
+isBase64(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+        (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '=';
+}
+
+}  // namespace
+
+bool
+ManifestFields::revoked() const
+{
+    return sequence == std::numeric_limits<std::uint32_t>::max();
+}
+
+boost::optional<ManifestFields>
+decodeManifest(Slice const& data)
+{
+    ManifestFields m;
+    bool haveSequence = false;
+    Slice s = data;
+
+    // Fields present so far, to reject duplicates
+    unsigned seen = 0;
+    auto const once = [&seen](unsigned bit) {
+        if (seen & bit)
+            return false;
+        seen |= bit;
+        return true;
+    };
+
+    while (!s.empty())
+    {
+        int type, field;
+        if (!readFieldID(s, type, field))
+            return boost::none;
+
+        if (type == stiUInt32 && field == fieldSequence)
+        {
+            if (!once(1 << 0) || s.size() < 4)
+                return boost::none;
+            m.sequence = (std::uint32_t(s[0]) << 24) |
+                (std::uint32_t(s[1]) << 16) | (std::uint32_t(s[2]) << 8) |
+                std::uint32_t(s[3]);
+            s += 4;
+            haveSequence = true;
+        }
+        else if (type == stiUInt16 && field == fieldVersion)
+        {
+            if (!once(1 << 1) || s.size() < 2)
+                return boost::none;
+            m.version = static_cast<std::uint16_t>((s[0] << 8) | s[1]);
+            s += 2;
+        }
+        else if (type == stiVL)
+        {
+            Slice* target;
+            unsigned bit;
+            switch (field)
+            {
+                case fieldPublicKey:
+                    target = &m.masterKey;
+                    bit = 1 << 2;
+                    break;
+                case fieldSigningPubKey:
+                    target = &m.signingKey;
+                    bit = 1 << 3;
+                    break;
+                case fieldSignature:
+                    target = &m.signature;
+                    bit = 1 << 4;
+                    break;
+                case fieldDomain:
+                    target = &m.domain;
+                    bit = 1 << 5;
+                    break;
+                case fieldMasterSignature:
+                    target = &m.masterSignature;
+                    bit = 1 << 6;
+                    break;
+                default:
+                    return boost::none;
+            }
+            if (!once(bit) || !readVL(s, *target))
+                return boost::none;
+        }
+        else
+        {
+            return boost::none;
+        }
+    }
+
+    if (!haveSequence || !publicKeyType(m.masterKey) ||
+        m.masterSignature.empty())
+        return boost::none;
+
+    if (!m.signingKey.empty() && !publicKeyType(m.signingKey))
+        return boost::none;
+
+    if (!m.revoked() && (m.signingKey.empty() || m.signature.empty()))
+        return boost::none;
+
+    return m;
+}
+
+bool
+unwrapManifest(std::string_view s, std::string& out)
+{
+    if (s.empty())
+        return false;
+
+    bool hex = s.size() % 2 == 0;
+    for (auto const c : s)
+    {
+        if (hex && hexValue(c) < 0)
+            hex = false;
+        if (!hex && !isBase64(c))
+            return false;
+    }
+
+    if (!hex)
+    {
+        out = base64_decode(std::string(s));
+        return !out.empty();
+    }
+
+    out.resize(s.size() / 2);
+    for (std::size_t i = 0; i < out.size(); ++i)
+        out[i] = static_cast<char>(
+            (hexValue(s[2 * i]) << 4) | hexValue(s[2 * i + 1]));
+    return true;
+}
+
+}  // namespace xrpl
@@ -0,0 +1,58 @@
+#ifndef VALIDATOR_KEYS_MANIFESTDECODER_H_INCLUDED
+#define VALIDATOR_KEYS_MANIFESTDECODER_H_INCLUDED
+
+#include <xrpl/basics/Slice.h>
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace xrpl {
+
+/**
+   Fields of a serialized manifest.
+
+   The slices point into the buffer that was decoded and are only valid as
+   long as it is.
+ */
+struct ManifestFields
+{
+    std::uint32_t sequence = 0;
+    boost::optional<std::uint16_t> version;
+    Slice masterKey;
+    Slice signingKey;
+    Slice domain;
+    Slice signature;
+    Slice masterSignature;
+
+    /** Returns true if this manifest revokes the master key */
+    bool
+    revoked() const;
+};
+
+/** Decodes a serialized manifest without copying it
+
+    Only the fields a manifest may carry are accepted: sfSequence,
+    sfVersion, sfPublicKey, sfSigningPubKey, sfDomain, sfSignature and
+    sfMasterSignature. Keys must be valid public keys, and everything but a
+    revocation must name a signing key and carry both signatures.
+
+    Signatures are not verified.
+
+    @return the fields, or boost::none if data is not a well-formed manifest
+*/
+boost::optional<ManifestFields>
+decodeManifest(Slice const& data);
+
+/** Decodes a hex or base64 encoded manifest into out
+
+    @return false if s is neither valid hex nor valid base64
+*/
+bool
+unwrapManifest(std::string_view s, std::string& out);
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,355 @@
+#include <ManifestHistory.h>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace xrpl {
+
+namespace {
+
+char const logMagic[4] = {'V', 'K', 'M', 'H'};
+char const indexMagic[4] = {'V', 'K', 'M', 'I'};
+std::uint32_t const historyVersion = 1;
+
+void
+putU32(std::uint8_t* p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+void
+putU64(std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint32_t
+getU32(std::uint8_t const* p)
+{
+    std::uint32_t v = 0;
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+getU64(std::uint8_t const* p)
+{
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+// Whether a record lies within a log of logSize bytes; written so a
+// corrupt offset cannot overflow
+bool
+inLog(std::uint64_t offset, std::uint32_t length, std::size_t logSize)
+{
+    return offset <= logSize && length <= logSize - offset;
+}
+
+std::array<std::uint8_t, ManifestHistory::indexEntrySize>
+makeIndexEntry(std::uint32_t sequence, std::uint32_t size, std::uint64_t offset)
+{
+    std::array<std::uint8_t, ManifestHistory::indexEntrySize> entry{};
+    putU32(entry.data(), sequence);
+    putU32(entry.data() + 4, size);
+    putU64(entry.data() + 8, offset);
+    return entry;
+}
+
+std::array<std::uint8_t, ManifestHistory::indexHeaderSize>
+makeIndexHeader()
+{
+    std::array<std::uint8_t, ManifestHistory::indexHeaderSize> header{};
+    std::memcpy(header.data(), indexMagic, sizeof(indexMagic));
+    putU32(header.data() + 4, historyVersion);
+    return header;
+}
+
+template <std::size_t N>
+void
+writeBytes(
+    std::ofstream& o,
+    std::array<std::uint8_t, N> const& bytes,
+    boost::filesystem::path const& file)
+{
+    o.write(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+    if (o.fail())
+        throw std::runtime_error(
+            "Cannot write manifest history: " + file.string());
+}
+
+}  // namespace
+
+ManifestHistory::ManifestHistory(boost::filesystem::path const& keyFile)
+    : log_(keyFile.string() + ".history")
+    , index_(keyFile.string() + ".history.idx")
+{
+}
+
+std::uint64_t
+ManifestHistory::indexedLogSize() const
+{
+    using namespace boost::filesystem;
+
+    boost::system::error_code ec;
+    auto const size = file_size(index_, ec);
+    if (ec || size < indexHeaderSize ||
+        (size - indexHeaderSize) % indexEntrySize != 0)
+        return 0;
+    if (size == indexHeaderSize)
+        return logHeaderSize;
+
+    std::array<std::uint8_t, indexEntrySize> last{};
+    std::ifstream in(index_.string(), std::ios::binary);
+    in.seekg(size - indexEntrySize);
+    in.read(reinterpret_cast<char*>(last.data()), last.size());
+    if (in.gcount() != last.size())
+        return 0;
+    return getU64(last.data() + 8) + getU32(last.data() + 4);
+}
+
+std::uint64_t
+ManifestHistory::rebuildIndex() const
+{
+    std::ifstream in(log_.string(), std::ios::binary);
+    std::vector<std::uint8_t> const log(
+        (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::ofstream o(index_.string(), std::ios::binary | std::ios::trunc);
+    if (o.fail())
+        throw std::runtime_error(
+            "Cannot open manifest history index: " + index_.string());
+
+    writeBytes(o, makeIndexHeader(), index_);
+
+    // Stop at a record cut short by an interrupted append
+    std::size_t pos = logHeaderSize;
+    while (pos + 8 <= log.size())
+    {
+        auto const size = getU32(log.data() + pos + 4);
+        if (log.size() - pos - 8 < size)
+            break;
+        writeBytes(
+            o, makeIndexEntry(getU32(log.data() + pos), size, pos + 8), index_);
+        pos += 8 + size;
+    }
+    return pos;
+}
+
+void
+ManifestHistory::append(
+    PublicKey const& masterKey,
+    std::uint32_t sequence,
+    Slice const& manifest) const
+{
+    using namespace boost::filesystem;
+
+    if (manifest.size() > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Manifest is too large to log");
+
+    std::array<std::uint8_t, logHeaderSize> header{};
+    std::memcpy(header.data(), logMagic, sizeof(logMagic));
+    putU32(header.data() + 4, historyVersion);
+    header[8] = static_cast<std::uint8_t>(masterKey.size());
+    std::memcpy(header.data() + 9, masterKey.data(), masterKey.size());
+
+    std::uint64_t logSize = exists(log_) ? file_size(log_) : 0;
+
+    if (logSize == 0)
+    {
+        std::ofstream o(log_.string(), std::ios::binary | std::ios::trunc);
+        if (o.fail())
+            throw std::runtime_error(
+                "Cannot open manifest history: " + log_.string());
+        writeBytes(o, header, log_);
+        logSize = header.size();
+
+        // An index without its log is stale
+        boost::system::error_code ec;
+        remove(index_, ec);
+    }
+    else
+    {
+        std::array<std::uint8_t, logHeaderSize> existing{};
+        std::ifstream in(log_.string(), std::ios::binary);
+        in.read(reinterpret_cast<char*>(existing.data()), existing.size());
+        if (in.gcount() != existing.size() ||
+            std::memcmp(existing.data(), logMagic, sizeof(logMagic)) != 0)
+            throw std::runtime_error(
+                "Corrupt manifest history: " + log_.string());
+        if (existing != header)
+            throw std::runtime_error(
+                "Manifest history " + log_.string() +
+                " belongs to a different master key");
+    }
+
+    // A crash between the two writes of an earlier append leaves the index
+    // short of the log, or the log ending in part of a record. Either way
+    // the index is rebuilt and the partial record dropped, so the entry
+    // written below lines up with its record.
+    if (indexedLogSize() != logSize)
+    {
+        auto const end = rebuildIndex();
+        if (end != logSize)
+        {
+            resize_file(log_, end);
+            logSize = end;
+        }
+    }
+
+    std::array<std::uint8_t, 8> recordHeader{};
+    putU32(recordHeader.data(), sequence);
+    putU32(recordHeader.data() + 4, manifest.size());
+
+    {
+        std::ofstream o(log_.string(), std::ios::binary | std::ios::app);
+        if (o.fail())
+            throw std::runtime_error(
+                "Cannot open manifest history: " + log_.string());
+        writeBytes(o, recordHeader, log_);
+        o.write(
+            reinterpret_cast<char const*>(manifest.data()), manifest.size());
+        if (o.fail())
+            throw std::runtime_error(
+                "Cannot write manifest history: " + log_.string());
+    }
+
+    std::ofstream o(index_.string(), std::ios::binary | std::ios::app);
+    if (o.fail())
+        throw std::runtime_error(
+            "Cannot open manifest history index: " + index_.string());
+    auto const offset = logSize + recordHeader.size();
+    writeBytes(o, makeIndexEntry(sequence, manifest.size(), offset), index_);
+}
+
+ManifestHistoryReader::ManifestHistoryReader(
+    boost::filesystem::path const& keyFile)
+{
+    using namespace boost::interprocess;
+
+    ManifestHistory const history(keyFile);
+    logPath_ = history.logPath();
+
+    if (!exists(history.logPath()) || !exists(history.indexPath()))
+        return;
+
+    if (file_size(history.logPath()) < ManifestHistory::logHeaderSize ||
+        file_size(history.indexPath()) < ManifestHistory::indexHeaderSize)
+        throw std::runtime_error(
+            "Corrupt manifest history: " + history.logPath().string());
+
+    logFile_ = file_mapping(history.logPath().string().c_str(), read_only);
+    log_ = mapped_region(logFile_, read_only);
+    indexFile_ = file_mapping(history.indexPath().string().c_str(), read_only);
+    index_ = mapped_region(indexFile_, read_only);
+
+    auto const log = static_cast<std::uint8_t const*>(log_.get_address());
+    auto const index = static_cast<std::uint8_t const*>(index_.get_address());
+
+    if (std::memcmp(log, logMagic, sizeof(logMagic)) != 0 ||
+        getU32(log + 4) != historyVersion ||
+        std::memcmp(index, indexMagic, sizeof(indexMagic)) != 0 ||
+        getU32(index + 4) != historyVersion)
+        throw std::runtime_error(
+            "Corrupt manifest history: " + history.logPath().string());
+
+    size_ = (index_.get_size() - ManifestHistory::indexHeaderSize) /
+        ManifestHistory::indexEntrySize;
+
+    // Ignore entries for records that did not make it into the log
+    auto const entry = [&](std::size_t i) {
+        return index + ManifestHistory::indexHeaderSize +
+            i * ManifestHistory::indexEntrySize;
+    };
+    while (size_ != 0 &&
+           !inLog(
+               getU64(entry(size_ - 1) + 8),
+               getU32(entry(size_ - 1) + 4),
+               log_.get_size()))
+        --size_;
+}
+
+std::uint32_t
+ManifestHistoryReader::sequenceAt(std::size_t i) const
+{
+    auto const index = static_cast<std::uint8_t const*>(index_.get_address());
+    return getU32(
+        index + ManifestHistory::indexHeaderSize +
+        i * ManifestHistory::indexEntrySize);
+}
+
+Slice
+ManifestHistoryReader::manifestAt(std::size_t i) const
+{
+    auto const index = static_cast<std::uint8_t const*>(index_.get_address());
+    auto const entry = index + ManifestHistory::indexHeaderSize +
+        i * ManifestHistory::indexEntrySize;
+    auto const offset = getU64(entry + 8);
+    auto const length = getU32(entry + 4);
+    if (!inLog(offset, length, log_.get_size()))
+        throw std::runtime_error(
+            "Corrupt manifest history: " + logPath_.string());
+
+    auto const log = static_cast<std::uint8_t const*>(log_.get_address());
+    return Slice(log + offset, length);
+}
+
+boost::optional<PublicKey>
+ManifestHistoryReader::masterKey() const
+{
+    if (log_.get_size() < ManifestHistory::logHeaderSize)
+        return boost::none;
+
+    // Checked first, since constructing a key from bad bytes is a logic
+    // error rather than a runtime one
+    auto const log = static_cast<std::uint8_t const*>(log_.get_address());
+    auto const length = log[8];
+    if (length > ManifestHistory::logHeaderSize - 9 ||
+        !publicKeyType(Slice(log + 9, length)))
+        throw std::runtime_error(
+            "Corrupt manifest history: " + logPath_.string());
+
+    return PublicKey(Slice(log + 9, length));
+}
+
+boost::optional<Slice>
+ManifestHistoryReader::find(std::uint32_t sequence) const
+{
+    if (size_ == 0)
+        return boost::none;
+
+    // The latest manifest, including any revocation, is always last
+    if (sequenceAt(size_ - 1) == sequence)
+        return manifestAt(size_ - 1);
+
+    // Tokens are issued with consecutive sequences, so the entry for a
+    // sequence normally sits at a fixed distance from the first one.
+    auto const first = sequenceAt(0);
+    if (sequence >= first)
+    {
+        std::size_t const slot = sequence - first;
+        if (slot < size_ && sequenceAt(slot) == sequence)
+            return manifestAt(slot);
+    }
+
+    // Gaps in the history (e.g. a key file restored from a backup)
+    for (auto i = size_; i-- != 0;)
+    {
+        if (sequenceAt(i) == sequence)
+            return manifestAt(i);
+    }
+
+    return boost::none;
+}
+
+}  // namespace xrpl
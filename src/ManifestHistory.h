@@ -0,0 +1,140 @@
+#ifndef VALIDATOR_KEYS_MANIFESTHISTORY_H_INCLUDED
+#define VALIDATOR_KEYS_MANIFESTHISTORY_H_INCLUDED
+
+#include <xrpl/basics/Slice.h>
+#include <xrpl/protocol/PublicKey.h>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+
+namespace xrpl {
+
+/**
+   Append-only log of every manifest issued for a validator master key.
+
+   The log is kept next to the key file in two parts:
+
+   - `<key file>.history` holds a header naming the master public key and
+     one record per manifest: a little-endian 32-bit sequence, a 32-bit
+     length and the serialized manifest.
+   - `<key file>.history.idx` holds a fixed-size entry (sequence, length,
+     offset into the log) per record, in the order they were appended.
+
+   Appending writes one record to each file and never rewrites existing
+   data, so its cost does not depend on the size of the history. An index
+   left behind the log by an interrupted append is rebuilt on the next one.
+ */
+class ManifestHistory
+{
+private:
+    boost::filesystem::path log_;
+    boost::filesystem::path index_;
+
+    // Returns the size of the log the index accounts for, or 0 if the
+    // index is missing or cut short
+    std::uint64_t
+    indexedLogSize() const;
+
+    // Returns the size of the complete records in the log
+    std::uint64_t
+    rebuildIndex() const;
+
+public:
+    static constexpr std::size_t logHeaderSize = 48;
+    static constexpr std::size_t indexHeaderSize = 16;
+    static constexpr std::size_t indexEntrySize = 16;
+
+    explicit ManifestHistory(boost::filesystem::path const& keyFile);
+
+    /** Returns the path of the log file */
+    boost::filesystem::path const&
+    logPath() const
+    {
+        return log_;
+    }
+
+    /** Returns the path of the index file */
+    boost::filesystem::path const&
+    indexPath() const
+    {
+        return index_;
+    }
+
+    /** Append a manifest to the log
+
+        @param masterKey Master public key the manifest was issued for
+        @param sequence Sequence of the manifest
+        @param manifest Serialized manifest
+
+        @throws std::runtime_error if the log belongs to another master key
+        or cannot be written
+    */
+    void
+    append(
+        PublicKey const& masterKey,
+        std::uint32_t sequence,
+        Slice const& manifest) const;
+};
+
+/**
+   Memory-mapped, read-only view of a ManifestHistory.
+
+   Lookups by sequence are O(1) while sequences are contiguous, which is the
+   case for tokens issued by this tool, and fall back to a linear scan of
+   the index otherwise. Returned slices point into the mapping and remain
+   valid for the lifetime of the reader.
+ */
+class ManifestHistoryReader
+{
+private:
+    boost::filesystem::path logPath_;
+    boost::interprocess::file_mapping logFile_;
+    boost::interprocess::mapped_region log_;
+    boost::interprocess::file_mapping indexFile_;
+    boost::interprocess::mapped_region index_;
+    std::size_t size_ = 0;
+
+    std::uint32_t
+    sequenceAt(std::size_t i) const;
+
+    Slice
+    manifestAt(std::size_t i) const;
+
+public:
+    /** Map the history of a key file
+
+        A key file without history yields an empty reader.
+
+        @throws std::runtime_error if the history files are corrupt
+    */
+    explicit ManifestHistoryReader(boost::filesystem::path const& keyFile);
+
+    /** Returns the number of manifests in the history */
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    /** Returns the master public key the history belongs to, if any
+
+        @throws std::runtime_error if the log header holds no valid key
+    */
+    boost::optional<PublicKey>
+    masterKey() const;
+
+    /** Returns the manifest with the given sequence, if it was logged
+
+        @throws std::runtime_error if its index entry points outside the log
+    */
+    boost::optional<Slice>
+    find(std::uint32_t sequence) const;
+};
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,29 @@
+#include <MappedFile.h>
+
+#include <boost/filesystem.hpp>
+
+namespace xrpl {
+
+MappedFile::MappedFile(boost::filesystem::path const& path)
+{
+    using namespace boost::interprocess;
+
+    boost::system::error_code ec;
+    auto const size = boost::filesystem::file_size(path, ec);
+    if (ec)
+        throw std::runtime_error("Failed to open file: " + path.string());
+    if (size == 0)
+        return;
+
+    try
+    {
+        file_ = file_mapping(path.string().c_str(), read_only);
+        region_ = mapped_region(file_, read_only);
+    }
+    catch (interprocess_exception const&)
+    {
+        throw std::runtime_error("Failed to map file: " + path.string());
+    }
+}
+
+}  // namespace xrpl
@@ -0,0 +1,42 @@
+#ifndef VALIDATOR_KEYS_MAPPEDFILE_H_INCLUDED
+#define VALIDATOR_KEYS_MAPPEDFILE_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <string_view>
+
+namespace xrpl {
+
+/**
+   Read-only memory mapping of a whole file.
+
+   Empty files, which cannot be mapped, yield empty contents.
+ */
+class MappedFile
+{
+private:
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+
+public:
+    /** Map a file
+
+        @throws std::runtime_error if the file cannot be opened
+    */
+    explicit MappedFile(boost::filesystem::path const& path);
+
+    /** Returns the contents of the file */
+    std::string_view
+    contents() const
+    {
+        return std::string_view(
+            static_cast<char const*>(region_.get_address()),
+            region_.get_size());
+    }
+};
+
+}  // namespace xrpl
+
+#endif
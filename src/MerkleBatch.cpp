@@ -0,0 +1,201 @@
+#include <MerkleBatch.h>
+#include <Parallel.h>
+#include <ValidatorKeys.h>
+
+#include <xrpl/basics/base64.h>
+#include <xrpl/protocol/digest.h>
+
+#include <array>
+
+namespace xrpl {
+
+namespace {
+
+// Hash prefixes: "VKL\0", "VKN\0" and "VKR\0"
+std::array<std::uint8_t, 4> const leafPrefix = {{'V', 'K', 'L', 0}};
+std::array<std::uint8_t, 4> const nodePrefix = {{'V', 'K', 'N', 0}};
+std::array<std::uint8_t, 4> const rootPrefix = {{'V', 'K', 'R', 0}};
+
+std::uint8_t const proofVersion = 1;
+
+uint256
+merkleNode(uint256 const& left, uint256 const& right)
+{
+    sha512_half_hasher h;
+    h(nodePrefix.data(), nodePrefix.size());
+    h(left.data(), left.size());
+    h(right.data(), right.size());
+    return static_cast<uint256>(h);
+}
+
+void
+putU64(std::string& s, std::uint64_t v)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+        s += static_cast<char>(v >> shift);
+}
+
+bool
+getU64(std::string_view& s, std::uint64_t& v)
+{
+    if (s.size() < 8)
+        return false;
+    v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | static_cast<std::uint8_t>(s[i]);
+    s.remove_prefix(8);
+    return true;
+}
+
+}  // namespace
+
+uint256
+merkleLeaf(Slice const& record)
+{
+    sha512_half_hasher h;
+    h(leafPrefix.data(), leafPrefix.size());
+    h(record.data(), record.size());
+    return static_cast<uint256>(h);
+}
+
+uint256
+merkleRootDigest(uint256 const& root, std::uint64_t count)
+{
+    std::string n;
+    putU64(n, count);
+
+    sha512_half_hasher h;
+    h(rootPrefix.data(), rootPrefix.size());
+    h(root.data(), root.size());
+    h(n.data(), n.size());
+    return static_cast<uint256>(h);
+}
+
+MerkleTree::MerkleTree(std::vector<uint256> leaves, unsigned threads)
+{
+    if (leaves.empty())
+        throw std::runtime_error("No records to sign");
+
+    levels_.push_back(std::move(leaves));
+    while (levels_.back().size() > 1)
+    {
+        auto const& below = levels_.back();
+        std::vector<uint256> level((below.size() + 1) / 2);
+        parallelFor(
+            level.size(),
+            [&](std::size_t i) {
+                level[i] = 2 * i + 1 < below.size()
+                    ? merkleNode(below[2 * i], below[2 * i + 1])
+                    : below[2 * i];
+            },
+            threads);
+        levels_.push_back(std::move(level));
+    }
+}
+
+std::vector<uint256>
+MerkleTree::path(std::size_t index) const
+{
+    std::vector<uint256> siblings;
+    for (std::size_t l = 0; l + 1 < levels_.size(); ++l, index /= 2)
+    {
+        auto const sibling = index ^ 1;
+        if (sibling < levels_[l].size())
+            siblings.push_back(levels_[l][sibling]);
+    }
+    return siblings;
+}
+
+boost::optional<uint256>
+merkleRootFromPath(
+    uint256 leaf,
+    std::uint64_t index,
+    std::uint64_t count,
+    std::vector<uint256> const& path)
+{
+    if (index >= count)
+        return boost::none;
+
+    auto sibling = path.begin();
+    for (; count > 1; index /= 2, count = (count + 1) / 2)
+    {
+        // The last node of an odd level has no sibling
+        if ((index ^ 1) >= count)
+            continue;
+
+        if (sibling == path.end())
+            return boost::none;
+        leaf = index % 2 ? merkleNode(*sibling, leaf)
+                         : merkleNode(leaf, *sibling);
+        ++sibling;
+    }
+
+    if (sibling != path.end())
+        return boost::none;
+    return leaf;
+}
+
+std::string
+InclusionProof::encode() const
+{
+    std::string s;
+    s.reserve(18 + path.size() * uint256::bytes + signature.size());
+    s += static_cast<char>(proofVersion);
+    putU64(s, count);
+    putU64(s, index);
+    s += static_cast<char>(path.size());
+    for (auto const& node : path)
+        s.append(reinterpret_cast<char const*>(node.data()), node.size());
+    s.append(
+        reinterpret_cast<char const*>(signature.data()), signature.size());
+    return base64_encode(s);
+}
+
+boost::optional<InclusionProof>
+InclusionProof::decode(std::string_view encoded)
+{
+    auto const raw = base64_decode(std::string(encoded));
+    std::string_view s = raw;
+
+    InclusionProof proof;
+    if (s.empty() || static_cast<std::uint8_t>(s[0]) != proofVersion)
+        return boost::none;
+    s.remove_prefix(1);
+
+    if (!getU64(s, proof.count) || !getU64(s, proof.index) || s.empty())
+        return boost::none;
+
+    std::size_t const depth = static_cast<std::uint8_t>(s[0]);
+    s.remove_prefix(1);
+    if (s.size() <= depth * uint256::bytes)
+        return boost::none;
+
+    proof.path.resize(depth);
+    for (auto& node : proof.path)
+    {
+        std::copy_n(s.data(), node.size(), node.data());
+        s.remove_prefix(node.size());
+    }
+
+    proof.signature = Buffer(s.data(), s.size());
+    return proof;
+}
+
+bool
+verifyInclusion(
+    InclusionProof const& proof,
+    PublicKey const& publicKey,
+    Slice const& record)
+{
+    auto const root = merkleRootFromPath(
+        merkleLeaf(record), proof.index, proof.count, proof.path);
+    if (!root)
+        return false;
+
+    return verifySignedDigest(
+        publicKey,
+        merkleRootDigest(*root, proof.count),
+        Slice(proof.signature.data(), proof.signature.size()));
+}
+
+}  // namespace xrpl
@@ -0,0 +1,111 @@
+#ifndef VALIDATOR_KEYS_MERKLEBATCH_H_INCLUDED
+#define VALIDATOR_KEYS_MERKLEBATCH_H_INCLUDED
+
+#include <xrpl/basics/Buffer.h>
+#include <xrpl/basics/Slice.h>
+#include <xrpl/basics/base_uint.h>
+#include <xrpl/protocol/PublicKey.h>
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xrpl {
+
+/** Returns the leaf hash of a record
+
+    Leaves, inner nodes and the signed root are hashed with distinct
+    prefixes, so no value can be passed off as another kind.
+*/
+uint256
+merkleLeaf(Slice const& record);
+
+/** Returns the digest signed for a batch: its root and record count */
+uint256
+merkleRootDigest(uint256 const& root, std::uint64_t count);
+
+/**
+   Merkle tree over the leaf hashes of a batch of records.
+
+   Each level pairs adjacent nodes; an odd node out is carried up to the
+   next level unchanged rather than paired with itself, so a tree can never
+   be extended with duplicated records.
+ */
+class MerkleTree
+{
+private:
+    // levels_[0] holds the leaves, levels_.back() the root
+    std::vector<std::vector<uint256>> levels_;
+
+public:
+    /** Builds the tree
+
+        @param threads Threads used to hash each level, 0 for one per core
+
+        @throws std::runtime_error if there are no leaves
+    */
+    explicit MerkleTree(std::vector<uint256> leaves, unsigned threads = 0);
+
+    uint256 const&
+    root() const
+    {
+        return levels_.back().front();
+    }
+
+    std::size_t
+    size() const
+    {
+        return levels_.front().size();
+    }
+
+    /** Returns the sibling hashes from a leaf up to the root */
+    std::vector<uint256>
+    path(std::size_t index) const;
+};
+
+/** Returns the root a leaf and its path lead to
+
+    @return boost::none if the path does not fit the index and count
+*/
+boost::optional<uint256>
+merkleRootFromPath(
+    uint256 leaf,
+    std::uint64_t index,
+    std::uint64_t count,
+    std::vector<uint256> const& path);
+
+/** Everything needed to check one record of a signed batch */
+struct InclusionProof
+{
+    std::uint64_t count = 0;
+    std::uint64_t index = 0;
+    std::vector<uint256> path;
+
+    // ValidatorKeys::signDigest of merkleRootDigest(root, count)
+    Buffer signature;
+
+    /** Returns the proof as base64 */
+    std::string
+    encode() const;
+
+    /** Decodes a proof written by encode()
+
+        @return boost::none if s is not a well-formed proof
+    */
+    static boost::optional<InclusionProof>
+    decode(std::string_view s);
+};
+
+/** Returns true if the proof shows the record was signed by publicKey */
+bool
+verifyInclusion(
+    InclusionProof const& proof,
+    PublicKey const& publicKey,
+    Slice const& record);
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,284 @@
+#include <AtomicFile.h>
+#include <Metrics.h>
+
+#include <bit>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace xrpl {
+
+namespace {
+
+// Depth of timed operations of each kind on this thread
+thread_local std::array<unsigned, operationCount> timerDepth{};
+
+volatile std::sig_atomic_t dumpRequested = 0;
+
+std::string
+seconds(std::uint64_t nanoseconds)
+{
+    std::ostringstream os;
+    os << nanoseconds / 1000000000 << '.' << std::setw(9) << std::setfill('0')
+       << nanoseconds % 1000000000;
+    return os.str();
+}
+
+#ifndef _WIN32
+void
+sendToSocket(std::string const& path, std::string const& text)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Socket path is too long: " + path);
+    std::memcpy(addr.sun_path, path.data(), path.size());
+
+    int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw std::runtime_error("Cannot write metrics to socket: " + path);
+
+    // A reader that goes away must not kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+    int const flags = MSG_NOSIGNAL;
+#else
+    int const flags = 0;
+#endif
+
+    bool ok =
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    for (std::size_t sent = 0; ok && sent < text.size();)
+    {
+        auto const n =
+            ::send(fd, text.data() + sent, text.size() - sent, flags);
+        ok = n > 0;
+        if (ok)
+            sent += n;
+    }
+    ::close(fd);
+
+    if (!ok)
+        throw std::runtime_error("Cannot write metrics to socket: " + path);
+}
+
+extern "C" void
+onDumpSignal(int)
+{
+    dumpRequested = 1;
+}
+#endif
+
+}  // namespace
+
+char const*
+to_string(Operation op)
+{
+    switch (op)
+    {
+        case Operation::sign:
+            return "sign";
+        case Operation::createToken:
+            return "create_token";
+        case Operation::revoke:
+            return "revoke";
+        case Operation::loadKeys:
+            return "load_keys";
+        case Operation::writeKeys:
+            return "write_keys";
+    }
+    return "unknown";
+}
+
+std::size_t
+LatencyHistogram::bucketIndex(std::uint64_t nanoseconds) noexcept
+{
+    std::uint64_t const subBuckets = 1 << subBucketBits;
+    if (nanoseconds < subBuckets)
+        return nanoseconds;
+    if (nanoseconds >> maxBits != 0)
+        return bucketCount;
+
+    // The power of two picks the group, the next bits the bucket within it
+    unsigned const msb = std::bit_width(nanoseconds) - 1;
+    std::size_t const group = msb - subBucketBits + 1;
+    return (group << subBucketBits) +
+        (nanoseconds >> (msb - subBucketBits)) - subBuckets;
+}
+
+std::uint64_t
+LatencyHistogram::bucketUpperBound(std::size_t index) noexcept
+{
+    std::uint64_t const subBuckets = 1 << subBucketBits;
+    std::size_t const group = index >> subBucketBits;
+    std::uint64_t const sub = index & (subBuckets - 1);
+    if (group == 0)
+        return sub;
+    return ((subBuckets + sub + 1) << (group - 1)) - 1;
+}
+
+void
+LatencyHistogram::record(std::uint64_t nanoseconds) noexcept
+{
+    auto const i = bucketIndex(nanoseconds);
+    (i < bucketCount ? buckets_[i] : overflow_)
+        .fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot
+LatencyHistogram::snapshot() const
+{
+    // The count is taken from the buckets read, so it agrees with them even
+    // while operations are being recorded
+    Snapshot s;
+    s.sum = sum_.load(std::memory_order_relaxed);
+    s.count = overflow_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < bucketCount; ++i)
+    {
+        auto const n = buckets_[i].load(std::memory_order_relaxed);
+        if (n == 0)
+            continue;
+        s.buckets.emplace_back(bucketUpperBound(i), n);
+        s.count += n;
+    }
+    return s;
+}
+
+void
+Metrics::record(
+    Operation op,
+    std::chrono::nanoseconds elapsed,
+    bool failed) noexcept
+{
+    auto const i = static_cast<std::size_t>(op);
+    latency_[i].record(elapsed.count() < 0 ? 0 : elapsed.count());
+    if (failed)
+        failures_[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string
+Metrics::prometheus() const
+{
+    std::string const latency = "validator_keys_operation_duration_seconds";
+    std::string const total = "validator_keys_operations_total";
+    std::string const failed = "validator_keys_operation_failures_total";
+
+    std::array<LatencyHistogram::Snapshot, operationCount> snapshots;
+    for (std::size_t i = 0; i < operationCount; ++i)
+        snapshots[i] = latency_[i].snapshot();
+
+    auto const label = [](std::size_t i) {
+        return std::string("operation=\"") +
+            to_string(static_cast<Operation>(i)) + "\"";
+    };
+
+    std::ostringstream os;
+    os << "# HELP " << latency << " Latency of operations on keys.\n"
+       << "# TYPE " << latency << " histogram\n";
+    for (std::size_t i = 0; i < operationCount; ++i)
+    {
+        auto const& s = snapshots[i];
+        std::uint64_t cumulative = 0;
+        for (auto const& [bound, n] : s.buckets)
+        {
+            cumulative += n;
+            os << latency << "_bucket{" << label(i) << ",le=\""
+               << seconds(bound) << "\"} " << cumulative << "\n";
+        }
+        os << latency << "_bucket{" << label(i) << ",le=\"+Inf\"} "
+           << s.count << "\n"
+           << latency << "_sum{" << label(i) << "} " << seconds(s.sum)
+           << "\n"
+           << latency << "_count{" << label(i) << "} " << s.count << "\n";
+    }
+
+    os << "# HELP " << total << " Operations on keys performed.\n"
+       << "# TYPE " << total << " counter\n";
+    for (std::size_t i = 0; i < operationCount; ++i)
+        os << total << "{" << label(i) << "} " << snapshots[i].count << "\n";
+
+    os << "# HELP " << failed << " Operations on keys that failed.\n"
+       << "# TYPE " << failed << " counter\n";
+    for (std::size_t i = 0; i < operationCount; ++i)
+        os << failed << "{" << label(i) << "} "
+           << failures(static_cast<Operation>(i)) << "\n";
+
+    return os.str();
+}
+
+Metrics&
+metrics()
+{
+    static Metrics m;
+    return m;
+}
+
+OperationTimer::OperationTimer(Operation op)
+    : op_(op)
+    , outermost_(timerDepth[static_cast<std::size_t>(op)]++ == 0)
+    , exceptions_(std::uncaught_exceptions())
+    , start_(std::chrono::steady_clock::now())
+{
+}
+
+OperationTimer::~OperationTimer()
+{
+    --timerDepth[static_cast<std::size_t>(op_)];
+    if (outermost_)
+        metrics().record(
+            op_,
+            std::chrono::steady_clock::now() - start_,
+            std::uncaught_exceptions() > exceptions_);
+}
+
+void
+dumpMetrics(std::string const& target)
+{
+    auto const text = metrics().prometheus();
+
+    std::string const unixPrefix = "unix:";
+    if (target.compare(0, unixPrefix.size(), unixPrefix) != 0)
+    {
+        writeFileAtomic(target, text);
+        return;
+    }
+
+#ifndef _WIN32
+    sendToSocket(target.substr(unixPrefix.size()), text);
+#else
+    throw std::runtime_error("Unix sockets are not supported: " + target);
+#endif
+}
+
+void
+requestMetricsOnSignal()
+{
+#ifndef _WIN32
+    // Without SA_RESTART, so the signal ends a wait in progress
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onDumpSignal;
+    sigemptyset(&sa.sa_mask);
+    ::sigaction(SIGUSR1, &sa, nullptr);
+#endif
+}
+
+bool
+metricsDumpRequested()
+{
+    if (!dumpRequested)
+        return false;
+    dumpRequested = 0;
+    return true;
+}
+
+}  // namespace xrpl
@@ -0,0 +1,171 @@
+#ifndef VALIDATOR_KEYS_METRICS_H_INCLUDED
+#define VALIDATOR_KEYS_METRICS_H_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xrpl {
+
+/** Operations on keys whose latency is measured */
+enum class Operation {
+    sign,
+    createToken,
+    revoke,
+    loadKeys,
+    writeKeys,
+};
+
+std::size_t const operationCount = 5;
+
+/** Returns the label of an operation in the metrics, e.g. "create_token" */
+char const*
+to_string(Operation op);
+
+/** Histogram of latencies in nanoseconds, updated without locks
+
+    Buckets are laid out as in an HDR histogram: values below 8ns have a
+    bucket each, and every power of two above is split into 8 buckets, so a
+    latency is known to within 12.5%. Latencies from 2^40ns (about 18
+    minutes) on fall in no bucket, and are only counted in the total and
+    the sum, so they are exported under le="+Inf" alone.
+*/
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned subBucketBits = 3;
+    static constexpr unsigned maxBits = 40;
+    static constexpr std::size_t bucketCount =
+        (maxBits - subBucketBits + 1) << subBucketBits;
+
+    /** What the histogram held at one moment */
+    struct Snapshot
+    {
+        // Inclusive upper bound in nanoseconds and count of every bucket
+        // that is not empty, in increasing order
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> buckets;
+
+        std::uint64_t count = 0;
+
+        // Sum of all latencies, in nanoseconds
+        std::uint64_t sum = 0;
+    };
+
+    void
+    record(std::uint64_t nanoseconds) noexcept;
+
+    Snapshot
+    snapshot() const;
+
+    /** Returns the bucket of a latency, or bucketCount if it is too large
+        for any bucket
+    */
+    static std::size_t
+    bucketIndex(std::uint64_t nanoseconds) noexcept;
+
+    /** Returns the largest latency that falls in a bucket */
+    static std::uint64_t
+    bucketUpperBound(std::size_t index) noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucketCount> buckets_{};
+    std::atomic<std::uint64_t> overflow_{0};
+    std::atomic<std::uint64_t> sum_{0};
+};
+
+/** Latencies and failures of every operation */
+class Metrics
+{
+public:
+    void
+    record(
+        Operation op,
+        std::chrono::nanoseconds elapsed,
+        bool failed) noexcept;
+
+    LatencyHistogram const&
+    latency(Operation op) const
+    {
+        return latency_[static_cast<std::size_t>(op)];
+    }
+
+    std::uint64_t
+    failures(Operation op) const
+    {
+        return failures_[static_cast<std::size_t>(op)].load(
+            std::memory_order_relaxed);
+    }
+
+    /** Returns the metrics in the Prometheus text exposition format
+
+        Only buckets that are not empty are listed, which Prometheus
+        accepts, since the full layout would be hundreds of lines per
+        operation.
+    */
+    std::string
+    prometheus() const;
+
+private:
+    std::array<LatencyHistogram, operationCount> latency_;
+    std::array<std::atomic<std::uint64_t>, operationCount> failures_{};
+};
+
+/** Returns the metrics of this process */
+Metrics&
+metrics();
+
+/** Times an operation from construction to destruction
+
+    The operation counts as failed if it is left by an exception. An
+    operation timed while another of the same kind is timed on the same
+    thread, such as a signature made on behalf of another signature, is
+    only counted once.
+*/
+class OperationTimer
+{
+public:
+    explicit OperationTimer(Operation op);
+
+    ~OperationTimer();
+
+    OperationTimer(OperationTimer const&) = delete;
+    OperationTimer&
+    operator=(OperationTimer const&) = delete;
+
+private:
+    Operation op_;
+    bool outermost_;
+    int exceptions_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/** Writes the metrics of this process in the Prometheus text format
+
+    @param target A file, which is replaced atomically, or "unix:" and the
+                  path of a Unix domain socket to send the metrics to
+
+    @throws std::runtime_error if the metrics cannot be written
+*/
+void
+dumpMetrics(std::string const& target);
+
+/** Makes SIGUSR1 request a dump of the metrics
+
+    The signal interrupts waits, so a long-running command can check
+    metricsDumpRequested when it wakes. Does nothing on Windows.
+*/
+void
+requestMetricsOnSignal();
+
+/** Returns whether a dump was requested since the last call */
+bool
+metricsDumpRequested();
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,65 @@
+#include <OutputWriter.h>
+
+#include <xrpl/json/to_string.h>
+
+namespace xrpl {
+
+std::string
+toJsonLine(Json::Value const& jv)
+{
+    auto line = to_string(jv);
+    while (!line.empty() && line.back() == '\n')
+        line.pop_back();
+    line += '\n';
+    return line;
+}
+
+OutputWriter::OutputWriter(std::ostream& os) : os_(os)
+{
+}
+
+OutputWriter::~OutputWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch (std::exception const&)
+    {
+        // The stream is gone; there is nobody left to tell.
+    }
+}
+
+OutputWriter&
+OutputWriter::operator<<(std::string_view s)
+{
+    buffer_.append(s.data(), s.size());
+    if (buffer_.size() >= flushThreshold)
+        flush();
+    return *this;
+}
+
+OutputWriter&
+OutputWriter::operator<<(char c)
+{
+    return *this << std::string_view(&c, 1);
+}
+
+void
+OutputWriter::record(Json::Value const& jv)
+{
+    *this << std::string_view(toJsonLine(jv));
+}
+
+void
+OutputWriter::flush()
+{
+    if (buffer_.empty())
+        return;
+
+    os_.write(buffer_.data(), buffer_.size());
+    os_.flush();
+    buffer_.clear();
+}
+
+}  // namespace xrpl
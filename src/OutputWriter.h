@@ -0,0 +1,67 @@
+#ifndef VALIDATOR_KEYS_OUTPUTWRITER_H_INCLUDED
+#define VALIDATOR_KEYS_OUTPUTWRITER_H_INCLUDED
+
+#include <xrpl/json/json_value.h>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace xrpl {
+
+/** Returns jv serialized compactly and terminated by a newline */
+std::string
+toJsonLine(Json::Value const& jv);
+
+/**
+   Buffers command output and writes it to a stream in large blocks.
+
+   Text is appended verbatim. JSON records are serialized compactly, one
+   per line (JSON Lines). Nothing reaches the stream until the buffer grows
+   past flushThreshold, flush() is called or the writer is destroyed, so
+   there are no per-line flushes.
+ */
+class OutputWriter
+{
+private:
+    std::ostream& os_;
+    std::string buffer_;
+
+public:
+    static constexpr std::size_t flushThreshold = 64 * 1024;
+
+    explicit OutputWriter(std::ostream& os);
+
+    ~OutputWriter();
+    OutputWriter(OutputWriter const&) = delete;
+    OutputWriter&
+    operator=(OutputWriter const&) = delete;
+
+    /** Append text */
+    OutputWriter&
+    operator<<(std::string_view s);
+
+    OutputWriter&
+    operator<<(char c);
+
+    template <class Integral>
+    std::enable_if_t<std::is_integral_v<Integral>, OutputWriter&>
+    operator<<(Integral i)
+    {
+        return *this << std::string_view(std::to_string(i));
+    }
+
+    /** Append a JSON value as a single line */
+    void
+    record(Json::Value const& jv);
+
+    /** Write buffered output to the stream */
+    void
+    flush();
+};
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef VALIDATOR_KEYS_PARALLEL_H_INCLUDED
+#define VALIDATOR_KEYS_PARALLEL_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xrpl {
+
+/** Returns how many threads to use for n independent items
+
+    @param threads Requested number of threads, 0 for one per core
+*/
+inline unsigned
+workerCount(std::size_t n, unsigned threads = 0)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::min<std::size_t>(threads, n));
+}
+
+/** Calls f(i) for every i in [0, n) on up to `threads` threads
+
+    Items are handed out in batches from a shared counter, so uneven item
+    costs balance out. The calling thread takes part in the work. If a call
+    throws, the remaining items are skipped and the first exception is
+    rethrown once all threads have stopped.
+
+    @param threads Number of threads, 0 for one per core
+*/
+template <class F>
+void
+parallelFor(std::size_t n, F const& f, unsigned threads = 0)
+{
+    auto const workers = workerCount(n, threads);
+    if (workers <= 1)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            f(i);
+        return;
+    }
+
+    std::size_t const batch = std::max<std::size_t>(1, n / (workers * 16));
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto const work = [&] {
+        try
+        {
+            while (!failed)
+            {
+                auto const first = next.fetch_add(batch);
+                if (first >= n)
+                    return;
+                auto const last = std::min(n, first + batch);
+                for (auto i = first; i < last; ++i)
+                    f(i);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned i = 1; i < workers; ++i)
+        pool.emplace_back(work);
+    work();
+    for (auto& t : pool)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,178 @@
+#include <Parallel.h>
+#include <UnitTestRunner.h>
+
+#include <xrpl/beast/unit_test.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+using namespace beast::unit_test;
+
+/** A unique working directory for the duration of a test run */
+class TestDirectory
+{
+private:
+    boost::filesystem::path previous_;
+    boost::filesystem::path dir_;
+
+public:
+    TestDirectory()
+    {
+        using namespace boost::filesystem;
+
+        dir_ = temp_directory_path() /
+            unique_path("validator-keys-test-%%%%-%%%%-%%%%");
+        create_directories(dir_);
+        previous_ = current_path();
+        current_path(dir_);
+    }
+
+    ~TestDirectory()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::current_path(previous_, ec);
+        boost::filesystem::remove_all(dir_, ec);
+    }
+
+    TestDirectory(TestDirectory const&) = delete;
+    TestDirectory&
+    operator=(TestDirectory const&) = delete;
+
+    boost::filesystem::path const&
+    path() const
+    {
+        return dir_;
+    }
+};
+
+// Manual suites, such as benchmarks, only run when asked for by name
+std::vector<suite_info const*>
+selectSuites(std::string const& pattern)
+{
+    std::vector<suite_info const*> suites;
+    auto match = match_auto(pattern);
+    for (auto const& s : global_suites())
+    {
+        if (pattern.empty() ? !s.manual() : match(s))
+            suites.push_back(&s);
+    }
+    return suites;
+}
+
+std::string
+quote(std::string const& s)
+{
+    std::string out = "\"";
+    for (auto const c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+int
+runInProcess(UnitTestOptions const& options)
+{
+    TestDirectory const dir;
+
+    reporter r;
+    r.arg(options.testCase);
+    bool anyFailed = false;
+    for (auto const s : selectSuites(options.pattern))
+        anyFailed = r.run(*s) || anyFailed;
+    return anyFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int
+runInWorkers(UnitTestOptions const& options)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto const suites = selectSuites(options.pattern);
+    TestDirectory const dir;
+
+    struct Result
+    {
+        std::chrono::duration<double> elapsed{};
+        bool failed = false;
+    };
+    std::vector<Result> results(suites.size());
+    std::mutex outputMutex;
+
+    auto const start = clock::now();
+    xrpl::parallelFor(
+        suites.size(),
+        [&](std::size_t i) {
+            auto const name = suites[i]->full_name();
+            auto const log = dir.path() / (name + ".log");
+
+            std::string command = quote(options.program) +
+                " --unittest=" + quote(name) + " --unittest-jobs=1";
+            if (!options.testCase.empty())
+                command += " --unittest-case=" + quote(options.testCase);
+            command += " >" + quote(log.string()) + " 2>&1";
+
+            auto const suiteStart = clock::now();
+            results[i].failed = std::system(command.c_str()) != 0;
+            results[i].elapsed = clock::now() - suiteStart;
+
+            std::ifstream in(log.string());
+            std::stringstream output;
+            output << in.rdbuf();
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << output.str()
+                      << (results[i].failed ? "FAILED " : "passed ") << name
+                      << " in " << std::fixed << std::setprecision(3)
+                      << results[i].elapsed.count() << "s\n"
+                      << std::endl;
+        },
+        options.jobs);
+    std::chrono::duration<double> const elapsed = clock::now() - start;
+
+    std::vector<std::size_t> order(suites.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](auto a, auto b) {
+        return results[a].elapsed > results[b].elapsed;
+    });
+
+    std::size_t failures = 0;
+    std::cout << "Suite times:\n" << std::fixed << std::setprecision(3);
+    for (auto const i : order)
+    {
+        std::cout << std::setw(10) << results[i].elapsed.count() << "s "
+                  << suites[i]->full_name()
+                  << (results[i].failed ? " FAILED" : "") << "\n";
+        if (results[i].failed)
+            ++failures;
+    }
+    std::cout << elapsed.count() << "s, " << suites.size() << " suites, "
+              << xrpl::workerCount(suites.size(), options.jobs)
+              << " jobs, " << failures << " failed" << std::endl;
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int
+runUnitTests(UnitTestOptions const& options)
+{
+    if (options.jobs == 1 || options.program.empty())
+        return runInProcess(options);
+    return runInWorkers(options);
+}
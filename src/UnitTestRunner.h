@@ -0,0 +1,36 @@
+#ifndef VALIDATOR_KEYS_UNITTESTRUNNER_H_INCLUDED
+#define VALIDATOR_KEYS_UNITTESTRUNNER_H_INCLUDED
+
+#include <string>
+
+/** How to run the unit tests */
+struct UnitTestOptions
+{
+    // Suite, module or library to run; empty for every automatic suite
+    std::string pattern;
+
+    // Only run test cases whose name contains this
+    std::string testCase;
+
+    // Suites run concurrently, each in its own process; 0 for one per core
+    unsigned jobs = 1;
+
+    // This executable, to start the worker processes
+    std::string program;
+};
+
+/** Runs the selected unit test suites
+
+    Every process runs the tests in a fresh, uniquely named directory under
+    the system temp directory, so the relative paths the tests use never
+    collide with each other or with leftovers of an interrupted run. With
+    more than one job, each suite is run by a separate invocation of
+    options.program and its output is printed when it completes, followed
+    by the time every suite took.
+
+    @return EXIT_SUCCESS if every suite passed, EXIT_FAILURE otherwise
+*/
+int
+runUnitTests(UnitTestOptions const& options);
+
+#endif
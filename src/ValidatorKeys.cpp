@@ -1,3 +1,6 @@
+#include <AtomicFile.h>
+#include <EntropySource.h>
+#include <Metrics.h>
 #include <ValidatorKeys.h>
 
 #include <xrpl/basics/StringUtilities.h>
@@ -6,6 +9,7 @@
 #include <xrpl/json/to_string.h>
 #include <xrpl/protocol/HashPrefix.h>
 #include <xrpl/protocol/Sign.h>
+#include <xrpl/protocol/digest.h>
 
 #include <boost/algorithm/clamp.hpp>
 #include <boost/filesystem.hpp>
@@ -25,11 +29,27 @@ ValidatorToken::toString() const
     return xrpl::base64_encode(to_string(jv));
 }
 
+SigningPayload::SigningPayload(std::string d)
+    : data(std::move(d)), digest(sha512Half(makeSlice(data)))
+{
+}
+
+bool
+verifySignedDigest(
+    PublicKey const& publicKey,
+    uint256 const& digest,
+    Slice const& signature)
+{
+    if (publicKeyType(publicKey) == KeyType::secp256k1)
+        return verifyDigest(publicKey, digest, signature);
+    return verify(publicKey, Slice(digest.data(), digest.size()), signature);
+}
+
 ValidatorKeys::ValidatorKeys(KeyType const& keyType)
     : keyType_(keyType)
     , tokenSequence_(0)
     , revoked_(false)
-    , keys_(generateKeyPair(keyType_, randomSeed()))
+    , keys_(generateKeyPair(keyType_, generateSeed()))
 {
 }
 
@@ -48,6 +68,8 @@ ValidatorKeys::ValidatorKeys(
 ValidatorKeys
 ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
 {
+    OperationTimer const timer(Operation::loadKeys);
+
     std::ifstream ifsKeys(keyFile.c_str(), std::ios::in);
 
     if (!ifsKeys)
@@ -62,6 +84,16 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
             "Unable to parse json key file: " + keyFile.string());
     }
 
+    return make_ValidatorKeys(jKeys, keyFile.string());
+}
+
+ValidatorKeys
+ValidatorKeys::make_ValidatorKeys(
+    Json::Value const& jKeys,
+    std::string const& keyFile)
+{
+    OperationTimer const timer(Operation::loadKeys);
+
     static std::array<std::string, 4> const requiredFields{
         {"key_type", "secret_key", "token_sequence", "revoked"}};
 
@@ -70,7 +102,7 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
         if (!jKeys.isMember(field))
         {
             throw std::runtime_error(
-                "Key file '" + keyFile.string() + "' is missing \"" + field +
+                "Key file '" + keyFile + "' is missing \"" + field +
                 "\" field");
         }
     }
@@ -79,7 +111,7 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
     if (!keyType)
     {
         throw std::runtime_error(
-            "Key file '" + keyFile.string() +
+            "Key file '" + keyFile +
             "' contains invalid \"key_type\" field: " +
             jKeys["key_type"].toStyledString());
     }
@@ -90,7 +122,7 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
     if (!secret)
     {
         throw std::runtime_error(
-            "Key file '" + keyFile.string() +
+            "Key file '" + keyFile +
             "' contains invalid \"secret_key\" field: " +
             jKeys["secret_key"].toStyledString());
     }
@@ -106,14 +138,14 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
     catch (std::runtime_error&)
     {
         throw std::runtime_error(
-            "Key file '" + keyFile.string() +
+            "Key file '" + keyFile +
             "' contains invalid \"token_sequence\" field: " +
             jKeys["token_sequence"].toStyledString());
     }
 
     if (!jKeys["revoked"].isBool())
         throw std::runtime_error(
-            "Key file '" + keyFile.string() +
+            "Key file '" + keyFile +
             "' contains invalid \"revoked\" field: " +
             jKeys["revoked"].toStyledString());
 
@@ -124,7 +156,7 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
     {
         if (!jKeys["domain"].isString())
             throw std::runtime_error(
-                "Key file '" + keyFile.string() +
+                "Key file '" + keyFile +
                 "' contains invalid \"domain\" field: " +
                 jKeys["domain"].toStyledString());
 
@@ -135,7 +167,7 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
     {
         if (!jKeys["manifest"].isString())
             throw std::runtime_error(
-                "Key file '" + keyFile.string() +
+                "Key file '" + keyFile +
                 "' contains invalid \"manifest\" field: " +
                 jKeys["manifest"].toStyledString());
 
@@ -143,23 +175,19 @@ ValidatorKeys::make_ValidatorKeys(boost::filesystem::path const& keyFile)
 
         if (!ret || ret->size() == 0)
             throw std::runtime_error(
-                "Key file '" + keyFile.string() +
+                "Key file '" + keyFile +
                 "' contains invalid \"manifest\" field: " +
                 jKeys["manifest"].toStyledString());
 
-        vk.manifest_.clear();
-        vk.manifest_.reserve(ret->size());
-        std::copy(ret->begin(), ret->end(), std::back_inserter(vk.manifest_));
+        vk.manifest_ = std::move(*ret);
     }
 
     return vk;
 }
 
-void
-ValidatorKeys::writeToFile(boost::filesystem::path const& keyFile) const
+Json::Value
+ValidatorKeys::toJson() const
 {
-    using namespace boost::filesystem;
-
     Json::Value jv;
     jv["key_type"] = to_string(keyType_);
     jv["public_key"] = toBase58(TokenType::NodePublic, keys_.publicKey);
@@ -170,6 +198,17 @@ ValidatorKeys::writeToFile(boost::filesystem::path const& keyFile) const
         jv["domain"] = domain_;
     if (!manifest_.empty())
         jv["manifest"] = strHex(makeSlice(manifest_));
+    return jv;
+}
+
+void
+ValidatorKeys::writeToFile(boost::filesystem::path const& keyFile) const
+{
+    using namespace boost::filesystem;
+
+    OperationTimer const timer(Operation::writeKeys);
+
+    auto const jv = toJson();
 
     if (!keyFile.parent_path().empty())
     {
@@ -182,23 +221,30 @@ ValidatorKeys::writeToFile(boost::filesystem::path const& keyFile) const
                 "Cannot create directory: " + keyFile.parent_path().string());
     }
 
-    std::ofstream o(keyFile.string(), std::ios_base::trunc);
-    if (o.fail())
+    // Replaced atomically, so readers that take no lock never see a
+    // half-written key file
+    try
+    {
+        writeFileAtomic(keyFile, jv.toStyledString(), true);
+    }
+    catch (std::exception const&)
+    {
         throw std::runtime_error("Cannot open key file: " + keyFile.string());
-
-    o << jv.toStyledString();
+    }
 }
 
 boost::optional<ValidatorToken>
 ValidatorKeys::createValidatorToken(KeyType const& keyType)
 {
+    OperationTimer const timer(Operation::createToken);
+
     if (revoked() ||
         std::numeric_limits<std::uint32_t>::max() - 1 <= tokenSequence_)
         return boost::none;
 
     ++tokenSequence_;
 
-    auto const tokenSecret = generateSecretKey(keyType, randomSeed());
+    auto const tokenSecret = generateSecretKey(keyType, generateSeed());
     auto const tokenPublic = derivePublicKey(keyType, tokenSecret);
 
     STObject st(sfGeneric);
@@ -216,9 +262,7 @@ ValidatorKeys::createValidatorToken(KeyType const& keyType)
     Serializer s;
     st.add(s);
 
-    manifest_.clear();
-    manifest_.reserve(s.size());
-    std::copy(s.begin(), s.end(), std::back_inserter(manifest_));
+    manifest_.assign(s.begin(), s.end());
 
     return ValidatorToken{
         xrpl::base64_encode(manifest_.data(), manifest_.size()), tokenSecret};
@@ -227,6 +271,8 @@ ValidatorKeys::createValidatorToken(KeyType const& keyType)
 std::string
 ValidatorKeys::revoke()
 {
+    OperationTimer const timer(Operation::revoke);
+
     revoked_ = true;
 
     STObject st(sfGeneric);
@@ -239,9 +285,7 @@ ValidatorKeys::revoke()
     Serializer s;
     st.add(s);
 
-    manifest_.clear();
-    manifest_.reserve(s.size());
-    std::copy(s.begin(), s.end(), std::back_inserter(manifest_));
+    manifest_.assign(s.begin(), s.end());
 
     return xrpl::base64_encode(manifest_.data(), manifest_.size());
 }
@@ -249,10 +293,36 @@ ValidatorKeys::revoke()
 std::string
 ValidatorKeys::sign(std::string const& data) const
 {
+    OperationTimer const timer(Operation::sign);
+
     return strHex(
         xrpl::sign(keys_.publicKey, keys_.secretKey, makeSlice(data)));
 }
 
+std::string
+ValidatorKeys::sign(SigningPayload const& payload) const
+{
+    if (keyType_ != KeyType::secp256k1)
+        return sign(payload.data);
+
+    return signDigest(payload.digest);
+}
+
+std::string
+ValidatorKeys::signDigest(uint256 const& digest) const
+{
+    OperationTimer const timer(Operation::sign);
+
+    if (keyType_ == KeyType::secp256k1)
+        return strHex(
+            xrpl::signDigest(keys_.publicKey, keys_.secretKey, digest));
+
+    return strHex(xrpl::sign(
+        keys_.publicKey,
+        keys_.secretKey,
+        Slice(digest.data(), digest.size())));
+}
+
 void
 ValidatorKeys::domain(std::string d)
 {
@@ -1,3 +1,8 @@
+#ifndef VALIDATOR_KEYS_VALIDATORKEYS_H_INCLUDED
+#define VALIDATOR_KEYS_VALIDATORKEYS_H_INCLUDED
+
+#include <xrpl/basics/base_uint.h>
+#include <xrpl/json/json_value.h>
 #include <xrpl/protocol/KeyType.h>
 #include <xrpl/protocol/SecretKey.h>
 
@@ -25,6 +30,26 @@ struct ValidatorToken
     toString() const;
 };
 
+/** Data to sign with many keys
+
+    secp256k1 keys sign the SHA-512Half of the data, which is computed once
+    here rather than once per key. Ed25519 keys sign the data itself.
+*/
+struct SigningPayload
+{
+    std::string const data;
+    uint256 const digest;
+
+    explicit SigningPayload(std::string d);
+};
+
+/** Verifies a signature made by ValidatorKeys::signDigest */
+bool
+verifySignedDigest(
+    PublicKey const& publicKey,
+    uint256 const& digest,
+    Slice const& signature);
+
 class ValidatorKeys
 {
 private:
@@ -67,6 +92,16 @@ public:
     static ValidatorKeys
     make_ValidatorKeys(boost::filesystem::path const& keyFile);
 
+    /** Returns ValidatorKeys constructed from the JSON of a key file
+
+        @param jKeys Key file contents, as written by toJson
+        @param keyFile Name of the key file, for error messages
+
+        @throws std::runtime_error if the content is invalid
+    */
+    static ValidatorKeys
+    make_ValidatorKeys(Json::Value const& jKeys, std::string const& keyFile);
+
     ~ValidatorKeys() = default;
     ValidatorKeys(ValidatorKeys const&) = default;
     ValidatorKeys&
@@ -81,11 +116,16 @@ public:
             keys_.secretKey == rhs.keys_.secretKey;
     }
 
+    /** Returns the key file contents */
+    Json::Value
+    toJson() const;
+
     /** Write keys to JSON file
 
         @param keyFile Path to file to write
 
-        @note Overwrites existing key file
+        @note Replaces an existing key file atomically; the file is only
+              readable and writable by its owner
 
         @throws std::runtime_error if unable to create parent directory
     */
@@ -95,6 +135,10 @@ public:
     /** Returns validator token for current sequence
 
         @param keyType Key type for the token keys
+
+        @note secp256k1 token keys are generated and used through libxrpl's
+              process-wide secp256k1 context, so its precomputed tables are
+              shared by every token made in the process.
     */
     boost::optional<ValidatorToken>
     createValidatorToken(KeyType const& keyType = KeyType::secp256k1);
@@ -115,6 +159,32 @@ public:
     std::string
     sign(std::string const& data) const;
 
+    /** Signs a payload with validator key
+
+        Produces the same signature as sign(payload.data).
+
+        @return hex-encoded signature
+    */
+    std::string
+    sign(SigningPayload const& payload) const;
+
+    /** Signs a 256-bit digest with validator key
+
+        secp256k1 keys sign the digest directly; ed25519 keys sign its 32
+        bytes as the message.
+
+        @return hex-encoded signature
+    */
+    std::string
+    signDigest(uint256 const& digest) const;
+
+    /** Returns the key type. */
+    KeyType
+    keyType() const
+    {
+        return keyType_;
+    }
+
     /** Returns the public key. */
     PublicKey const&
     publicKey() const
@@ -130,18 +200,21 @@ public:
     }
 
     /** Returns the domain associated with this key, if any */
-    std::string
+    std::string const&
     domain() const
     {
         return domain_;
     }
 
-    /** Sets the domain associated with this key */
+    /** Sets the domain associated with this key
+
+        Pass an rvalue to hand over the string without copying it.
+    */
     void
     domain(std::string d);
 
     /** Returns the last manifest we generated for this domain, if available. */
-    std::vector<std::uint8_t>
+    std::vector<std::uint8_t> const&
     manifest() const
     {
         return manifest_;
@@ -156,3 +229,5 @@ public:
 };
 
 }  // namespace xrpl
+
+#endif
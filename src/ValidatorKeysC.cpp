@@ -0,0 +1,342 @@
+#include <AtomicFile.h>
+#include <KeyFileLock.h>
+#include <Metrics.h>
+#include <ValidatorKeys.h>
+#include <ValidatorKeysC.h>
+#include <ValidatorKeysTool.h>
+
+#include <xrpl/json/json_reader.h>
+#include <xrpl/protocol/tokens.h>
+
+#include <boost/optional.hpp>
+
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+struct vk_keys
+{
+    xrpl::ValidatorKeys keys;
+
+    // A token that did not fit the caller's buffer, with the keys that
+    // issued it, kept so a retry gets the same token and length
+    struct PendingToken
+    {
+        xrpl::ValidatorKeys keys;
+        std::string token;
+    };
+    boost::optional<PendingToken> pending;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+// Copies s and a terminator to the caller's buffer if both fit
+vk_status
+copyOut(std::string_view s, char* buffer, size_t size, size_t* length)
+{
+    if (length == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    *length = s.size();
+    if (buffer == nullptr || size <= s.size())
+        return VK_BUFFER_TOO_SMALL;
+
+    std::memcpy(buffer, s.data(), s.size());
+    buffer[s.size()] = '\0';
+    return VK_OK;
+}
+
+// Runs f, turning any exception into VK_ERROR and the thread's last error
+template <class F>
+vk_status
+guarded(F&& f) noexcept
+{
+    try
+    {
+        return f();
+    }
+    catch (std::exception const& e)
+    {
+        lastError = e.what();
+    }
+    catch (...)
+    {
+        lastError = "Unknown error";
+    }
+    return VK_ERROR;
+}
+
+vk_status
+make(xrpl::ValidatorKeys keys, vk_keys** out)
+{
+    *out = new vk_keys{std::move(keys), boost::none};
+    return VK_OK;
+}
+
+}  // namespace
+
+char const*
+vk_version(void)
+{
+    return getVersionString().c_str();
+}
+
+char const*
+vk_last_error(void)
+{
+    return lastError.c_str();
+}
+
+vk_status
+vk_keys_create(vk_key_type type, vk_keys** keys)
+{
+    if (keys == nullptr ||
+        (type != VK_KEY_TYPE_SECP256K1 && type != VK_KEY_TYPE_ED25519))
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        return make(
+            xrpl::ValidatorKeys(
+                type == VK_KEY_TYPE_ED25519 ? xrpl::KeyType::ed25519
+                                            : xrpl::KeyType::secp256k1),
+            keys);
+    });
+}
+
+vk_status
+vk_keys_load(char const* path, vk_keys** keys)
+{
+    if (path == nullptr || keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        xrpl::KeyFileLock const lock(path, xrpl::KeyFileLock::shared);
+        return make(xrpl::ValidatorKeys::make_ValidatorKeys(path), keys);
+    });
+}
+
+vk_status
+vk_keys_parse(char const* json, size_t size, vk_keys** keys)
+{
+    if (json == nullptr || keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        Json::Value jKeys;
+        if (!Json::Reader().parse(json, json + size, jKeys))
+            throw std::runtime_error("Unable to parse json key file");
+
+        return make(
+            xrpl::ValidatorKeys::make_ValidatorKeys(jKeys, "<memory>"), keys);
+    });
+}
+
+void
+vk_keys_free(vk_keys* keys)
+{
+    delete keys;
+}
+
+vk_status
+vk_keys_save(vk_keys const* keys, char const* path)
+{
+    if (keys == nullptr || path == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        xrpl::KeyFileLock const lock(path, xrpl::KeyFileLock::exclusive);
+        xrpl::OperationTimer const timer(xrpl::Operation::writeKeys);
+        xrpl::writeFileAtomic(
+            path, keys->keys.toJson().toStyledString(), true);
+        return VK_OK;
+    });
+}
+
+vk_status
+vk_keys_serialize(
+    vk_keys const* keys,
+    char* buffer,
+    size_t size,
+    size_t* length)
+{
+    if (keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        return copyOut(
+            keys->keys.toJson().toStyledString(), buffer, size, length);
+    });
+}
+
+vk_status
+vk_keys_public_key(
+    vk_keys const* keys,
+    char* buffer,
+    size_t size,
+    size_t* length)
+{
+    if (keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        return copyOut(
+            xrpl::toBase58(
+                xrpl::TokenType::NodePublic, keys->keys.publicKey()),
+            buffer,
+            size,
+            length);
+    });
+}
+
+uint32_t
+vk_keys_sequence(vk_keys const* keys)
+{
+    return keys == nullptr ? 0 : keys->keys.sequence();
+}
+
+int
+vk_keys_revoked(vk_keys const* keys)
+{
+    return keys != nullptr && keys->keys.revoked() ? 1 : 0;
+}
+
+vk_status
+vk_keys_set_domain(vk_keys* keys, char const* domain, size_t size)
+{
+    if (keys == nullptr || (domain == nullptr && size != 0))
+        return VK_INVALID_ARGUMENT;
+
+    if (keys->keys.revoked())
+        return VK_REVOKED;
+
+    return guarded([&] {
+        keys->keys.domain(
+            size == 0 ? std::string{} : std::string(domain, size));
+        keys->pending.reset();
+        return VK_OK;
+    });
+}
+
+vk_status
+vk_keys_create_token(
+    vk_keys* keys,
+    char* buffer,
+    size_t size,
+    size_t* length)
+{
+    if (keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    if (keys->keys.revoked())
+        return VK_REVOKED;
+
+    return guarded([&] {
+        // Work on a copy, so a short buffer does not use up a sequence.
+        // The token is new each time and its length varies with the
+        // secp256k1 signatures in it, so it is kept for the retry.
+        if (!keys->pending)
+        {
+            auto next = keys->keys;
+            auto const token = next.createValidatorToken();
+            if (!token)
+                throw std::runtime_error("Maximum token sequence reached");
+            keys->pending.emplace(
+                vk_keys::PendingToken{std::move(next), token->toString()});
+        }
+
+        auto const status =
+            copyOut(keys->pending->token, buffer, size, length);
+        if (status == VK_OK)
+        {
+            keys->keys = std::move(keys->pending->keys);
+            keys->pending.reset();
+        }
+        return status;
+    });
+}
+
+vk_status
+vk_keys_revoke(vk_keys* keys, char* buffer, size_t size, size_t* length)
+{
+    if (keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        auto next = keys->keys;
+        auto const status = copyOut(next.revoke(), buffer, size, length);
+        if (status == VK_OK)
+        {
+            keys->keys = std::move(next);
+            keys->pending.reset();
+        }
+        return status;
+    });
+}
+
+vk_status
+vk_keys_sign(
+    vk_keys const* keys,
+    void const* data,
+    size_t dataSize,
+    char* buffer,
+    size_t size,
+    size_t* length)
+{
+    if (keys == nullptr || (data == nullptr && dataSize != 0))
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        return copyOut(
+            keys->keys.sign(std::string(
+                static_cast<char const*>(data), dataSize)),
+            buffer,
+            size,
+            length);
+    });
+}
+
+vk_status
+vk_keys_attest(
+    vk_keys const* keys,
+    char* buffer,
+    size_t size,
+    size_t* length)
+{
+    if (keys == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    auto const& k = keys->keys;
+    if (k.revoked())
+        return VK_REVOKED;
+
+    return guarded([&] {
+        if (k.domain().empty())
+            throw std::runtime_error("The keys have no domain");
+
+        return copyOut(makeAttestation(k), buffer, size, length);
+    });
+}
+
+vk_status
+vk_metrics(char* buffer, size_t size, size_t* length)
+{
+    return guarded([&] {
+        return copyOut(xrpl::metrics().prometheus(), buffer, size, length);
+    });
+}
+
+vk_status
+vk_metrics_dump(char const* target)
+{
+    if (target == nullptr)
+        return VK_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        xrpl::dumpMetrics(target);
+        return VK_OK;
+    });
+}
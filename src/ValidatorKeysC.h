@@ -0,0 +1,176 @@
+#ifndef VALIDATOR_KEYS_VALIDATORKEYSC_H_INCLUDED
+#define VALIDATOR_KEYS_VALIDATORKEYSC_H_INCLUDED
+
+/** C interface to validator keys, built as libvalidatorkeys
+
+    Every function reports its outcome as a vk_status. Functions that
+    produce text write it, NUL-terminated, to a buffer the caller provides,
+    and store its length without the terminator in *length. If the buffer
+    is too small they return VK_BUFFER_TOO_SMALL, store the length needed in
+    *length and change nothing, so the call can be repeated with a larger
+    buffer. No memory is handed to the caller except by vk_keys_create,
+    vk_keys_load and vk_keys_parse, which vk_keys_free releases.
+
+    A vk_keys may be used from any thread, but not from two at once. After a
+    call returns VK_ERROR, vk_last_error describes the error on the calling
+    thread.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifdef VK_BUILDING_LIBRARY
+#define VK_API __declspec(dllexport)
+#else
+#define VK_API __declspec(dllimport)
+#endif
+#else
+#define VK_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Incremented whenever a function is added; never when one changes */
+#define VK_API_VERSION 2
+
+typedef struct vk_keys vk_keys;
+
+typedef enum vk_status {
+    VK_OK = 0,
+    // See vk_last_error
+    VK_ERROR = 1,
+    VK_BUFFER_TOO_SMALL = 2,
+    VK_INVALID_ARGUMENT = 3,
+    // The keys were revoked, so the operation is refused
+    VK_REVOKED = 4
+} vk_status;
+
+typedef enum vk_key_type {
+    VK_KEY_TYPE_SECP256K1 = 0,
+    VK_KEY_TYPE_ED25519 = 1
+} vk_key_type;
+
+/** Returns the version of the library, e.g. "0.3.2" */
+VK_API char const*
+vk_version(void);
+
+/** Returns the last error on this thread, or "" */
+VK_API char const*
+vk_last_error(void);
+
+/** Generates new validator keys */
+VK_API vk_status
+vk_keys_create(vk_key_type type, vk_keys** keys);
+
+/** Loads validator keys from a key file
+
+    Takes the key file's shared lock, as the tool's reading commands do,
+    waiting up to 10 seconds for a command that updates the file.
+*/
+VK_API vk_status
+vk_keys_load(char const* path, vk_keys** keys);
+
+/** Loads validator keys from the JSON contents of a key file */
+VK_API vk_status
+vk_keys_parse(char const* json, size_t size, vk_keys** keys);
+
+/** Releases keys; passing NULL does nothing */
+VK_API void
+vk_keys_free(vk_keys* keys);
+
+/** Writes the keys to a key file, replacing it atomically
+
+    Takes the key file's exclusive lock, waiting up to 10 seconds for
+    other users of the file.
+*/
+VK_API vk_status
+vk_keys_save(vk_keys const* keys, char const* path);
+
+/** Produces the JSON contents of the key file */
+VK_API vk_status
+vk_keys_serialize(
+    vk_keys const* keys,
+    char* buffer,
+    size_t size,
+    size_t* length);
+
+/** Produces the base58 public key */
+VK_API vk_status
+vk_keys_public_key(
+    vk_keys const* keys,
+    char* buffer,
+    size_t size,
+    size_t* length);
+
+/** Returns the sequence of the last manifest generated */
+VK_API uint32_t
+vk_keys_sequence(vk_keys const* keys);
+
+/** Returns 1 if the keys are revoked, 0 otherwise */
+VK_API int
+vk_keys_revoked(vk_keys const* keys);
+
+/** Sets the domain, or clears it if size is 0; refused once revoked */
+VK_API vk_status
+vk_keys_set_domain(vk_keys* keys, char const* domain, size_t size);
+
+/** Produces the next validator token, with secp256k1 token keys
+
+    The token sequence is only incremented if the token is produced. Save
+    the keys afterwards, or the sequence will be reused. A token that does
+    not fit the buffer is kept, so a retry with the length reported gets
+    that same token, unless the domain is changed or the keys are revoked
+    in between.
+*/
+VK_API vk_status
+vk_keys_create_token(
+    vk_keys* keys,
+    char* buffer,
+    size_t size,
+    size_t* length);
+
+/** Revokes the keys and produces the base64 revocation */
+VK_API vk_status
+vk_keys_revoke(vk_keys* keys, char* buffer, size_t size, size_t* length);
+
+/** Produces the hex signature of data */
+VK_API vk_status
+vk_keys_sign(
+    vk_keys const* keys,
+    void const* data,
+    size_t dataSize,
+    char* buffer,
+    size_t size,
+    size_t* length);
+
+/** Produces the hex attestation of the domain of the keys
+
+    Fails with VK_ERROR if the keys have no domain.
+*/
+VK_API vk_status
+vk_keys_attest(
+    vk_keys const* keys,
+    char* buffer,
+    size_t size,
+    size_t* length);
+
+/** Produces the latency metrics of this process in Prometheus text format
+
+    Signing, token creation, revocation, and loading and saving keys are
+    timed, whether through this library or not.
+*/
+VK_API vk_status
+vk_metrics(char* buffer, size_t size, size_t* length);
+
+/** Writes the metrics to a file, or to a Unix socket named "unix:<path>" */
+VK_API vk_status
+vk_metrics_dump(char const* target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,15 +1,42 @@
+#include <AtomicFile.h>
+#include <BulkFileIO.h>
+#include <ConfigAudit.h>
+#include <FileSignature.h>
+#include <FleetIndex.h>
+#include <KeyDirectory.h>
+#include <KeyFileLock.h>
+#include <KeyVault.h>
+#include <KeyWatch.h>
+#include <ManifestDecoder.h>
+#include <ManifestHistory.h>
+#include <MerkleBatch.h>
+#include <MappedFile.h>
+#include <Metrics.h>
+#include <OutputWriter.h>
+#include <Parallel.h>
 #include <ValidatorKeys.h>
 #include <ValidatorKeysTool.h>
+#include <ValidatorList.h>
 
 #include <xrpl/basics/StringUtilities.h>
 #include <xrpl/basics/base64.h>
 #include <xrpl/beast/core/SemanticVersion.h>
-#include <xrpl/beast/unit_test.h>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/preprocessor/stringize.hpp>
-#include <boost/program_options.hpp>
+
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
 
 #ifdef BOOST_MSVC
 #include <Windows.h>
@@ -39,38 +66,217 @@ char const* const versionString =
     //--------------------------------------------------------------------------
     ;
 
-static int
-runUnitTests()
+OutputFormat
+outputFormatFromString(std::string const& s)
+{
+    if (s == "text")
+        return OutputFormat::text;
+    if (s == "jsonl")
+        return OutputFormat::jsonl;
+    if (s == "csv")
+        return OutputFormat::csv;
+    throw std::runtime_error("Unknown output format: " + s);
+}
+
+// Write a long base64 string in lines of at most 72 characters
+static void
+writeWrapped(xrpl::OutputWriter& out, std::string const& s)
+{
+    auto const len = 72;
+    for (std::size_t i = 0; i < s.size(); i += len)
+        out << std::string_view(s).substr(i, len) << '\n';
+}
+
+static Json::Value
+makeRecord(std::string const& command, xrpl::ValidatorKeys const& keys)
+{
+    using namespace xrpl;
+
+    Json::Value jv;
+    jv["command"] = command;
+    jv["public_key"] = toBase58(TokenType::NodePublic, keys.publicKey());
+    return jv;
+}
+
+// Append the manifest just generated to the key file's manifest history.
+// The key file has already been updated at this point, so a failure must
+// not keep the new token or revocation from being shown.
+static void
+logManifest(
+    boost::filesystem::path const& keyFile,
+    xrpl::ValidatorKeys const& keys,
+    std::uint32_t sequence)
 {
-    using namespace beast::unit_test;
-    reporter r;
-    bool const anyFailed = r.run_each(global_suites());
-    if (anyFailed)
-        return EXIT_FAILURE;  // LCOV_EXCL_LINE
-    return EXIT_SUCCESS;
+    using namespace xrpl;
+
+    try
+    {
+        ManifestHistory(keyFile).append(
+            keys.publicKey(), sequence, makeSlice(keys.manifest()));
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "WARNING: Manifest history not updated: " << e.what()
+                  << "\n";
+    }
+}
+
+std::string
+makeAttestation(xrpl::ValidatorKeys const& keys)
+{
+    using namespace xrpl;
+
+    return keys.sign(
+        "[domain-attestation-blob:" + keys.domain() + ":" +
+        toBase58(TokenType::NodePublic, keys.publicKey()) + "]");
+}
+
+// Loads a key file under a shared lock, released once it is read
+static xrpl::ValidatorKeys
+loadKeyFile(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    KeyFileLock const lock(keyFile, KeyFileLock::shared, options.lockTimeout);
+    return ValidatorKeys::make_ValidatorKeys(keyFile);
 }
 
 void
-createKeyFile(boost::filesystem::path const& keyFile)
+createKeyFile(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
 {
     using namespace xrpl;
 
+    KeyFileLock const lock(
+        keyFile, KeyFileLock::exclusive, options.lockTimeout);
     if (exists(keyFile))
         throw std::runtime_error(
             "Refusing to overwrite existing key file: " + keyFile.string());
 
-    ValidatorKeys const keys(KeyType::ed25519);
+    auto const keyType = KeyType::ed25519;
+    ValidatorKeys const keys(keyType);
     keys.writeToFile(keyFile);
 
-    std::cout << "Validator keys stored in " << keyFile.string()
-              << "\n\nThis file should be stored securely and not shared.\n\n";
+    OutputWriter out(std::cout);
+
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("create_keys", keys);
+        jv["key_type"] = to_string(keyType);
+        jv["key_file"] = keyFile.string();
+        out.record(jv);
+        return;
+    }
+
+    out << "Validator keys stored in " << keyFile.string()
+        << "\n\nThis file should be stored securely and not shared.\n\n";
 }
 
 void
-createToken(boost::filesystem::path const& keyFile)
+createKeyFiles(
+    boost::filesystem::path const& keyFileDir,
+    std::size_t count,
+    CommandOptions const& options)
 {
     using namespace xrpl;
 
+    if (count == 0)
+        throw std::runtime_error("Syntax error: --count must be at least 1");
+
+    auto const width = std::to_string(count).size();
+    std::vector<boost::filesystem::path> keyFiles(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto n = std::to_string(i + 1);
+        n.insert(0, width - n.size(), '0');
+        keyFiles[i] = keyFileDir / ("validator-keys-" + n + ".json");
+
+        // Fails early; the files are also put in place without replacing
+        // any that appear after this check
+        if (exists(keyFiles[i]))
+            throw std::runtime_error(
+                "Refusing to overwrite existing key file: " +
+                keyFiles[i].string());
+    }
+
+    create_directories(keyFileDir);
+
+    // Key generation dominates, so the key pairs are made on all cores,
+    // each batch while the previous one is written
+    auto const keyType = KeyType::ed25519;
+    std::vector<boost::optional<ValidatorKeys>> keys(count);
+    BulkFileIO io;
+    bool writing = false;
+    std::size_t writingFirst = 0;
+    auto const written = [&] {
+        auto const results = io.wait();
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            if (results[i].existed)
+                throw std::runtime_error(
+                    "Refusing to overwrite existing key file: " +
+                    keyFiles[writingFirst + i].string());
+            if (!results[i].error.empty())
+                throw std::runtime_error(results[i].error);
+        }
+    };
+
+    for (std::size_t first = 0; first < count; first += io.depth())
+    {
+        auto const n = std::min<std::size_t>(io.depth(), count - first);
+        std::vector<std::pair<boost::filesystem::path, std::string>> batch(n);
+        parallelFor(
+            n,
+            [&](std::size_t i) {
+                auto& k = keys[first + i];
+                k.emplace(keyType);
+                batch[i] = {
+                    keyFiles[first + i], k->toJson().toStyledString()};
+            },
+            options.threads);
+
+        if (std::exchange(writing, true))
+            written();
+        writingFirst = first;
+        io.write(std::move(batch), false);
+    }
+    if (writing)
+        written();
+
+    OutputWriter out(std::cout);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (options.format == OutputFormat::jsonl)
+        {
+            auto jv = makeRecord("create_keys", *keys[i]);
+            jv["key_type"] = to_string(keyType);
+            jv["key_file"] = keyFiles[i].string();
+            out.record(jv);
+            continue;
+        }
+
+        out << toBase58(TokenType::NodePublic, keys[i]->publicKey()) << ' '
+            << keyFiles[i].string() << '\n';
+    }
+
+    if (options.format == OutputFormat::text)
+        out << "\n" << count << " validator key files stored in "
+            << keyFileDir.string()
+            << "\n\nThese files should be stored securely and not shared.\n\n";
+}
+
+void
+createToken(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    KeyFileLock const lock(
+        keyFile, KeyFileLock::exclusive, options.lockTimeout);
     auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
 
     if (keys.revoked())
@@ -85,109 +291,154 @@ createToken(boost::filesystem::path const& keyFile)
 
     // Update key file with new token sequence
     keys.writeToFile(keyFile);
+    logManifest(keyFile, keys, keys.sequence());
 
-    std::cout
-        << "Update rippled.cfg file with these values and restart xrpld:\n\n";
-    std::cout << "# validator public key: "
-              << toBase58(TokenType::NodePublic, keys.publicKey()) << "\n\n";
-    std::cout << "[validator_token]\n";
-
+    OutputWriter out(std::cout);
     auto const tokenStr = token->toString();
-    auto const len = 72;
-    for (auto i = 0; i < tokenStr.size(); i += len)
-        std::cout << tokenStr.substr(i, len) << std::endl;
 
-    std::cout << std::endl;
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("create_token", keys);
+        jv["sequence"] = Json::UInt(keys.sequence());
+        jv["token"] = tokenStr;
+        jv["manifest"] = token->manifest;
+        out.record(jv);
+        return;
+    }
+
+    out << "Update rippled.cfg file with these values and restart xrpld:\n\n";
+    out << "# validator public key: "
+        << toBase58(TokenType::NodePublic, keys.publicKey()) << "\n\n";
+    out << "[validator_token]\n";
+    writeWrapped(out, tokenStr);
+    out << '\n';
 }
 
 void
-createRevocation(boost::filesystem::path const& keyFile)
+createRevocation(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
 {
     using namespace xrpl;
 
+    KeyFileLock const lock(
+        keyFile, KeyFileLock::exclusive, options.lockTimeout);
     auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
 
-    if (keys.revoked())
-        std::cout << "WARNING: Validator keys have already been revoked!\n\n";
-    else
-        std::cout << "WARNING: This will revoke your validator keys!\n\n";
-
+    bool const alreadyRevoked = keys.revoked();
     auto const revocation = keys.revoke();
 
     // Update key file with new token sequence
     keys.writeToFile(keyFile);
+    logManifest(keyFile, keys, std::numeric_limits<std::uint32_t>::max());
 
-    std::cout
-        << "Update rippled.cfg file with these values and restart xrpld:\n\n";
-    std::cout << "# validator public key: "
-              << toBase58(TokenType::NodePublic, keys.publicKey()) << "\n\n";
-    std::cout << "[validator_key_revocation]\n";
+    OutputWriter out(std::cout);
 
-    auto const len = 72;
-    for (auto i = 0; i < revocation.size(); i += len)
-        std::cout << revocation.substr(i, len) << std::endl;
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("revoke_keys", keys);
+        jv["sequence"] = Json::UInt(std::numeric_limits<std::uint32_t>::max());
+        jv["manifest"] = revocation;
+        jv["previously_revoked"] = alreadyRevoked;
+        out.record(jv);
+        return;
+    }
 
-    std::cout << std::endl;
+    if (alreadyRevoked)
+        out << "WARNING: Validator keys have already been revoked!\n\n";
+    else
+        out << "WARNING: This will revoke your validator keys!\n\n";
+
+    out << "Update rippled.cfg file with these values and restart xrpld:\n\n";
+    out << "# validator public key: "
+        << toBase58(TokenType::NodePublic, keys.publicKey()) << "\n\n";
+    out << "[validator_key_revocation]\n";
+    writeWrapped(out, revocation);
+    out << '\n';
 }
 
 void
-attestDomain(xrpl::ValidatorKeys const& keys)
+attestDomain(xrpl::ValidatorKeys const& keys, xrpl::OutputWriter& out)
 {
     using namespace xrpl;
 
     if (keys.domain().empty())
     {
-        std::cout << "No attestation is necessary if no domain is specified!\n";
-        std::cout << "If you have an attestation in your xrpl-ledger.toml\n";
-        std::cout << "you should remove it at this time.\n";
+        out << "No attestation is necessary if no domain is specified!\n";
+        out << "If you have an attestation in your xrpl-ledger.toml\n";
+        out << "you should remove it at this time.\n";
         return;
     }
 
-    std::cout << "The domain attestation for validator "
-              << toBase58(TokenType::NodePublic, keys.publicKey())
-              << " is:\n\n";
+    out << "The domain attestation for validator "
+        << toBase58(TokenType::NodePublic, keys.publicKey()) << " is:\n\n";
 
-    std::cout << "attestation=\""
-              << keys.sign(
-                     "[domain-attestation-blob:" + keys.domain() + ":" +
-                     toBase58(TokenType::NodePublic, keys.publicKey()) + "]")
-              << "\"\n\n";
+    out << "attestation=\"" << makeAttestation(keys) << "\"\n\n";
 
-    std::cout << "You should include it in your xrp-ledger.toml file in the\n";
-    std::cout << "section for this validator.\n";
+    out << "You should include it in your xrp-ledger.toml file in the\n";
+    out << "section for this validator.\n";
 }
 
 void
-attestDomain(boost::filesystem::path const& keyFile)
+attestDomain(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {})
 {
     using namespace xrpl;
 
-    auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
+    auto keys = loadKeyFile(keyFile, options);
 
     if (keys.revoked())
         throw std::runtime_error(
             "Operation error: The specified master key has been revoked!");
 
-    attestDomain(keys);
+    OutputWriter out(std::cout);
+
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("attest_domain", keys);
+        jv["domain"] = keys.domain();
+        if (!keys.domain().empty())
+            jv["attestation"] = makeAttestation(keys);
+        out.record(jv);
+        return;
+    }
+
+    attestDomain(keys, out);
 }
 
 void
-setDomain(std::string const& domain, boost::filesystem::path const& keyFile)
+setDomain(
+    std::string const& domain,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {})
 {
     using namespace xrpl;
 
+    KeyFileLock const lock(
+        keyFile, KeyFileLock::exclusive, options.lockTimeout);
     auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
 
     if (keys.revoked())
         throw std::runtime_error(
             "Operation error: The specified master key has been revoked!");
 
+    OutputWriter out(std::cout);
+    auto const command = domain.empty() ? "clear_domain" : "set_domain";
+
     if (domain == keys.domain())
     {
-        if (domain.empty())
-            std::cout << "The domain name was already cleared!\n";
+        if (options.format == OutputFormat::jsonl)
+        {
+            auto jv = makeRecord(command, keys);
+            jv["domain"] = domain;
+            jv["changed"] = false;
+            out.record(jv);
+        }
+        else if (domain.empty())
+            out << "The domain name was already cleared!\n";
         else
-            std::cout << "The domain name was already set.\n";
+            out << "The domain name was already set.\n";
         return;
     }
 
@@ -201,30 +452,161 @@ setDomain(std::string const& domain, boost::filesystem::path const& keyFile)
 
     // Flush to disk
     keys.writeToFile(keyFile);
+    logManifest(keyFile, keys, keys.sequence());
+
+    auto const tokenStr = token->toString();
+
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord(command, keys);
+        jv["domain"] = domain;
+        jv["changed"] = true;
+        jv["sequence"] = Json::UInt(keys.sequence());
+        jv["token"] = tokenStr;
+        jv["manifest"] = token->manifest;
+        if (!domain.empty())
+            jv["attestation"] = makeAttestation(keys);
+        out.record(jv);
+        return;
+    }
 
     if (domain.empty())
-        std::cout << "The domain name has been cleared.\n";
+        out << "The domain name has been cleared.\n";
     else
-        std::cout << "The domain name has been set to: " << domain << "\n\n";
-    attestDomain(keys);
+        out << "The domain name has been set to: " << domain << "\n\n";
+    attestDomain(keys, out);
+
+    out << "\n";
+    out << "You also need to update the rippled.cfg file to add a new\n";
+    out << "validator token and restart xrpld:\n\n";
+    out << "# validator public key: "
+        << toBase58(TokenType::NodePublic, keys.publicKey()) << "\n\n";
+    out << "[validator_token]\n";
+    writeWrapped(out, tokenStr);
+    out << "\n";
+}
 
-    std::cout << "\n";
-    std::cout << "You also need to update the rippled.cfg file to add a new\n";
-    std::cout << "validator token and restart xrpld:\n\n";
-    std::cout << "# validator public key: "
-              << toBase58(TokenType::NodePublic, keys.publicKey()) << "\n\n";
-    std::cout << "[validator_token]\n";
+void
+signData(
+    std::string const& data,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
 
-    auto const tokenStr = token->toString();
-    auto const len = 72;
-    for (auto i = 0; i < tokenStr.size(); i += len)
-        std::cout << tokenStr.substr(i, len) << std::endl;
+    if (data.empty())
+        throw std::runtime_error(
+            "Syntax error: Must specify data string to sign");
+
+    auto keys = loadKeyFile(keyFile, options);
+
+    OutputWriter out(std::cout);
+
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("sign", keys);
+        jv["revoked"] = keys.revoked();
+        jv["signature"] = keys.sign(data);
+        out.record(jv);
+        return;
+    }
+
+    if (keys.revoked())
+        out << "WARNING: Validator keys have been revoked!\n\n";
 
-    std::cout << "\n";
+    out << keys.sign(data) << "\n\n";
 }
 
 void
-signData(std::string const& data, boost::filesystem::path const& keyFile)
+signFile(
+    boost::filesystem::path const& file,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    auto const keys = loadKeyFile(keyFile, options);
+    auto const digest = fileDigest(file);
+    auto const signature = keys.signDigest(digest);
+
+    OutputWriter out(std::cout);
+
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("sign", keys);
+        jv["file"] = file.string();
+        jv["digest"] = to_string(digest);
+        jv["revoked"] = keys.revoked();
+        jv["signature"] = signature;
+        out.record(jv);
+        return;
+    }
+
+    if (keys.revoked())
+        out << "WARNING: Validator keys have been revoked!\n\n";
+
+    out << signature << "\n\n";
+}
+
+// Signs data with every loaded key; the source field names where each
+// key came from in JSON Lines output
+static int
+signDataWithKeys(
+    std::string const& data,
+    std::vector<xrpl::KeyFileEntry> const& entries,
+    char const* sourceField,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    SigningPayload const payload(data);
+    std::vector<std::string> signatures(entries.size());
+    parallelFor(
+        entries.size(),
+        [&](std::size_t i) {
+            if (entries[i].keys)
+                signatures[i] = entries[i].keys->sign(payload);
+        },
+        options.threads);
+
+    OutputWriter out(std::cout);
+    bool failed = false;
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        auto const& entry = entries[i];
+        if (!entry.keys)
+        {
+            std::cerr << "Failed to load " << entry.path.string() << ": "
+                      << entry.error << "\n";
+            failed = true;
+            continue;
+        }
+
+        if (options.format == OutputFormat::jsonl)
+        {
+            auto jv = makeRecord("sign", *entry.keys);
+            jv[sourceField] = entry.path.string();
+            jv["revoked"] = entry.keys->revoked();
+            jv["signature"] = signatures[i];
+            out.record(jv);
+            continue;
+        }
+
+        if (entry.keys->revoked())
+            std::cerr << "WARNING: Validator keys in " << entry.path.string()
+                      << " have been revoked!\n";
+        out << toBase58(TokenType::NodePublic, entry.keys->publicKey()) << ' '
+            << signatures[i] << '\n';
+    }
+
+    return failed ? EXIT_FAILURE : 0;
+}
+
+int
+signDataWithKeyDirectory(
+    std::string const& data,
+    boost::filesystem::path const& keyFileDir,
+    CommandOptions const& options)
 {
     using namespace xrpl;
 
@@ -232,238 +614,1290 @@ signData(std::string const& data, boost::filesystem::path const& keyFile)
         throw std::runtime_error(
             "Syntax error: Must specify data string to sign");
 
-    auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
+    auto const entries = loadKeyDirectory(keyFileDir, options.threads);
+    if (entries.empty())
+        throw std::runtime_error(
+            "No key files found in " + keyFileDir.string());
 
-    if (keys.revoked())
-        std::cout << "WARNING: Validator keys have been revoked!\n\n";
+    return signDataWithKeys(data, entries, "key_file", options);
+}
 
-    std::cout << keys.sign(data) << std::endl;
-    std::cout << std::endl;
+static std::string const&
+vaultPassword(CommandOptions const& options)
+{
+    if (!options.vaultPassword)
+        throw std::runtime_error("Syntax error: Missing vault password");
+    return *options.vaultPassword;
+}
+
+int
+signDataWithKeyVault(
+    std::string const& data,
+    boost::filesystem::path const& vault,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    if (data.empty())
+        throw std::runtime_error(
+            "Syntax error: Must specify data string to sign");
+
+    auto const v = KeyVault::open(vault, vaultPassword(options));
+    auto const entries = loadKeyVault(v, options.threads);
+    if (entries.empty())
+        throw std::runtime_error("No keys found in vault " + vault.string());
+
+    return signDataWithKeys(data, entries, "vault_entry", options);
+}
+
+void
+importKeyFiles(
+    std::vector<std::string> const& keyFiles,
+    boost::filesystem::path const& vault,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    // Load every key file first so a bad one leaves the vault untouched.
+    // Entries are named by file stem, so two files of the same stem would
+    // otherwise leave only the last one's key in the vault.
+    std::vector<std::pair<std::string, ValidatorKeys>> keys;
+    std::map<std::string, std::string> named;
+    for (auto const& keyFile : keyFiles)
+    {
+        boost::filesystem::path const p = keyFile;
+        auto const [it, added] = named.emplace(p.stem().string(), keyFile);
+        if (!added)
+            throw std::runtime_error(
+                "Key files " + it->second + " and " + keyFile +
+                " would both be vault entry " + it->first);
+        keys.emplace_back(
+            p.stem().string(), ValidatorKeys::make_ValidatorKeys(p));
+    }
+
+    auto v = exists(vault) ? KeyVault::open(vault, vaultPassword(options))
+                           : KeyVault::create(vault, vaultPassword(options));
+    for (auto const& [name, k] : keys)
+        v.put(name, k);
+    v.save();
+
+    OutputWriter out(std::cout);
+    for (auto const& [name, k] : keys)
+    {
+        if (options.format == OutputFormat::jsonl)
+        {
+            auto jv = makeRecord("vault_import", k);
+            jv["vault_entry"] = name;
+            out.record(jv);
+            continue;
+        }
+
+        out << toBase58(TokenType::NodePublic, k.publicKey()) << ' ' << name
+            << '\n';
+    }
+}
+
+int
+listKeyVault(
+    boost::filesystem::path const& vault,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    auto const v = KeyVault::open(vault, vaultPassword(options));
+    auto const entries = loadKeyVault(v, options.threads);
+
+    OutputWriter out(std::cout);
+    bool failed = false;
+    for (auto const& entry : entries)
+    {
+        if (!entry.keys)
+        {
+            std::cerr << "Failed to load " << entry.path.string() << ": "
+                      << entry.error << "\n";
+            failed = true;
+            continue;
+        }
+
+        if (options.format == OutputFormat::jsonl)
+        {
+            auto jv = makeRecord("vault_list", *entry.keys);
+            jv["vault_entry"] = entry.path.string();
+            jv["revoked"] = entry.keys->revoked();
+            out.record(jv);
+            continue;
+        }
+
+        out << toBase58(TokenType::NodePublic, entry.keys->publicKey()) << ' '
+            << entry.path.string() << (entry.keys->revoked() ? " revoked" : "")
+            << '\n';
+    }
+
+    return failed ? EXIT_FAILURE : 0;
+}
+
+static Json::Value
+makeRecord(std::string const& command, xrpl::FleetEntry const& e)
+{
+    using namespace xrpl;
+
+    Json::Value jv;
+    jv["command"] = command;
+    jv["public_key"] = e.publicKey;
+    jv["key_file"] = e.keyFile.string();
+    jv["key_type"] = to_string(e.keyType);
+    jv["sequence"] = Json::UInt(e.sequence);
+    jv["revoked"] = e.revoked;
+    jv["domain"] = e.domain;
+    return jv;
+}
+
+int
+fleetStatus(
+    boost::filesystem::path const& keyFileDir,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    auto const index = loadFleetIndex(keyFileDir, options.threads);
+
+    OutputWriter out(std::cout);
+    std::size_t revoked = 0;
+    for (auto const& e : index.entries)
+    {
+        revoked += e.revoked;
+
+        if (options.format == OutputFormat::jsonl)
+        {
+            out.record(makeRecord("fleet_status", e));
+            continue;
+        }
+
+        out << e.publicKey << ' ' << to_string(e.keyType) << " sequence "
+            << e.sequence;
+        if (e.revoked)
+            out << " revoked";
+        if (!e.domain.empty())
+            out << " domain " << e.domain;
+        out << ' ' << e.keyFile.string() << '\n';
+    }
+
+    for (auto const& error : index.errors)
+        std::cerr << "Failed to load " << error.path.string() << ": "
+                  << error.error << "\n";
+
+    if (options.format == OutputFormat::text)
+        out << index.entries.size() << " keys, " << revoked << " revoked, "
+            << index.errors.size() << " unreadable.\n";
+
+    return index.errors.empty() ? 0 : EXIT_FAILURE;
+}
+
+int
+findKey(
+    std::string const& publicKey,
+    boost::filesystem::path const& keyFileDir,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    auto const index = loadFleetIndex(keyFileDir, options.threads);
+    auto const e = index.find(publicKey);
+    if (!e)
+    {
+        std::cerr << "No key file for " << publicKey << " in "
+                  << keyFileDir.string() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    OutputWriter out(std::cout);
+    if (options.format == OutputFormat::jsonl)
+        out.record(makeRecord("find_key", *e));
+    else
+        out << e->keyFile.string() << '\n';
+    return 0;
+}
+
+// Returns the contents of a file, if it exists
+static boost::optional<std::string>
+readContents(boost::filesystem::path const& file)
+{
+    std::ifstream in(file.string(), std::ios_base::binary);
+    if (!in)
+        return boost::none;
+    return std::string(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+int
+updateKeyArtifacts(
+    std::vector<boost::filesystem::path> const& keyFiles,
+    boost::filesystem::path const& outputDir,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    // A missing key file is left without keys or error
+    std::vector<KeyFileEntry> entries(keyFiles.size());
+    parallelFor(
+        keyFiles.size(),
+        [&](std::size_t i) {
+            entries[i].path = keyFiles[i];
+            if (!exists(keyFiles[i]))
+                return;
+            try
+            {
+                entries[i].keys =
+                    ValidatorKeys::make_ValidatorKeys(keyFiles[i]);
+            }
+            catch (std::exception const& e)
+            {
+                entries[i].error = e.what();
+            }
+        },
+        options.threads);
+
+    OutputWriter out(std::cout);
+    bool failed = false;
+    for (auto const& entry : entries)
+    {
+        // Keep the last good artifacts of a key file that cannot be read
+        if (!entry.error.empty())
+        {
+            std::cerr << "Failed to load " << entry.path.string() << ": "
+                      << entry.error << "\n";
+            failed = true;
+            continue;
+        }
+
+        boost::optional<std::string> attestation;
+        boost::optional<std::string> fragment;
+        if (entry.keys)
+        {
+            auto const& keys = *entry.keys;
+            auto const publicKey =
+                toBase58(TokenType::NodePublic, keys.publicKey());
+
+            if (!keys.revoked() && !keys.domain().empty())
+                attestation =
+                    "attestation=\"" + makeAttestation(keys) + "\"\n";
+
+            std::ostringstream ss;
+            {
+                OutputWriter f(ss);
+                f << "# validator public key: " << publicKey << "\n\n";
+                if (keys.revoked())
+                {
+                    auto const& m = keys.manifest();
+                    f << "[validator_key_revocation]\n";
+                    writeWrapped(f, base64_encode(m.data(), m.size()));
+                }
+                else
+                    f << "[validators]\n" << publicKey << '\n';
+            }
+            fragment = ss.str();
+        }
+
+        auto const stem = entry.path.stem().string();
+        std::pair<std::string, boost::optional<std::string>> const
+            artifacts[] = {
+                {stem + ".attestation", attestation},
+                {stem + ".cfg", fragment}};
+
+        for (auto const& [name, contents] : artifacts)
+        {
+            auto const file = outputDir / name;
+            char const* action = nullptr;
+            if (!contents)
+            {
+                if (remove(file))
+                    action = "removed";
+            }
+            else if (readContents(file) != contents)
+            {
+                writeFileAtomic(file, *contents);
+                action = "updated";
+            }
+
+            if (!action)
+                continue;
+
+            if (options.format == OutputFormat::jsonl)
+            {
+                Json::Value jv;
+                jv["command"] = "watch";
+                jv["key_file"] = entry.path.string();
+                jv["artifact"] = file.string();
+                jv["action"] = action;
+                out.record(jv);
+                continue;
+            }
+
+            out << action << ' ' << file.string() << '\n';
+        }
+    }
+
+    return failed ? EXIT_FAILURE : 0;
+}
+
+void
+watchKeyDirectory(
+    boost::filesystem::path const& keyFileDir,
+    boost::filesystem::path const& outputDir,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    // Watch first, so changes made during the first pass are not missed
+    KeyFileWatcher watcher(keyFileDir);
+    if (options.metrics)
+        requestMetricsOnSignal();
+    updateKeyArtifacts(listKeyFiles(keyFileDir), outputDir, options);
+    std::cout.flush();
+
+    for (;;)
+    {
+        auto const changed = watcher.wait(std::chrono::hours(1));
+
+        // The signal cuts the wait short, so the dump is not delayed
+        if (options.metrics && metricsDumpRequested())
+        {
+            try
+            {
+                dumpMetrics(*options.metrics);
+            }
+            catch (std::exception const& e)
+            {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+
+        if (changed.empty())
+            continue;
+
+        updateKeyArtifacts(changed, outputDir, options);
+        std::cout.flush();
+    }
 }
 
 void
 generateManifest(
     std::string const& type,
-    boost::filesystem::path const& keyFile)
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {})
 {
     using namespace xrpl;
 
+    // Also keeps the manifest history from changing while it is read
+    KeyFileLock const lock(keyFile, KeyFileLock::shared, options.lockTimeout);
     auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
 
-    auto const m = keys.manifest();
+    std::uint32_t sequence = keys.sequence();
+    Slice m = makeSlice(keys.manifest());
+
+    // A logged manifest is read in place from the mapped history
+    boost::optional<ManifestHistoryReader> history;
+    if (options.sequence)
+    {
+        history.emplace(keyFile);
+
+        // A history left by an earlier key at the same path is not this
+        // key's
+        auto const masterKey = history->masterKey();
+        if (history->size() != 0 &&
+            (!masterKey || *masterKey != keys.publicKey()))
+            throw std::runtime_error(
+                "Manifest history " +
+                ManifestHistory(keyFile).logPath().string() +
+                " belongs to a different master key");
+
+        auto const logged = history->find(*options.sequence);
+        if (!logged)
+            throw std::runtime_error(
+                "No manifest with sequence " +
+                std::to_string(*options.sequence) +
+                " in the manifest history of " + keyFile.string());
+
+        sequence = *options.sequence;
+        m = *logged;
+    }
+
+    OutputWriter out(std::cout);
+
+    if (options.format == OutputFormat::jsonl)
+    {
+        if (type != "base64" && type != "hex")
+            throw std::runtime_error("Unknown encoding '" + type + "'");
+
+        auto jv = makeRecord("show_manifest", keys);
+        jv["sequence"] = Json::UInt(sequence);
+        jv["encoding"] = type;
+        if (m.empty())
+            jv["manifest"] = Json::nullValue;
+        else if (type == "base64")
+            jv["manifest"] = base64_encode(m.data(), m.size());
+        else
+            jv["manifest"] = strHex(m);
+        out.record(jv);
+        return;
+    }
 
     if (m.empty())
     {
-        std::cout << "The last manifest generated is unavailable. You can\n";
-        std::cout << "generate a new one.\n\n";
+        out << "The last manifest generated is unavailable. You can\n";
+        out << "generate a new one.\n\n";
         return;
     }
 
     if (type == "base64")
     {
-        std::cout << "Manifest #" << keys.sequence() << " (Base64):\n";
-        std::cout << base64_encode(m.data(), m.size()) << "\n\n";
+        out << "Manifest #" << sequence << " (Base64):\n";
+        out << base64_encode(m.data(), m.size()) << "\n\n";
         return;
     }
 
     if (type == "hex")
     {
-        std::cout << "Manifest #" << keys.sequence() << " (Hex):\n";
-        std::cout << strHex(makeSlice(m)) << "\n\n";
+        out << "Manifest #" << sequence << " (Hex):\n";
+        out << strHex(m) << "\n\n";
         return;
     }
 
-    std::cout << "Unknown encoding '" << type << "'\n";
+    out << "Unknown encoding '" << type << "'\n";
 }
 
-int
-runCommand(
-    std::string const& command,
-    std::vector<std::string> const& args,
-    boost::filesystem::path const& keyFile)
+// Returns s as a CSV field, quoted if necessary
+static std::string
+csvField(std::string_view s)
 {
-    using namespace std;
+    if (s.find_first_of(",\"\r\n") == std::string_view::npos)
+        return std::string(s);
 
-    static map<string, vector<string>::size_type> const commandArgs = {
-        {"create_keys", 0},
-        {"create_token", 0},
-        {"revoke_keys", 0},
-        {"set_domain", 1},
-        {"clear_domain", 0},
-        {"attest_domain", 0},
-        {"show_manifest", 1},
-        {"sign", 1},
-    };
+    std::string quoted = "\"";
+    for (auto const c : s)
+    {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
 
-    auto const iArgs = commandArgs.find(command);
+// Decodes one line of manifest input and returns its formatted output
+static std::string
+decodeManifestLine(
+    std::string const& source,
+    std::size_t lineNumber,
+    std::string_view line,
+    OutputFormat format)
+{
+    using namespace xrpl;
 
-    if (iArgs == commandArgs.end())
-        throw std::runtime_error("Unknown command: " + command);
+    // Reused by every line this thread decodes
+    thread_local std::string blob;
 
-    if (args.size() != iArgs->second)
-        throw std::runtime_error("Syntax error: Wrong number of arguments");
+    char const* error = nullptr;
+    boost::optional<ManifestFields> m;
+    if (!unwrapManifest(line, blob))
+        error = "not hex or base64";
+    else if (!(m = decodeManifest(makeSlice(blob))))
+        error = "malformed manifest";
 
-    if (command == "create_keys")
-        createKeyFile(keyFile);
-    else if (command == "create_token")
-        createToken(keyFile);
-    else if (command == "revoke_keys")
-        createRevocation(keyFile);
-    else if (command == "set_domain")
-        setDomain(args[0], keyFile);
-    else if (command == "clear_domain")
-        setDomain("", keyFile);
-    else if (command == "attest_domain")
-        attestDomain(keyFile);
-    else if (command == "sign")
-        signData(args[0], keyFile);
-    else if (command == "show_manifest")
-        generateManifest(args[0], keyFile);
+    auto const key = [](Slice const& s) {
+        return s.empty() ? std::string()
+                         : toBase58(TokenType::NodePublic, PublicKey(s));
+    };
+    auto const text = [](Slice const& s) {
+        return std::string(reinterpret_cast<char const*>(s.data()), s.size());
+    };
 
-    return 0;
+    if (format == OutputFormat::jsonl)
+    {
+        Json::Value jv;
+        jv["source"] = source;
+        jv["line"] = Json::UInt(lineNumber);
+        if (error)
+        {
+            jv["error"] = error;
+            return toJsonLine(jv);
+        }
+        jv["sequence"] = Json::UInt(m->sequence);
+        jv["revoked"] = m->revoked();
+        jv["master_key"] = key(m->masterKey);
+        if (!m->signingKey.empty())
+            jv["signing_key"] = key(m->signingKey);
+        if (!m->domain.empty())
+            jv["domain"] = text(m->domain);
+        if (!m->signature.empty())
+            jv["signature"] = strHex(m->signature);
+        jv["master_signature"] = strHex(m->masterSignature);
+        return toJsonLine(jv);
+    }
+
+    if (format == OutputFormat::csv)
+    {
+        std::string row = csvField(source) + "," + std::to_string(lineNumber);
+        if (error)
+            return row + ",,,,,,," + error + "\n";
+        return row + "," + std::to_string(m->sequence) + "," +
+            key(m->masterKey) + "," + key(m->signingKey) + "," +
+            csvField(text(m->domain)) + "," + strHex(m->signature) + "," +
+            strHex(m->masterSignature) + ",\n";
+    }
+
+    std::string out = source + ":" + std::to_string(lineNumber) + ": ";
+    if (error)
+        return out + error + "\n";
+
+    if (m->revoked())
+        out += "revocation\n";
+    else
+        out += "manifest #" + std::to_string(m->sequence) + "\n";
+    out += "  master key:       " + key(m->masterKey) + "\n";
+    if (!m->signingKey.empty())
+        out += "  signing key:      " + key(m->signingKey) + "\n";
+    if (!m->domain.empty())
+        out += "  domain:           " + text(m->domain) + "\n";
+    if (!m->signature.empty())
+        out += "  signature:        " + strHex(m->signature) + "\n";
+    out += "  master signature: " + strHex(m->masterSignature) + "\n";
+    return out;
 }
 
-// LCOV_EXCL_START
-static std::string
-getEnvVar(char const* name)
+void
+decodeManifests(
+    std::vector<std::string> const& inputs,
+    CommandOptions const& options)
 {
-    std::string value;
+    using namespace xrpl;
 
-    auto const v = getenv(name);
+    OutputWriter out(std::cout);
+    if (options.format == OutputFormat::csv)
+        out << "source,line,sequence,master_key,signing_key,domain,"
+               "signature,master_signature,error\n";
+
+    // Lines are decoded in parallel in batches, which keeps the output in
+    // input order and memory bounded for arbitrarily long streams.
+    std::size_t const batchSize = 16 * 1024;
+    std::vector<std::string_view> lines;
+    std::vector<std::size_t> lineNumbers;
+    std::vector<std::string> results;
+    lines.reserve(batchSize);
+    lineNumbers.reserve(batchSize);
+
+    auto const decodeBatch = [&](std::string const& source) {
+        results.resize(lines.size());
+        parallelFor(
+            lines.size(),
+            [&](std::size_t i) {
+                results[i] = decodeManifestLine(
+                    source, lineNumbers[i], lines[i], options.format);
+            },
+            options.threads);
+        for (auto const& r : results)
+            out << r;
+        lines.clear();
+        lineNumbers.clear();
+    };
 
-    if (v != nullptr)
-        value = v;
+    auto const addLine = [&](std::string_view line, std::size_t number) {
+        auto const space = [](char c) {
+            return std::isspace(static_cast<unsigned char>(c));
+        };
+        while (!line.empty() && space(line.back()))
+            line.remove_suffix(1);
+        while (!line.empty() && space(line.front()))
+            line.remove_prefix(1);
+        if (line.empty())
+            return;
+        lines.push_back(line);
+        lineNumbers.push_back(number);
+    };
 
-    return value;
+    std::vector<std::string> const stdinOnly = {"-"};
+    for (auto const& source : inputs.empty() ? stdinOnly : inputs)
+    {
+        if (source == "-")
+        {
+            // Lines read from a stream need storage until they are decoded.
+            // A skipped line leaves its slot to be overwritten by the next.
+            std::vector<std::string> storage(batchSize);
+            std::size_t number = 0;
+            while (std::getline(std::cin, storage[lines.size()]))
+            {
+                addLine(storage[lines.size()], ++number);
+                if (lines.size() == batchSize)
+                    decodeBatch(source);
+            }
+            decodeBatch(source);
+            continue;
+        }
+
+        MappedFile const file(source);
+        auto text = file.contents();
+
+        std::size_t number = 0;
+        while (!text.empty())
+        {
+            auto const eol = std::min(text.find('\n'), text.size());
+            addLine(text.substr(0, eol), ++number);
+            if (lines.size() == batchSize)
+                decodeBatch(source);
+            text.remove_prefix(std::min(eol + 1, text.size()));
+        }
+        decodeBatch(source);
+    }
 }
 
-void
-printHelp(const boost::program_options::options_description& desc)
-{
-    std::cerr
-        << "validator-keys [options] <command> [<argument> ...]\n"
-        << desc << std::endl
-        << "Commands: \n"
-           "     create_keys                   Generate validator keys.\n"
-           "     create_token                  Generate validator token.\n"
-           "     revoke_keys                   Revoke validator keys.\n"
-           "     sign <data>                   Sign string with validator "
-           "key.\n"
-           "     show_manifest [hex|base64]    Displays the last generated "
-           "manifest\n"
-           "     set_domain <domain>           Associate a domain with the "
-           "validator key.\n"
-           "     clear_domain                  Disassociate a domain from a "
-           "validator key.\n"
-           "     attest_domain                 Produce the attestation string "
-           "for a domain.\n";
-}
-// LCOV_EXCL_STOP
+// Returns a record without the line break it was read with, "\n" or "\r\n",
+// so sign_batch and verify_inclusion --file agree on its bytes
+static std::string_view
+stripLineBreak(std::string_view line)
+{
+    if (line.ends_with('\n'))
+        line.remove_suffix(1);
+    if (line.ends_with('\r'))
+        line.remove_suffix(1);
+    return line;
+}
 
-std::string const&
-getVersionString()
+void
+signBatch(
+    std::vector<std::string> const& inputs,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
 {
-    static std::string const value = [] {
-        std::string const s = versionString;
-        beast::SemanticVersion v;
-        if (!v.parse(s) || v.print() != s)
-            throw std::logic_error(
-                s + ": Bad version string");  // LCOV_EXCL_LINE
-        return s;
-    }();
-    return value;
+    using namespace xrpl;
+
+    if (!options.merkle)
+        throw std::runtime_error("Syntax error: sign_batch needs --merkle");
+
+    auto const keys = loadKeyFile(keyFile, options);
+    if (keys.revoked())
+        std::cerr << "WARNING: Validator keys have been revoked!\n";
+
+    // Records are hashed in parallel as they are read, so only their leaf
+    // hashes are kept.
+    std::size_t const batchSize = 16 * 1024;
+    std::vector<uint256> leaves;
+    std::vector<std::string_view> lines;
+    lines.reserve(batchSize);
+
+    auto const hashBatch = [&] {
+        auto const first = leaves.size();
+        leaves.resize(first + lines.size());
+        parallelFor(
+            lines.size(),
+            [&](std::size_t i) {
+                leaves[first + i] =
+                    merkleLeaf(Slice(lines[i].data(), lines[i].size()));
+            },
+            options.threads);
+        lines.clear();
+    };
+
+    if (inputs.empty() || inputs[0] == "-")
+    {
+        std::vector<std::string> storage(batchSize);
+        while (std::getline(std::cin, storage[lines.size()]))
+        {
+            lines.push_back(stripLineBreak(storage[lines.size()]));
+            if (lines.size() == batchSize)
+                hashBatch();
+        }
+        hashBatch();
+    }
+    else
+    {
+        MappedFile const file(inputs[0]);
+        auto text = file.contents();
+        while (!text.empty())
+        {
+            auto const eol = std::min(text.find('\n'), text.size());
+            lines.push_back(stripLineBreak(text.substr(0, eol)));
+            if (lines.size() == batchSize)
+                hashBatch();
+            text.remove_prefix(std::min(eol + 1, text.size()));
+        }
+        hashBatch();
+    }
+
+    // Counts and indexes are written to JSON as 32-bit numbers
+    if (leaves.size() > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Too many records for one batch");
+
+    MerkleTree const tree(std::move(leaves), options.threads);
+    auto const signature = strUnHex(
+        keys.signDigest(merkleRootDigest(tree.root(), tree.size())));
+
+    OutputWriter out(std::cout);
+    if (options.format == OutputFormat::jsonl)
+    {
+        auto jv = makeRecord("sign_batch", keys);
+        jv["count"] = Json::UInt(tree.size());
+        jv["root"] = to_string(tree.root());
+        jv["signature"] = strHex(*signature);
+        out.record(jv);
+    }
+
+    std::vector<std::string> proofs;
+    for (std::size_t first = 0; first < tree.size(); first += batchSize)
+    {
+        proofs.resize(std::min(batchSize, tree.size() - first));
+        parallelFor(
+            proofs.size(),
+            [&](std::size_t i) {
+                InclusionProof proof;
+                proof.count = tree.size();
+                proof.index = first + i;
+                proof.path = tree.path(first + i);
+                proof.signature = Buffer(signature->data(), signature->size());
+                proofs[i] = proof.encode();
+            },
+            options.threads);
+
+        for (std::size_t i = 0; i < proofs.size(); ++i)
+        {
+            if (options.format == OutputFormat::jsonl)
+            {
+                Json::Value jv;
+                jv["index"] = Json::UInt(first + i);
+                jv["proof"] = proofs[i];
+                out.record(jv);
+            }
+            else
+            {
+                out << proofs[i] << '\n';
+            }
+        }
+    }
 }
 
 int
-main(int argc, char** argv)
+verifyInclusionProof(
+    std::string const& publicKey,
+    std::string const& proof,
+    std::string const& record,
+    CommandOptions const& options)
 {
-    namespace po = boost::program_options;
-
-    po::variables_map vm;
+    using namespace xrpl;
 
-    // Set up option parsing.
-    //
-    po::options_description general("General Options");
-    general.add_options()("help,h", "Display this message.")(
-        "keyfile", po::value<std::string>(), "Specify the key file.")(
-        "unittest,u", "Perform unit tests.")(
-        "version", "Display the build version.");
+    auto const pk = parseBase58<PublicKey>(TokenType::NodePublic, publicKey);
+    if (!pk)
+        throw std::runtime_error("Invalid public key: " + publicKey);
 
-    po::options_description hidden("Hidden options");
-    hidden.add_options()("command", po::value<std::string>(), "Command.")(
-        "arguments",
-        po::value<std::vector<std::string>>()->default_value(
-            std::vector<std::string>(), "empty"),
-        "Arguments.");
-    po::positional_options_description p;
-    p.add("command", 1).add("arguments", -1);
+    // sign_batch never signs more records than fit in 32 bits
+    auto const p = InclusionProof::decode(proof);
+    if (!p || p->count > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Malformed inclusion proof");
 
-    po::options_description cmdline_options;
-    cmdline_options.add(general).add(hidden);
+    bool const valid = verifyInclusion(*p, *pk, makeSlice(record));
 
-    // Parse options, if no error.
-    try
+    OutputWriter out(std::cout);
+    if (options.format == OutputFormat::jsonl)
     {
-        po::store(
-            po::command_line_parser(argc, argv)
-                .options(cmdline_options)  // Parse options.
-                .positional(p)
-                .run(),
-            vm);
-        po::notify(vm);  // Invoke option notify functions.
+        Json::Value jv;
+        jv["command"] = "verify_inclusion";
+        jv["public_key"] = publicKey;
+        jv["index"] = Json::UInt(p->index);
+        jv["count"] = Json::UInt(p->count);
+        jv["valid"] = valid;
+        out.record(jv);
     }
-    // LCOV_EXCL_START
-    catch (std::exception const&)
+    else if (valid)
     {
-        std::cerr << "validator-keys: Incorrect command line syntax."
-                  << std::endl;
-        std::cerr << "Use '--help' for a list of options." << std::endl;
-        return EXIT_FAILURE;
+        out << "Valid: record " << p->index << " of a batch of " << p->count
+            << " signed by " << publicKey << "\n";
+    }
+    else
+    {
+        out << "INVALID: the record is not in a batch signed by "
+            << publicKey << "\n";
     }
-    // LCOV_EXCL_STOP
 
-    // Run the unit tests if requested.
-    // The unit tests will exit the application with an appropriate return code.
-    if (vm.count("unittest"))
-        return runUnitTests();
+    return valid ? 0 : EXIT_FAILURE;
+}
+
+void
+publishList(
+    std::vector<std::string> const& inputs,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+    using namespace std::chrono;
+
+    if (!options.sequence || !options.expiration)
+        throw std::runtime_error(
+            "Syntax error: publish_list needs --sequence and --expiration");
+
+    // The list takes effect when it is published, so it must expire later
+    if (*options.expiration == 0)
+        throw std::runtime_error(
+            "Syntax error: --expiration must be at least 1");
+
+    auto const expiration =
+        duration_cast<seconds>(system_clock::now().time_since_epoch())
+            .count() -
+        rippleEpochOffset + std::int64_t{*options.expiration} * 86400;
+    if (expiration > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("The expiration is too far in the future");
+
+    // Every source is read whole and its lines are checked in parallel
+    struct Line
+    {
+        std::string const* source;
+        std::size_t number;
+        std::string_view text;
+    };
 
-    // LCOV_EXCL_START
-    if (vm.count("version"))
+    std::vector<std::string> const stdinOnly = {"-"};
+    auto const& sources = inputs.empty() ? stdinOnly : inputs;
+    std::vector<std::string> contents(sources.size());
+    std::vector<Line> lines;
+    for (std::size_t i = 0; i < sources.size(); ++i)
     {
-        std::cout << "validator-keys version " << getVersionString()
-                  << std::endl;
-        return 0;
+        if (sources[i] == "-")
+            contents[i].assign(
+                std::istreambuf_iterator<char>(std::cin),
+                std::istreambuf_iterator<char>());
+        else if (auto c = readContents(sources[i]))
+            contents[i] = std::move(*c);
+        else
+            throw std::runtime_error("Cannot open file: " + sources[i]);
+
+        std::string_view text = contents[i];
+        std::size_t number = 0;
+        while (!text.empty())
+        {
+            auto const eol = std::min(text.find('\n'), text.size());
+            auto line = text.substr(0, eol);
+            text.remove_prefix(std::min(eol + 1, text.size()));
+            ++number;
+
+            auto const space = [](char c) {
+                return std::isspace(static_cast<unsigned char>(c));
+            };
+            while (!line.empty() && space(line.back()))
+                line.remove_suffix(1);
+            while (!line.empty() && space(line.front()))
+                line.remove_prefix(1);
+            if (!line.empty())
+                lines.push_back({&sources[i], number, line});
+        }
     }
 
-    if (vm.count("help") || !vm.count("command"))
+    std::vector<boost::optional<ListedValidator>> listed(lines.size());
+    std::vector<std::string> errors(lines.size());
+    parallelFor(
+        lines.size(),
+        [&](std::size_t i) {
+            std::string manifest;
+            if (!unwrapManifest(lines[i].text, manifest))
+                errors[i] = "not hex or base64";
+            else
+            {
+                try
+                {
+                    listed[i] = checkListedManifest(std::move(manifest));
+                }
+                catch (std::exception const& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+        },
+        options.threads);
+
+    for (std::size_t i = 0; i < lines.size(); ++i)
     {
-        printHelp(general);
-        return EXIT_SUCCESS;
+        if (!errors[i].empty())
+            throw std::runtime_error(
+                *lines[i].source + ":" + std::to_string(lines[i].number) +
+                ": " + errors[i]);
     }
 
-    std::string const homeDir = getEnvVar("HOME");
-    std::string const defaultKeyFile =
-        (homeDir.empty() ? boost::filesystem::current_path().string()
-                         : homeDir) +
-        "/.ripple/validator-keys.json";
+    std::vector<ListedValidator> validators;
+    validators.reserve(listed.size());
+    for (auto& v : listed)
+        validators.push_back(std::move(*v));
+    listed = {};
+    lines = {};
+    contents = {};
+
+    if (validators.empty())
+        throw std::runtime_error("No validator manifests to publish");
+
+    std::sort(
+        validators.begin(), validators.end(), [](auto const& a, auto const& b) {
+            return a.masterKey < b.masterKey;
+        });
+    auto const twice = std::adjacent_find(
+        validators.begin(), validators.end(), [](auto const& a, auto const& b) {
+            return a.masterKey == b.masterKey;
+        });
+    if (twice != validators.end())
+        throw std::runtime_error(
+            "Validator listed twice: " +
+            toBase58(TokenType::NodePublic, twice->masterKey));
 
-    try
+    // The list is signed with a new token, made as by create_token
+    KeyFileLock const lock(
+        keyFile, KeyFileLock::exclusive, options.lockTimeout);
+    auto keys = ValidatorKeys::make_ValidatorKeys(keyFile);
+
+    if (keys.revoked())
+        throw std::runtime_error("Validator keys have been revoked.");
+
+    auto const token = keys.createValidatorToken();
+    if (!token)
+        throw std::runtime_error(
+            "Maximum number of tokens have already been generated.\n"
+            "Revoke validator keys if previous token has been compromised.");
+
+    keys.writeToFile(keyFile);
+    logManifest(keyFile, keys, keys.sequence());
+
+    auto const blob = makeListBlob(
+        *options.sequence, static_cast<std::uint32_t>(expiration), validators);
+    auto const signature = sign(
+        derivePublicKey(KeyType::secp256k1, token->secretKey),
+        token->secretKey,
+        makeSlice(blob));
+
+    OutputWriter out(std::cout);
+    writeValidatorList(
+        out, makeSlice(blob), token->manifest, keys.publicKey(), signature);
+}
+
+int
+verifyList(
+    std::string const& list,
+    std::string const& publisherKey,
+    CommandOptions const& options)
+{
+    using namespace xrpl;
+    using namespace std::chrono;
+
+    std::string json;
+    if (list == "-")
+        json.assign(
+            std::istreambuf_iterator<char>(std::cin),
+            std::istreambuf_iterator<char>());
+    else if (auto c = readContents(list))
+        json = std::move(*c);
+    else
+        throw std::runtime_error("Cannot open file: " + list);
+
+    auto const start = steady_clock::now();
+    auto const v = verifyValidatorList(json, options.threads);
+    auto const elapsed =
+        duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    auto const now =
+        duration_cast<seconds>(system_clock::now().time_since_epoch())
+            .count() -
+        rippleEpochOffset;
+    bool const expired = v.expiration <= now;
+    bool const expected = publisherKey.empty() ||
+        (v.publisherKey &&
+         boost::iequals(publisherKey, strHex(*v.publisherKey)));
+    bool const accepted = v.manifestError.empty() && v.signatureValid &&
+        expected && !expired;
+
+    auto const key = [](PublicKey const& k) {
+        return toBase58(TokenType::NodePublic, k);
+    };
+
+    OutputWriter out(std::cout);
+
+    if (options.format == OutputFormat::jsonl)
     {
-        using namespace boost::filesystem;
-        path keyFile = vm.count("keyfile") ? vm["keyfile"].as<std::string>()
-                                           : defaultKeyFile;
+        Json::Value jv(Json::objectValue);
+        jv["command"] = "verify_list";
+        jv["accepted"] = accepted;
+        if (v.publisherKey)
+            jv["publisher_key"] = strHex(*v.publisherKey);
+        jv["expected_publisher"] = expected;
+        if (v.manifestSequence)
+            jv["manifest_sequence"] = *v.manifestSequence;
+        if (!v.manifestError.empty())
+            jv["manifest_error"] = v.manifestError;
+        jv["signature_valid"] = v.signatureValid;
+        jv["sequence"] = v.sequence;
+        jv["expiration"] = v.expiration;
+        jv["expired"] = expired;
+        jv["listed"] = Json::UInt(v.listed);
+        auto const keys = [&](std::vector<PublicKey> const& ks) {
+            Json::Value a(Json::arrayValue);
+            for (auto const& k : ks)
+                a.append(key(k));
+            return a;
+        };
+        jv["validators"] = keys(v.effective);
+        jv["duplicates"] = keys(v.duplicates);
+        jv["revoked"] = keys(v.revoked);
+        auto& invalid = jv["invalid"] = Json::Value(Json::arrayValue);
+        for (auto const& [index, error] : v.invalid)
+        {
+            Json::Value entry;
+            entry["index"] = Json::UInt(index);
+            entry["error"] = error;
+            invalid.append(entry);
+        }
+        jv["elapsed_ms"] = Json::UInt(elapsed);
+        out.record(jv);
+        return accepted ? 0 : EXIT_FAILURE;
+    }
 
-        return runCommand(
-            vm["command"].as<std::string>(),
-            vm["arguments"].as<std::vector<std::string>>(),
-            keyFile);
+    out << "Publisher:  "
+        << (v.publisherKey ? key(*v.publisherKey) : "invalid key")
+        << (expected ? "" : " (not the expected publisher)") << '\n';
+    out << "Manifest:   ";
+    if (v.manifestSequence)
+        out << "#" << *v.manifestSequence << ' ';
+    out << (v.manifestError.empty() ? "valid" : v.manifestError) << '\n';
+    out << "Signature:  " << (v.signatureValid ? "valid" : "invalid") << '\n';
+    out << "Sequence:   " << v.sequence << '\n';
+
+    std::time_t const expiresAt = v.expiration + rippleEpochOffset;
+    std::ostringstream date;
+    date << std::put_time(std::gmtime(&expiresAt), "%Y-%m-%d %H:%M:%S UTC");
+    out << "Expiration: " << date.str() << (expired ? " (expired)" : "")
+        << "\n\n";
+
+    for (auto const& k : v.duplicates)
+        out << "duplicate: " << key(k) << '\n';
+    for (auto const& k : v.revoked)
+        out << "revoked:   " << key(k) << '\n';
+    for (auto const& [index, error] : v.invalid)
+        out << "invalid:   entry " << index << ": " << error << '\n';
+
+    out << "Effective validators:\n";
+    for (auto const& k : v.effective)
+        out << "  " << key(k) << '\n';
+
+    out << v.listed << " listed: " << v.effective.size() << " effective, "
+        << v.duplicates.size() << " duplicate, " << v.revoked.size()
+        << " revoked, " << v.invalid.size() << " invalid. Checked in "
+        << elapsed << " ms.\n";
+    out << "The list " << (accepted ? "is" : "is NOT")
+        << " acceptable to rippled.\n";
+
+    return accepted ? 0 : EXIT_FAILURE;
+}
+
+int
+auditConfigFiles(CommandOptions const& options)
+{
+    using namespace xrpl;
+
+    if (!options.configsDir || !options.keysDir)
+        throw std::runtime_error(
+            "Syntax error: audit_configs needs --configs and --keys");
+
+    auto const audits =
+        auditConfigs(*options.configsDir, *options.keysDir, options.threads);
+
+    OutputWriter out(std::cout);
+    std::size_t failed = 0;
+    for (auto const& audit : audits)
+    {
+        if (!audit.issues.empty())
+            ++failed;
+
+        if (options.format == OutputFormat::jsonl)
+        {
+            Json::Value jv(Json::objectValue);
+            jv["config"] = audit.config.string();
+            jv["ok"] = audit.issues.empty();
+            if (audit.publicKey)
+                jv["public_key"] =
+                    toBase58(TokenType::NodePublic, *audit.publicKey);
+            if (audit.tokenSequence)
+                jv["token_sequence"] = *audit.tokenSequence;
+            if (audit.keySequence)
+            {
+                jv["key_file"] = audit.keyFile.string();
+                jv["key_sequence"] = *audit.keySequence;
+            }
+            auto& issues = jv["issues"] = Json::Value(Json::arrayValue);
+            for (auto const& issue : audit.issues)
+                issues.append(issue);
+            out.record(jv);
+            continue;
+        }
+
+        out << audit.config.string() << ": ";
+        if (audit.issues.empty())
+        {
+            out << "ok\n";
+            continue;
+        }
+        for (std::size_t i = 0; i < audit.issues.size(); ++i)
+            out << (i ? ", " : "") << audit.issues[i];
+        out << '\n';
+        if (audit.publicKey)
+            out << "  master key:     "
+                << toBase58(TokenType::NodePublic, *audit.publicKey) << '\n';
+        if (audit.tokenSequence)
+            out << "  token sequence: " << *audit.tokenSequence << '\n';
+        if (audit.keySequence)
+            out << "  key file:       " << audit.keyFile.string()
+                << " (sequence " << *audit.keySequence << ")\n";
     }
-    catch (std::exception const& e)
+
+    if (options.format == OutputFormat::text)
+        out << failed << " of " << audits.size()
+            << " configs need attention.\n";
+
+    return failed ? EXIT_FAILURE : 0;
+}
+
+int
+runCommand(
+    std::string const& command,
+    std::vector<std::string> const& args,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options)
+{
+    using namespace std;
+
+    static auto const any = numeric_limits<vector<string>::size_type>::max();
+
+    // Minimum and maximum number of arguments of each command
+    static map<
+        string,
+        pair<vector<string>::size_type, vector<string>::size_type>> const
+        commandArgs = {
+            {"create_keys", {0, 0}},
+            {"create_token", {0, 0}},
+            {"revoke_keys", {0, 0}},
+            {"set_domain", {1, 1}},
+            {"clear_domain", {0, 0}},
+            {"attest_domain", {0, 0}},
+            {"show_manifest", {1, 1}},
+            {"sign", {1, 1}},
+            {"decode_manifest", {0, any}},
+            {"audit_configs", {0, 0}},
+            {"sign_batch", {0, 1}},
+            {"verify_inclusion", {3, 3}},
+            {"vault_import", {1, any}},
+            {"vault_list", {0, 0}},
+            {"watch", {0, 0}},
+            {"fleet_status", {0, 0}},
+            {"find_key", {1, 1}},
+            {"publish_list", {0, any}},
+            {"verify_list", {1, 2}},
+        };
+
+    // Commands that can write CSV
+    static set<string> const csvCommands = {"decode_manifest"};
+
+    auto const iArgs = commandArgs.find(command);
+
+    if (iArgs == commandArgs.end())
+        throw std::runtime_error("Unknown command: " + command);
+
+    // With --file, sign takes the data from the file instead
+    auto bounds = iArgs->second;
+    if (command == "sign" && options.file)
+        bounds = {0, 0};
+    if (command == "verify_inclusion" && options.file)
+        bounds = {2, 2};
+
+    if (args.size() < bounds.first || args.size() > bounds.second)
+        throw std::runtime_error("Syntax error: Wrong number of arguments");
+
+    if (options.format == OutputFormat::csv && !csvCommands.count(command))
+        throw std::runtime_error(
+            "Output format csv is not supported by " + command);
+
+    if (options.count && !options.keyFileDir)
+        throw std::runtime_error("Syntax error: --count needs --keyfile-dir");
+
+    if ((command == "fleet_status" || command == "find_key") &&
+        !options.keyFileDir)
+        throw std::runtime_error(
+            "Syntax error: " + command + " needs --keyfile-dir");
+
+    if (command == "watch" && (!options.keyFileDir || !options.outputDir))
+        throw std::runtime_error(
+            "Syntax error: watch needs --keyfile-dir and --output-dir");
+
+    if (command.compare(0, 6, "vault_") == 0 && !options.vault)
+        throw std::runtime_error("Syntax error: " + command + " needs --vault");
+
+    if (command == "watch")
+        watchKeyDirectory(*options.keyFileDir, *options.outputDir, options);
+    else if (command == "create_keys" && options.keyFileDir)
+        createKeyFiles(*options.keyFileDir, options.count.value_or(1), options);
+    else if (command == "create_keys")
+        createKeyFile(keyFile, options);
+    else if (command == "create_token")
+        createToken(keyFile, options);
+    else if (command == "revoke_keys")
+        createRevocation(keyFile, options);
+    else if (command == "set_domain")
+        setDomain(args[0], keyFile, options);
+    else if (command == "clear_domain")
+        setDomain("", keyFile, options);
+    else if (command == "attest_domain")
+        attestDomain(keyFile, options);
+    else if (command == "sign" && options.file)
+        signFile(*options.file, keyFile, options);
+    else if (command == "sign" && options.keyFileDir)
+        return signDataWithKeyDirectory(args[0], *options.keyFileDir, options);
+    else if (command == "sign" && options.vault)
+        return signDataWithKeyVault(args[0], *options.vault, options);
+    else if (command == "sign")
+        signData(args[0], keyFile, options);
+    else if (command == "show_manifest")
+        generateManifest(args[0], keyFile, options);
+    else if (command == "decode_manifest")
+        decodeManifests(args, options);
+    else if (command == "audit_configs")
+        return auditConfigFiles(options);
+    else if (command == "sign_batch")
+        signBatch(args, keyFile, options);
+    else if (command == "verify_inclusion" && options.file)
     {
-        std::cerr << e.what() << "\n";
-        return EXIT_FAILURE;
+        xrpl::MappedFile const file(*options.file);
+        return verifyInclusionProof(
+            args[0],
+            args[1],
+            std::string(stripLineBreak(file.contents())),
+            options);
     }
+    else if (command == "verify_inclusion")
+        return verifyInclusionProof(args[0], args[1], args[2], options);
+    else if (command == "vault_import")
+        importKeyFiles(args, *options.vault, options);
+    else if (command == "vault_list")
+        return listKeyVault(*options.vault, options);
+    else if (command == "fleet_status")
+        return fleetStatus(*options.keyFileDir, options);
+    else if (command == "find_key")
+        return findKey(args[0], *options.keyFileDir, options);
+    else if (command == "publish_list")
+        publishList(args, keyFile, options);
+    else if (command == "verify_list")
+        return verifyList(args[0], args.size() > 1 ? args[1] : "", options);
+
+    return 0;
+}
 
-    return EXIT_SUCCESS;
-    // LCOV_EXCL_STOP
+std::string const&
+getVersionString()
+{
+    static std::string const value = [] {
+        std::string const s = versionString;
+        beast::SemanticVersion v;
+        if (!v.parse(s) || v.print() != s)
+            throw std::logic_error(
+                s + ": Bad version string");  // LCOV_EXCL_LINE
+        return s;
+    }();
+    return value;
 }
@@ -1,5 +1,9 @@
 #include <boost/optional.hpp>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace boost {
@@ -8,23 +12,308 @@ class path;
 }
 }  // namespace boost
 
+namespace xrpl {
+class ValidatorKeys;
+}
+
+/** How command results are written to standard output */
+enum class OutputFormat {
+    // Human readable text
+    text,
+    // One compact JSON object per result (JSON Lines)
+    jsonl,
+    // Comma separated values with a header row
+    csv
+};
+
+/** Returns the OutputFormat named by s
+
+    @throws std::runtime_error if s does not name a format
+*/
+OutputFormat
+outputFormatFromString(std::string const& s);
+
+/** Options shared by the command functions */
+struct CommandOptions
+{
+    OutputFormat format = OutputFormat::text;
+
+    // Look up this sequence in the manifest history (show_manifest), or
+    // the sequence of the list (publish_list)
+    boost::optional<std::uint32_t> sequence;
+
+    // Days until the list expires (publish_list)
+    boost::optional<unsigned> expiration;
+
+    // Worker threads for batch commands, 0 for one per core
+    unsigned threads = 0;
+
+    // Directories of config and key files (audit_configs)
+    boost::optional<std::string> configsDir;
+    boost::optional<std::string> keysDir;
+
+    // Use every key file in this directory instead of --keyfile (sign), or
+    // the directory to create key files in (create_keys)
+    boost::optional<std::string> keyFileDir;
+
+    // Number of key files to create (create_keys)
+    boost::optional<std::size_t> count;
+
+    // Sign this file instead of a data string (sign), or the record to
+    // check (verify_inclusion)
+    boost::optional<std::string> file;
+
+    // Sign records as one Merkle batch (sign_batch)
+    bool merkle = false;
+
+    // Encrypted key vault and its password (vault_import, vault_list,
+    // sign)
+    boost::optional<std::string> vault;
+    boost::optional<std::string> vaultPassword;
+
+    // Where to write the artifacts of each key file (watch)
+    boost::optional<std::string> outputDir;
+
+    // How long to wait for another process to release the key file
+    std::chrono::milliseconds lockTimeout{10000};
+
+    // Where to dump the metrics when SIGUSR1 is received (watch)
+    boost::optional<std::string> metrics;
+};
+
 std::string const&
 getVersionString();
 
+/** Returns the signature attesting the association of the keys with their
+    domain
+*/
+std::string
+makeAttestation(xrpl::ValidatorKeys const& keys);
+
+void
+createKeyFile(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
+
+/** Creates count key files in a directory in parallel
+
+    The files are named validator-keys-<n>.json, n counting from 1 and
+    padded to the width of count.
+
+    @throws std::runtime_error if any of the files already exists
+*/
+void
+createKeyFiles(
+    boost::filesystem::path const& keyFileDir,
+    std::size_t count,
+    CommandOptions const& options = {});
+
+void
+createToken(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
+
+void
+createRevocation(
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
+
+void
+signData(
+    std::string const& data,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
+
+/** Signs a file with validator key
+
+    The file is hashed in a single streaming pass with fileSignaturePrefix
+    (see FileSignature.h) and the digest is signed.
+*/
+void
+signFile(
+    boost::filesystem::path const& file,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
+
+/** Signs data with every key file in a directory
+
+    The keys are loaded and the data signed in parallel. Signatures are
+    printed in key file path order.
+
+    @return EXIT_FAILURE if a key file could not be loaded, 0 otherwise
+*/
+int
+signDataWithKeyDirectory(
+    std::string const& data,
+    boost::filesystem::path const& keyFileDir,
+    CommandOptions const& options = {});
+
+/** Signs data with every key in an encrypted key vault
+
+    The vault is unlocked once, then the keys are decrypted and the data
+    signed in parallel. Signatures are printed in entry name order.
+
+    @return EXIT_FAILURE if an entry could not be decrypted, 0 otherwise
+*/
+int
+signDataWithKeyVault(
+    std::string const& data,
+    boost::filesystem::path const& vault,
+    CommandOptions const& options);
+
+/** Adds key files to an encrypted key vault, creating it if needed
+
+    Each key file is stored under its file name without the extension,
+    replacing any entry of that name.
+*/
 void
-createKeyFile(boost::filesystem::path const& keyFile);
+importKeyFiles(
+    std::vector<std::string> const& keyFiles,
+    boost::filesystem::path const& vault,
+    CommandOptions const& options);
+
+/** Lists the public keys in an encrypted key vault
 
+    @return EXIT_FAILURE if an entry could not be decrypted, 0 otherwise
+*/
+int
+listKeyVault(
+    boost::filesystem::path const& vault,
+    CommandOptions const& options);
+
+/** Signs a batch of records, one per line, with a single signature
+
+    The records are the leaves of a Merkle tree whose root is signed. An
+    inclusion proof is printed for every record, in input order.
+
+    @param inputs File to read, "-" or none for standard input
+*/
 void
-createToken(boost::filesystem::path const& keyFile);
+signBatch(
+    std::vector<std::string> const& inputs,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
+
+/** Checks a record's inclusion proof from signBatch
+
+    @return EXIT_FAILURE if the proof is invalid, 0 otherwise
+*/
+int
+verifyInclusionProof(
+    std::string const& publicKey,
+    std::string const& proof,
+    std::string const& record,
+    CommandOptions const& options = {});
+
+/** Reports every key in a key directory
+
+    Keys are read from the directory's fleet index (see FleetIndex.h), so
+    only key files that changed since the last run are parsed.
+
+    @return EXIT_FAILURE if a key file could not be loaded, 0 otherwise
+*/
+int
+fleetStatus(
+    boost::filesystem::path const& keyFileDir,
+    CommandOptions const& options = {});
+
+/** Prints the key file of a base58 node public key in a key directory
+
+    @return EXIT_FAILURE if no key file has the key, 0 otherwise
+*/
+int
+findKey(
+    std::string const& publicKey,
+    boost::filesystem::path const& keyFileDir,
+    CommandOptions const& options = {});
+
+/** Brings the artifacts generated from key files up to date
 
+    For a key file <name>.json, <name>.attestation holds the domain
+    attestation line for xrp-ledger.toml and <name>.cfg a config fragment:
+    the [validator_key_revocation] of revoked keys, otherwise the
+    [validators] entry of the public key. Only artifacts whose contents
+    change are written, each atomically. The artifacts of key files that
+    no longer exist are removed.
+
+    @return EXIT_FAILURE if a key file could not be loaded, 0 otherwise
+*/
+int
+updateKeyArtifacts(
+    std::vector<boost::filesystem::path> const& keyFiles,
+    boost::filesystem::path const& outputDir,
+    CommandOptions const& options = {});
+
+/** Keeps the artifacts of every key file in a directory up to date
+
+    All artifacts are brought up to date, then only those of key files
+    that change are regenerated. Does not return.
+*/
+void
+watchKeyDirectory(
+    boost::filesystem::path const& keyFileDir,
+    boost::filesystem::path const& outputDir,
+    CommandOptions const& options = {});
+
+/** Decodes manifests, one hex or base64 manifest per line
+
+    @param inputs Files to read, "-" or none for standard input
+*/
 void
-createRevocation(boost::filesystem::path const& keyFile);
+decodeManifests(
+    std::vector<std::string> const& inputs,
+    CommandOptions const& options = {});
+
+/** Publishes a signed validator list of manifests, one per line
+
+    Every manifest is checked in parallel, and a validator may be listed
+    only once. A new token is then generated for the publisher keys in
+    keyFile, as by create_token, and its ephemeral key signs the list
+    blob. The list is printed in the format rippled fetches from a
+    publisher site.
+
+    @param inputs Files to read, "-" or none for standard input
 
+    @throws std::runtime_error naming the first manifest that fails a check
+*/
 void
-signData(std::string const& data, boost::filesystem::path const& keyFile);
+publishList(
+    std::vector<std::string> const& inputs,
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options);
+
+/** Checks a validator list fetched from a publisher
+
+    Prints the publisher, the list sequence and expiration, the problems
+    found and the validators the list puts in effect, and how long the
+    checks took.
+
+    @param list File holding the list, or "-" for standard input
+    @param publisherKey Hex key the list must be published with, as in
+                        [validator_list_keys]; empty to accept any
+
+    @return EXIT_FAILURE if rippled would reject the list: the publisher
+            manifest or blob signature does not verify, the publisher is
+            not the expected one, or the list has expired; 0 otherwise
+*/
+int
+verifyList(
+    std::string const& list,
+    std::string const& publisherKey,
+    CommandOptions const& options = {});
+
+/** Audits rippled.cfg files against key files
+
+    @return EXIT_FAILURE if any config needs attention, 0 otherwise
+
+    @throws std::runtime_error if either directory is not given
+*/
+int
+auditConfigFiles(CommandOptions const& options);
 
 int
 runCommand(
     std::string const& command,
     std::vector<std::string> const& arg,
-    boost::filesystem::path const& keyFile);
+    boost::filesystem::path const& keyFile,
+    CommandOptions const& options = {});
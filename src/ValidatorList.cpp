@@ -0,0 +1,259 @@
+#include <ManifestDecoder.h>
+#include <OutputWriter.h>
+#include <Parallel.h>
+#include <ValidatorList.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/basics/base64.h>
+#include <xrpl/json/json_reader.h>
+#include <xrpl/protocol/HashPrefix.h>
+#include <xrpl/protocol/STObject.h>
+#include <xrpl/protocol/Sign.h>
+
+#include <algorithm>
+#include <set>
+
+namespace xrpl {
+
+namespace {
+
+// Verifies the signatures of a decoded manifest; a revocation only has
+// the master signature
+bool
+verifyManifest(std::string const& manifest, ManifestFields const& m)
+{
+    STObject st(sfGeneric);
+    SerialIter sit(makeSlice(manifest));
+    st.set(sit);
+
+    if (!m.revoked() &&
+        !verify(st, HashPrefix::manifest, PublicKey(m.signingKey)))
+        return false;
+    return verify(
+        st, HashPrefix::manifest, PublicKey(m.masterKey), sfMasterSignature);
+}
+
+boost::optional<std::uint32_t>
+toUInt32(Json::Value const& v)
+{
+    if (v.isUInt() || (v.isInt() && v.asInt() >= 0))
+        return v.asUInt();
+    return boost::none;
+}
+
+boost::optional<PublicKey>
+toPublicKey(Json::Value const& v)
+{
+    if (!v.isString())
+        return boost::none;
+    auto const key = strUnHex(v.asString());
+    if (!key || !publicKeyType(makeSlice(*key)))
+        return boost::none;
+    return PublicKey(makeSlice(*key));
+}
+
+}  // namespace
+
+ListedValidator
+checkListedManifest(std::string manifest)
+{
+    auto const m = decodeManifest(makeSlice(manifest));
+    if (!m)
+        throw std::runtime_error("malformed manifest");
+    if (m->revoked())
+        throw std::runtime_error("revoked master key");
+
+    STObject st(sfGeneric);
+    SerialIter sit(makeSlice(manifest));
+    st.set(sit);
+
+    PublicKey const masterKey(m->masterKey);
+    if (!verify(st, HashPrefix::manifest, PublicKey(m->signingKey)))
+        throw std::runtime_error("bad signature");
+    if (!verify(st, HashPrefix::manifest, masterKey, sfMasterSignature))
+        throw std::runtime_error("bad master signature");
+
+    return {masterKey, std::move(manifest)};
+}
+
+std::string
+makeListBlob(
+    std::uint32_t sequence,
+    std::uint32_t expiration,
+    std::vector<ListedValidator> const& validators)
+{
+    std::string blob = "{\"sequence\":" + std::to_string(sequence) +
+        ",\"expiration\":" + std::to_string(expiration) + ",\"validators\":[";
+
+    // Sized up front: a key, a base64 manifest and the JSON around them
+    std::size_t size = blob.size() + 2;
+    for (auto const& v : validators)
+        size += 2 * v.masterKey.size() + 4 * (v.manifest.size() + 2) / 3 + 56;
+    blob.reserve(size);
+
+    for (auto const& v : validators)
+    {
+        if (&v != &validators.front())
+            blob += ',';
+        blob += "{\"validation_public_key\":\"";
+        blob += strHex(v.masterKey);
+        blob += "\",\"manifest\":\"";
+        blob += base64_encode(
+            reinterpret_cast<std::uint8_t const*>(v.manifest.data()),
+            v.manifest.size());
+        blob += "\"}";
+    }
+    blob += "]}";
+    return blob;
+}
+
+void
+writeValidatorList(
+    OutputWriter& out,
+    Slice const& blob,
+    std::string const& publisherManifest,
+    PublicKey const& publisherKey,
+    Slice const& signature)
+{
+    // Whole groups of three bytes encode without padding, so the pieces
+    // join into the encoding of the whole blob
+    std::size_t const piece = 3 * 16 * 1024;
+
+    out << "{\"blob\":\"";
+    for (std::size_t i = 0; i < blob.size(); i += piece)
+        out << base64_encode(blob.data() + i, std::min(piece, blob.size() - i));
+    out << "\",\"manifest\":\"" << publisherManifest << "\",\"public_key\":\""
+        << strHex(publisherKey) << "\",\"signature\":\"" << strHex(signature)
+        << "\",\"version\":1}\n";
+}
+
+ListVerification
+verifyValidatorList(std::string const& json, unsigned threads)
+{
+    Json::Value list;
+    if (!Json::Reader().parse(json, list) || !list.isObject())
+        throw std::runtime_error("Malformed validator list: not a JSON object");
+    for (auto const field : {"blob", "manifest", "public_key", "signature"})
+    {
+        if (!list[field].isString())
+            throw std::runtime_error(
+                std::string("Malformed validator list: no ") + field);
+    }
+    if (toUInt32(list["version"]) != 1u)
+        throw std::runtime_error("Unsupported validator list version");
+
+    ListVerification result;
+    result.publisherKey = toPublicKey(list["public_key"]);
+
+    // The blob is only trusted if the current manifest of the publisher
+    // names the key that signed it
+    boost::optional<PublicKey> signingKey;
+    try
+    {
+        auto const m =
+            checkListedManifest(base64_decode(list["manifest"].asString()));
+        auto const fields = decodeManifest(makeSlice(m.manifest));
+        result.manifestSequence = fields->sequence;
+        if (!result.publisherKey || m.masterKey != *result.publisherKey)
+            result.manifestError = "manifest of another key";
+        else
+            signingKey.emplace(fields->signingKey);
+    }
+    catch (std::exception const& e)
+    {
+        result.manifestError = e.what();
+    }
+
+    auto const blob = base64_decode(list["blob"].asString());
+    auto const signature = strUnHex(list["signature"].asString());
+    result.signatureValid = signingKey && signature &&
+        verify(*signingKey, makeSlice(blob), makeSlice(*signature));
+
+    Json::Value jBlob;
+    if (!Json::Reader().parse(blob, jBlob) || !jBlob.isObject())
+        throw std::runtime_error(
+            "Malformed validator list blob: not a JSON object");
+    auto const sequence = toUInt32(jBlob["sequence"]);
+    auto const expiration = toUInt32(jBlob["expiration"]);
+    Json::Value const& validators = jBlob["validators"];
+    if (!sequence || !expiration || !validators.isArray())
+        throw std::runtime_error(
+            "Malformed validator list blob: needs sequence, expiration and "
+            "validators");
+    result.sequence = *sequence;
+    result.expiration = *expiration;
+    result.listed = validators.size();
+
+    struct Entry
+    {
+        boost::optional<PublicKey> key;
+        std::string error;
+        bool revoked = false;
+    };
+    std::vector<Entry> entries(result.listed);
+
+    parallelFor(
+        entries.size(),
+        [&](std::size_t i) {
+            auto const& v = validators[Json::UInt(i)];
+            auto& entry = entries[i];
+
+            // parallelFor rethrows, so an entry that throws would fail the
+            // whole list instead of being reported as invalid
+            try
+            {
+                if (!v.isObject() ||
+                    !(entry.key = toPublicKey(v["validation_public_key"])))
+                {
+                    entry.error = "bad validation_public_key";
+                    return;
+                }
+                if (!v.isMember("manifest"))
+                    return;
+                if (!v["manifest"].isString())
+                {
+                    entry.error = "malformed manifest";
+                    return;
+                }
+
+                auto const manifest =
+                    base64_decode(v["manifest"].asString());
+                auto const m = decodeManifest(makeSlice(manifest));
+                if (!m)
+                    entry.error = "malformed manifest";
+                else if (!verifyManifest(manifest, *m))
+                    entry.error = "bad manifest signature";
+                else if (PublicKey(m->masterKey) != *entry.key)
+                    entry.error = "manifest of another key";
+                else
+                    entry.revoked = m->revoked();
+            }
+            catch (std::exception const&)
+            {
+                entry.error = "malformed manifest";
+            }
+        },
+        threads);
+
+    std::set<PublicKey> seen;
+    std::set<PublicKey> duplicates;
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        auto const& entry = entries[i];
+        if (!entry.error.empty())
+            result.invalid.emplace_back(i, entry.error);
+        else if (!seen.insert(*entry.key).second)
+        {
+            if (duplicates.insert(*entry.key).second)
+                result.duplicates.push_back(*entry.key);
+        }
+        else if (entry.revoked)
+            result.revoked.push_back(*entry.key);
+        else
+            result.effective.push_back(*entry.key);
+    }
+
+    return result;
+}
+
+}  // namespace xrpl
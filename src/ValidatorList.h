@@ -0,0 +1,126 @@
+#ifndef VALIDATOR_KEYS_VALIDATORLIST_H_INCLUDED
+#define VALIDATOR_KEYS_VALIDATORLIST_H_INCLUDED
+
+#include <xrpl/basics/Slice.h>
+#include <xrpl/protocol/PublicKey.h>
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xrpl {
+
+class OutputWriter;
+
+/** Seconds from the UNIX epoch to the Ripple epoch, 2000-01-01 */
+std::uint32_t const rippleEpochOffset = 946684800;
+
+/** A validator on a published list */
+struct ListedValidator
+{
+    PublicKey masterKey;
+
+    // The serialized manifest
+    std::string manifest;
+};
+
+/** Checks the manifest of a validator to be listed
+
+    The manifest must be well formed and not a revocation, and both its
+    signature and its master signature must verify.
+
+    @param manifest The serialized manifest
+
+    @throws std::runtime_error naming the first problem found
+*/
+ListedValidator
+checkListedManifest(std::string manifest);
+
+/** Returns the JSON text of a validator list blob
+
+    The validators are listed in the given order, each with its hex master
+    key and base64 manifest.
+
+    @param expiration When the list expires, in seconds since the Ripple
+                      epoch
+*/
+std::string
+makeListBlob(
+    std::uint32_t sequence,
+    std::uint32_t expiration,
+    std::vector<ListedValidator> const& validators);
+
+/** Writes a signed validator list as rippled fetches it from a publisher
+
+    The blob is base64 encoded piecewise as it is written, so no encoded
+    copy of the whole blob is held.
+
+    @param publisherManifest Base64 manifest of the publisher
+    @param signature Signature of the blob by the publisher's signing key
+*/
+void
+writeValidatorList(
+    OutputWriter& out,
+    Slice const& blob,
+    std::string const& publisherManifest,
+    PublicKey const& publisherKey,
+    Slice const& signature);
+
+/** What checking a validator list found */
+struct ListVerification
+{
+    // The publisher key the list names, if it is a valid key
+    boost::optional<PublicKey> publisherKey;
+
+    // Sequence of the publisher manifest, if it could be decoded
+    boost::optional<std::uint32_t> manifestSequence;
+
+    // Why the publisher manifest was rejected; empty if it was not
+    std::string manifestError;
+
+    // Whether the signing key of the publisher manifest signed the blob
+    bool signatureValid = false;
+
+    std::uint32_t sequence = 0;
+
+    // Seconds since the Ripple epoch
+    std::uint32_t expiration = 0;
+
+    // Number of entries in the blob
+    std::size_t listed = 0;
+
+    // The validators the list puts in effect, in list order
+    std::vector<PublicKey> effective;
+
+    // Keys listed more than once, each reported once; the first entry of a
+    // key is the one that counts
+    std::vector<PublicKey> duplicates;
+
+    // Keys whose manifest revokes them
+    std::vector<PublicKey> revoked;
+
+    // Index and problem of every entry that is not valid
+    std::vector<std::pair<std::size_t, std::string>> invalid;
+};
+
+/** Checks a validator list as fetched from a publisher
+
+    The publisher manifest and the blob signature are checked, then every
+    entry of the blob on up to `threads` threads. An entry may carry a
+    manifest; if it does, its signatures must verify and it must be the
+    manifest of the listed key.
+
+    @param threads Number of threads, 0 for one per core
+
+    @throws std::runtime_error if json is not a version 1 validator list
+            or its blob is not well formed
+*/
+ListVerification
+verifyValidatorList(std::string const& json, unsigned threads = 0);
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,298 @@
+#include <Metrics.h>
+#include <ValidatorKeysTool.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+// LCOV_EXCL_START
+static std::string
+getEnvVar(char const* name)
+{
+    std::string value;
+
+    auto const v = getenv(name);
+
+    if (v != nullptr)
+        value = v;
+
+    return value;
+}
+
+// Reads the first line of a file, or of standard input if none is given
+static std::string
+readPassword(std::string const& file)
+{
+    std::string password;
+    if (file.empty())
+    {
+        std::getline(std::cin, password);
+        return password;
+    }
+
+    std::ifstream in(file);
+    if (!in)
+        throw std::runtime_error("Cannot open password file: " + file);
+    std::getline(in, password);
+    return password;
+}
+
+static void
+printHelp(const boost::program_options::options_description& desc)
+{
+    std::cerr
+        << "validator-keys [options] <command> [<argument> ...]\n"
+        << desc << std::endl
+        << "Commands: \n"
+           "     create_keys                   Generate validator keys, or "
+           "--count key\n"
+           "                                   files in --keyfile-dir.\n"
+           "     create_token                  Generate validator token.\n"
+           "     revoke_keys                   Revoke validator keys.\n"
+           "     sign <data>                   Sign string with validator "
+           "key, or with\n"
+           "                                   every key in --keyfile-dir or "
+           "--vault.\n"
+           "     sign --file <path>            Sign a file with validator "
+           "key.\n"
+           "     show_manifest [hex|base64]    Displays the last generated "
+           "manifest\n"
+           "                                   (or, with --sequence, any "
+           "logged one)\n"
+           "     set_domain <domain>           Associate a domain with the "
+           "validator key.\n"
+           "     clear_domain                  Disassociate a domain from a "
+           "validator key.\n"
+           "     attest_domain                 Produce the attestation string "
+           "for a domain.\n"
+           "     decode_manifest [<file>...]   Decode hex or base64 manifests, "
+           "one per line,\n"
+           "                                   from files or standard "
+           "input.\n"
+           "     sign_batch --merkle [<file>]  Sign records, one per line, "
+           "with one signature\n"
+           "                                   and print an inclusion proof "
+           "for each.\n"
+           "     verify_inclusion <public_key> <proof> <record>\n"
+           "                                   Check a record's inclusion "
+           "proof (or --file).\n"
+           "     audit_configs                 Check the validator sections "
+           "of the *.cfg\n"
+           "                                   files in --configs against "
+           "the key files\n"
+           "                                   in --keys.\n"
+           "     vault_import <keyfile>...     Add key files to the "
+           "encrypted --vault.\n"
+           "     vault_list                    List the keys in the "
+           "encrypted --vault.\n"
+           "     watch                         Keep the attestations and "
+           "config fragments\n"
+           "                                   of the keys in --keyfile-dir "
+           "up to date in\n"
+           "                                   --output-dir.\n"
+           "     fleet_status                  List the keys in "
+           "--keyfile-dir.\n"
+           "     find_key <public_key>         Find the key file of a key in "
+           "--keyfile-dir.\n"
+           "     publish_list [<file>...]      Sign a validator list of "
+           "manifests, one per\n"
+           "                                   line, with --sequence and "
+           "--expiration.\n"
+           "     verify_list <list> [<publisher_key>]\n"
+           "                                   Check a published validator "
+           "list (or - for\n"
+           "                                   standard input).\n";
+}
+// LCOV_EXCL_STOP
+
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+
+    // Set up option parsing.
+    //
+    po::options_description general("General Options");
+    general.add_options()("help,h", "Display this message.")(
+        "keyfile", po::value<std::string>(), "Specify the key file.")(
+        "keyfile-dir",
+        po::value<std::string>(),
+        "Key file directory (sign, create_keys, watch, fleet_status, "
+        "find_key).")(
+        "output-dir",
+        po::value<std::string>(),
+        "Directory to write generated artifacts to (watch).")(
+        "file",
+        po::value<std::string>(),
+        "File to sign instead of a data string (sign), or the record "
+        "(verify_inclusion).")(
+        "merkle",
+        po::bool_switch(),
+        "Sign records as one Merkle batch (sign_batch).")(
+        "vault",
+        po::value<std::string>(),
+        "Encrypted key vault (vault_import, vault_list, sign).")(
+        "vault-password-file",
+        po::value<std::string>(),
+        "File holding the vault password, otherwise read from standard "
+        "input.")(
+        "count",
+        po::value<std::size_t>(),
+        "Number of key files to create (create_keys).")(
+        "format",
+        po::value<std::string>()->default_value("text"),
+        "Output format: text, jsonl or csv (decode_manifest).")(
+        "sequence",
+        po::value<std::uint32_t>(),
+        "Manifest sequence to look up in the history (show_manifest), or "
+        "the list sequence (publish_list).")(
+        "expiration",
+        po::value<unsigned>(),
+        "Days until the published list expires (publish_list).")(
+        "threads",
+        po::value<unsigned>()->default_value(0),
+        "Worker threads for batch commands, 0 for one per core.")(
+        "configs",
+        po::value<std::string>(),
+        "Directory of rippled.cfg files to audit (audit_configs).")(
+        "keys",
+        po::value<std::string>(),
+        "Directory of key files to audit against (audit_configs).")(
+        "lock-timeout",
+        po::value<unsigned>()->default_value(10000),
+        "Milliseconds to wait for the key file while another command "
+        "uses it.")(
+        "metrics",
+        po::value<std::string>(),
+        "Write latency metrics in Prometheus format to this file, or to "
+        "unix:<socket>, on exit and on SIGUSR1 (watch).")(
+        "version", "Display the build version.");
+
+    po::options_description hidden("Hidden options");
+    hidden.add_options()("command", po::value<std::string>(), "Command.")(
+        "arguments",
+        po::value<std::vector<std::string>>()->default_value(
+            std::vector<std::string>(), "empty"),
+        "Arguments.");
+    po::positional_options_description p;
+    p.add("command", 1).add("arguments", -1);
+
+    po::options_description cmdline_options;
+    cmdline_options.add(general).add(hidden);
+
+    // Parse options, if no error.
+    try
+    {
+        po::store(
+            po::command_line_parser(argc, argv)
+                .options(cmdline_options)  // Parse options.
+                .positional(p)
+                .run(),
+            vm);
+        po::notify(vm);  // Invoke option notify functions.
+    }
+    // LCOV_EXCL_START
+    catch (std::exception const&)
+    {
+        std::cerr << "validator-keys: Incorrect command line syntax."
+                  << std::endl;
+        std::cerr << "Use '--help' for a list of options." << std::endl;
+        return EXIT_FAILURE;
+    }
+    // LCOV_EXCL_STOP
+
+    // LCOV_EXCL_START
+    if (vm.count("version"))
+    {
+        std::cout << "validator-keys version " << getVersionString()
+                  << std::endl;
+        return 0;
+    }
+
+    if (vm.count("help") || !vm.count("command"))
+    {
+        printHelp(general);
+        return EXIT_SUCCESS;
+    }
+
+    std::string const homeDir = getEnvVar("HOME");
+    std::string const defaultKeyFile =
+        (homeDir.empty() ? boost::filesystem::current_path().string()
+                         : homeDir) +
+        "/.ripple/validator-keys.json";
+
+    int result = EXIT_FAILURE;
+    try
+    {
+        using namespace boost::filesystem;
+        path keyFile = vm.count("keyfile") ? vm["keyfile"].as<std::string>()
+                                           : defaultKeyFile;
+
+        CommandOptions options;
+        options.format =
+            outputFormatFromString(vm["format"].as<std::string>());
+        if (vm.count("sequence"))
+            options.sequence = vm["sequence"].as<std::uint32_t>();
+        if (vm.count("expiration"))
+            options.expiration = vm["expiration"].as<unsigned>();
+        options.threads = vm["threads"].as<unsigned>();
+        options.lockTimeout =
+            std::chrono::milliseconds(vm["lock-timeout"].as<unsigned>());
+        if (vm.count("metrics"))
+            options.metrics = vm["metrics"].as<std::string>();
+        if (vm.count("configs"))
+            options.configsDir = vm["configs"].as<std::string>();
+        if (vm.count("keys"))
+            options.keysDir = vm["keys"].as<std::string>();
+        if (vm.count("keyfile-dir"))
+            options.keyFileDir = vm["keyfile-dir"].as<std::string>();
+        if (vm.count("count"))
+            options.count = vm["count"].as<std::size_t>();
+        if (vm.count("file"))
+            options.file = vm["file"].as<std::string>();
+        options.merkle = vm["merkle"].as<bool>();
+        if (vm.count("output-dir"))
+            options.outputDir = vm["output-dir"].as<std::string>();
+        if (vm.count("vault"))
+        {
+            options.vault = vm["vault"].as<std::string>();
+            options.vaultPassword = readPassword(
+                vm.count("vault-password-file")
+                    ? vm["vault-password-file"].as<std::string>()
+                    : std::string{});
+        }
+
+        result = runCommand(
+            vm["command"].as<std::string>(),
+            vm["arguments"].as<std::vector<std::string>>(),
+            keyFile,
+            options);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << "\n";
+    }
+
+    // Failed commands are dumped too, since their failures are counted
+    if (vm.count("metrics"))
+    {
+        try
+        {
+            xrpl::dumpMetrics(vm["metrics"].as<std::string>());
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    return result;
+    // LCOV_EXCL_STOP
+}
@@ -0,0 +1,49 @@
+#include <test/AllocationCounter.h>
+
+#include <cstdlib>
+#include <new>
+
+// Replacing the global operator new counts every allocation made through
+// new, including those of the standard containers. The array and nothrow
+// forms call these by default; aligned allocations are not counted.
+
+namespace {
+
+thread_local std::size_t allocations = 0;
+
+}  // namespace
+
+namespace xrpl {
+
+namespace tests {
+
+std::size_t
+threadAllocations()
+{
+    return allocations;
+}
+
+}  // namespace tests
+
+}  // namespace xrpl
+
+void*
+operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto const p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
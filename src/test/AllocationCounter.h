@@ -0,0 +1,48 @@
+#ifndef VALIDATOR_KEYS_TEST_ALLOCATIONCOUNTER_H_INCLUDED
+#define VALIDATOR_KEYS_TEST_ALLOCATIONCOUNTER_H_INCLUDED
+
+#include <cstddef>
+
+namespace xrpl {
+
+namespace tests {
+
+/** Returns the number of heap allocations made by this thread so far
+
+    Counted by the replacement operator new in AllocationCounter.cpp.
+*/
+std::size_t
+threadAllocations();
+
+/**
+   Counts the heap allocations the current thread makes while it exists.
+
+   Used to hold operations to an allocation budget:
+
+       AllocationCounter const counter;
+       keys.domain();
+       BEAST_EXPECT(counter.count() == 0);
+ */
+class AllocationCounter
+{
+private:
+    std::size_t const start_;
+
+public:
+    AllocationCounter() : start_(threadAllocations())
+    {
+    }
+
+    /** Returns the allocations made since construction */
+    std::size_t
+    count() const
+    {
+        return threadAllocations() - start_;
+    }
+};
+
+}  // namespace tests
+
+}  // namespace xrpl
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef VALIDATOR_KEYS_TEST_BENCH_H_INCLUDED
+#define VALIDATOR_KEYS_TEST_BENCH_H_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+
+namespace xrpl {
+
+namespace tests {
+
+/** Returns the mean time one call to f takes over a number of calls */
+template <class F>
+std::chrono::nanoseconds
+measure(std::size_t iterations, F&& f)
+{
+    using namespace std::chrono;
+
+    auto const start = steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+        f();
+    auto const calls =
+        static_cast<nanoseconds::rep>(iterations ? iterations : 1);
+    return duration_cast<nanoseconds>(steady_clock::now() - start) / calls;
+}
+
+}  // namespace tests
+
+}  // namespace xrpl
+
+#endif
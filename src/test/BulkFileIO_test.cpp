@@ -0,0 +1,150 @@
+#include <BulkFileIO.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace xrpl {
+
+namespace tests {
+
+class BulkFileIO_test : public beast::unit_test::suite
+{
+private:
+    static std::string
+    readFile(boost::filesystem::path const& file)
+    {
+        std::ifstream in(file.string(), std::ios_base::binary);
+        return {
+            std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()};
+    }
+
+    void
+    testReadWrite()
+    {
+        if (!selectCase(*this, "Read and Write"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_bulk_file_io";
+        KeyFileGuard const g(*this, subdir.string());
+
+        BulkFileIO io(4);
+        log << "io_uring: " << (io.async() ? "yes" : "no") << std::endl;
+
+        // Larger than a single read
+        std::string big(200 * 1024 + 3, '\0');
+        for (std::size_t i = 0; i < big.size(); ++i)
+            big[i] = static_cast<char>(i * 7 + (i >> 10));
+
+        {
+            std::ofstream((subdir / "a").string()) << "old contents";
+        }
+        io.write(
+            {{subdir / "a", "a"},
+             {subdir / "big", big},
+             {subdir / "empty", ""},
+             {subdir / "missing" / "c", "c"}});
+        auto results = io.wait();
+        if (BEAST_EXPECT(results.size() == 4))
+        {
+            BEAST_EXPECT(results[0].error.empty());
+            BEAST_EXPECT(results[1].error.empty());
+            BEAST_EXPECT(results[2].error.empty());
+            BEAST_EXPECT(
+                results[3].error ==
+                "Failed to write file: " +
+                    (subdir / "missing" / "c").string());
+        }
+        BEAST_EXPECT(readFile(subdir / "a") == "a");
+        BEAST_EXPECT(readFile(subdir / "big") == big);
+        BEAST_EXPECT(exists(subdir / "empty"));
+
+        // No temporary file is left, and the files, key files in use, are
+        // readable by their owner only
+        BEAST_EXPECT(
+            std::distance(directory_iterator(subdir), directory_iterator()) ==
+            3);
+        for (auto const file : {"a", "big", "empty"})
+        {
+            auto const perms = status(subdir / file).permissions();
+            BEAST_EXPECT((perms & (owner_read | owner_write)) != no_perms);
+            BEAST_EXPECT((perms & (group_all | others_all)) == no_perms);
+        }
+
+        // Without replacing, an existing file is kept and reported
+        io.write({{subdir / "a", "new a"}, {subdir / "d", "d"}}, false);
+        results = io.wait();
+        if (BEAST_EXPECT(results.size() == 2))
+        {
+            BEAST_EXPECT(
+                results[0].existed &&
+                results[0].error ==
+                    "Failed to write file: " + (subdir / "a").string());
+            BEAST_EXPECT(!results[1].existed && results[1].error.empty());
+        }
+        BEAST_EXPECT(readFile(subdir / "a") == "a");
+        BEAST_EXPECT(readFile(subdir / "d") == "d");
+        BEAST_EXPECT(
+            std::distance(directory_iterator(subdir), directory_iterator()) ==
+            4);
+
+        io.read(
+            {subdir / "big",
+             subdir / "nothing",
+             subdir / "a",
+             subdir / "empty"});
+        results = io.wait();
+        if (BEAST_EXPECT(results.size() == 4))
+        {
+            BEAST_EXPECT(results[0].error.empty());
+            BEAST_EXPECT(results[0].contents == big);
+            BEAST_EXPECT(
+                results[1].error ==
+                "Failed to read file: " + (subdir / "nothing").string());
+            BEAST_EXPECT(results[1].contents.empty());
+            BEAST_EXPECT(results[2].contents == "a");
+            BEAST_EXPECT(results[3].error.empty());
+            BEAST_EXPECT(results[3].contents.empty());
+        }
+
+        // One batch at a time, of at most depth files
+        auto const misuse = [&](auto const& f) {
+            try
+            {
+                f();
+            }
+            catch (std::logic_error const&)
+            {
+                return true;
+            }
+            return false;
+        };
+        BEAST_EXPECT(misuse([&] {
+            io.read({"1", "2", "3", "4", "5"});
+        }));
+        io.read({subdir / "a"});
+        BEAST_EXPECT(misuse([&] { io.read({subdir / "a"}); }));
+        results = io.wait();
+        BEAST_EXPECT(results.size() == 1 && results[0].contents == "a");
+    }
+
+public:
+    void
+    run() override
+    {
+        testReadWrite();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BulkFileIO, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
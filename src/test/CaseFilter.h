@@ -0,0 +1,33 @@
+#ifndef VALIDATOR_KEYS_TEST_CASEFILTER_H_INCLUDED
+#define VALIDATOR_KEYS_TEST_CASEFILTER_H_INCLUDED
+
+#include <xrpl/beast/unit_test.h>
+
+#include <string>
+
+namespace xrpl {
+
+namespace tests {
+
+/** Starts the named test case, unless --unittest-case filters it out
+
+    The runner argument holds the case filter. A case is selected if the
+    filter is empty or occurs in its name.
+
+    @return true if the case should run
+*/
+inline bool
+selectCase(beast::unit_test::suite& suite, std::string const& name)
+{
+    if (name.find(suite.arg()) == std::string::npos)
+        return false;
+
+    suite.testcase(name);
+    return true;
+}
+
+}  // namespace tests
+
+}  // namespace xrpl
+
+#endif
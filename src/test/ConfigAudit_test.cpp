@@ -0,0 +1,252 @@
+#include <ConfigAudit.h>
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <fstream>
+
+namespace xrpl {
+
+namespace tests {
+
+class ConfigAudit_test : public beast::unit_test::suite
+{
+private:
+    // Writes a config with the sections wrapped like the tool prints them
+    static void
+    writeConfig(
+        boost::filesystem::path const& file,
+        std::string const& token,
+        std::string const& revocation = "")
+    {
+        auto const wrapped = [](std::string const& s) {
+            std::string out;
+            for (std::size_t i = 0; i < s.size(); i += 72)
+                out += s.substr(i, 72) + "\n";
+            return out;
+        };
+
+        create_directories(file.parent_path());
+        std::ofstream o(file.string());
+        o << "[server]\nport_rpc\n\n# validator settings\n";
+        if (!token.empty())
+            o << "[validator_token]\n" << wrapped(token) << "\n";
+        if (!revocation.empty())
+            o << "[validator_key_revocation]\r\n"
+              << wrapped(revocation) << "\n";
+        o << "[ips]\nr.ripple.com 51235\n";
+    }
+
+    void
+    testParse()
+    {
+        if (!selectCase(*this, "Parse Sections"))
+            return;
+
+        auto const none = parseValidatorSections("[server]\nport_rpc\n");
+        BEAST_EXPECT(!none.token);
+        BEAST_EXPECT(!none.revocation);
+
+        auto const sections = parseValidatorSections(
+            "[validator_token]\n"
+            "  eyJt\r\n"
+            "# a comment\n"
+            "\n"
+            "YW5p\n"
+            "[validators_file]\n"
+            "validators.txt\n"
+            "[validator_key_revocation]\n"
+            "JP////\n"
+            "9w==");
+        BEAST_EXPECT(sections.token && *sections.token == "eyJtYW5p");
+        BEAST_EXPECT(
+            sections.revocation && *sections.revocation == "JP////9w==");
+
+        auto const empty = parseValidatorSections("[validator_token]\n");
+        BEAST_EXPECT(empty.token && empty.token->empty());
+    }
+
+    void
+    testAudit()
+    {
+        if (!selectCase(*this, "Audit"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_config_audit";
+        KeyFileGuard const g(*this, subdir.string());
+        path const configs = subdir / "configs";
+        path const keysDir = subdir / "keys";
+        create_directories(keysDir);
+
+        // Up to date
+        ValidatorKeys current(KeyType::ed25519);
+        writeConfig(
+            configs / "current.cfg",
+            current.createValidatorToken()->toString());
+        current.writeToFile(keysDir / "current.json");
+
+        // The key file has moved on since the token was deployed
+        ValidatorKeys stale(KeyType::secp256k1);
+        writeConfig(
+            configs / "stale.cfg", stale.createValidatorToken()->toString());
+        stale.createValidatorToken();
+        stale.writeToFile(keysDir / "stale.json");
+
+        // Revoked, with one config still running the old token
+        ValidatorKeys revoked(KeyType::secp256k1);
+        auto const oldToken = revoked.createValidatorToken()->toString();
+        auto const revocation = revoked.revoke();
+        revoked.writeToFile(keysDir / "revoked.json");
+        writeConfig(configs / "missing_revocation.cfg", oldToken);
+        writeConfig(configs / "nested" / "revoked.cfg", "", revocation);
+
+        ValidatorKeys unknown(KeyType::ed25519);
+        writeConfig(
+            configs / "unknown.cfg",
+            unknown.createValidatorToken()->toString());
+
+        writeConfig(configs / "no_token.cfg", "");
+        writeConfig(configs / "invalid.cfg", "bm90IGEgdG9rZW4=");
+
+        // Neither configs nor key files
+        std::ofstream((configs / "notes.txt").string())
+            << "[validator_token]";
+        std::ofstream((keysDir / "broken.json").string()) << "{";
+
+        auto const audits = auditConfigs(configs, keysDir, 2);
+        if (!BEAST_EXPECT(audits.size() == 7))
+            return;
+
+        auto const check = [&](std::size_t i,
+                                std::string const& name,
+                                std::vector<std::string> const& issues) {
+            BEAST_EXPECT(audits[i].config.filename() == name);
+            BEAST_EXPECT(audits[i].issues == issues);
+        };
+
+        check(0, "current.cfg", {});
+        BEAST_EXPECT(audits[0].publicKey == current.publicKey());
+        BEAST_EXPECT(audits[0].tokenSequence == 1u);
+        BEAST_EXPECT(audits[0].keyFile == keysDir / "current.json");
+        BEAST_EXPECT(audits[0].keySequence == 1u);
+
+        check(1, "invalid.cfg", {"invalid_token"});
+        BEAST_EXPECT(!audits[1].publicKey);
+
+        check(2, "missing_revocation.cfg", {"missing_revocation"});
+        BEAST_EXPECT(audits[2].publicKey == revoked.publicKey());
+
+        check(3, "revoked.cfg", {});
+        BEAST_EXPECT(audits[3].publicKey == revoked.publicKey());
+        BEAST_EXPECT(!audits[3].tokenSequence);
+
+        check(4, "no_token.cfg", {"no_validator_token"});
+
+        check(5, "stale.cfg", {"stale_token"});
+        BEAST_EXPECT(audits[5].tokenSequence == 1u);
+        BEAST_EXPECT(audits[5].keySequence == 2u);
+
+        check(6, "unknown.cfg", {"unknown_key"});
+        BEAST_EXPECT(audits[6].publicKey == unknown.publicKey());
+        BEAST_EXPECT(audits[6].keyFile.empty());
+
+        std::string error;
+        try
+        {
+            auditConfigs(subdir / "missing", keysDir);
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(
+            error == "Not a directory: " + (subdir / "missing").string());
+    }
+
+    void
+    testMismatch()
+    {
+        if (!selectCase(*this, "Mismatched Sections"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_config_audit";
+        KeyFileGuard const g(*this, subdir.string());
+        path const configs = subdir / "configs";
+        path const keysDir = subdir / "keys";
+        create_directories(keysDir);
+
+        ValidatorKeys active(KeyType::secp256k1);
+        auto const token = active.createValidatorToken();
+        active.writeToFile(keysDir / "active.json");
+
+        // The revocation belongs to a different validator
+        ValidatorKeys other(KeyType::secp256k1);
+        writeConfig(configs / "a.cfg", token->toString(), other.revoke());
+
+        // The secret key does not belong to the manifest's signing key
+        ValidatorToken const swapped{
+            token->manifest, randomKeyPair(KeyType::secp256k1).second};
+        writeConfig(configs / "b.cfg", swapped.toString());
+
+        // A revocation for keys the key file still considers active
+        ValidatorKeys copy = active;
+        writeConfig(configs / "c.cfg", token->toString(), copy.revoke());
+
+        // secp256k1 secret keys that are not scalars on the curve, which
+        // must not stop the audit
+        std::array<std::uint8_t, 32> scalar;
+        scalar.fill(0xFF);
+        writeConfig(
+            configs / "d.cfg",
+            ValidatorToken{token->manifest, SecretKey(makeSlice(scalar))}
+                .toString());
+        scalar.fill(0);
+        writeConfig(
+            configs / "e.cfg",
+            ValidatorToken{token->manifest, SecretKey(makeSlice(scalar))}
+                .toString());
+
+        auto const audits = auditConfigs(configs, keysDir);
+        if (!BEAST_EXPECT(audits.size() == 5))
+            return;
+
+        BEAST_EXPECT(
+            audits[0].issues ==
+            std::vector<std::string>{"revocation_key_mismatch"});
+        BEAST_EXPECT(
+            audits[1].issues ==
+            std::vector<std::string>{"token_key_mismatch"});
+        BEAST_EXPECT(
+            audits[2].issues ==
+            std::vector<std::string>{"unexpected_revocation"});
+        BEAST_EXPECT(
+            audits[3].issues == std::vector<std::string>{"invalid_token"});
+        BEAST_EXPECT(
+            audits[4].issues == std::vector<std::string>{"invalid_token"});
+    }
+
+public:
+    void
+    run() override
+    {
+        testParse();
+        testAudit();
+        testMismatch();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ConfigAudit, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
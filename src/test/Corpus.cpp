@@ -0,0 +1,77 @@
+#include <AtomicFile.h>
+#include <Parallel.h>
+#include <ValidatorKeys.h>
+
+#include <test/Corpus.h>
+
+#include <xrpl/protocol/tokens.h>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace xrpl {
+
+namespace tests {
+
+void
+generateCorpus(
+    boost::filesystem::path const& dir,
+    std::size_t count,
+    std::uint64_t seed,
+    unsigned threads)
+{
+    std::array<KeyType, 2> const keyTypes{
+        {KeyType::ed25519, KeyType::secp256k1}};
+
+    auto const keysDir = dir / "keys";
+    boost::filesystem::create_directories(keysDir);
+
+    auto const width = std::to_string(count).size();
+    std::vector<std::string> manifests(count);
+    std::vector<std::string> tokens(count);
+    std::vector<std::string> signatures(count);
+
+    parallelFor(
+        count,
+        [&](std::size_t i) {
+            DeterministicEntropy entropy(seed, i);
+            ScopedEntropySource const scope(entropy);
+
+            ValidatorKeys keys(keyTypes[i % 2]);
+            if (i % 3 == 0)
+                keys.domain("example.com");
+            auto const token =
+                keys.createValidatorToken(keyTypes[(i / 2) % 2]);
+
+            auto n = std::to_string(i + 1);
+            n.insert(0, width - n.size(), '0');
+            writeFileAtomic(
+                keysDir / ("validator-keys-" + n + ".json"),
+                keys.toJson().toStyledString());
+
+            auto const record = "record-" + std::to_string(i + 1);
+            manifests[i] = token->manifest + '\n';
+            tokens[i] = token->toString() + '\n';
+            signatures[i] =
+                toBase58(TokenType::NodePublic, keys.publicKey()) + ' ' +
+                record + ' ' + keys.sign(record) + '\n';
+        },
+        threads);
+
+    auto const join = [](std::vector<std::string> const& lines) {
+        std::string s;
+        for (auto const& line : lines)
+            s += line;
+        return s;
+    };
+    writeFileAtomic(dir / "manifests.txt", join(manifests));
+    writeFileAtomic(dir / "tokens.txt", join(tokens));
+    writeFileAtomic(dir / "signatures.txt", join(signatures));
+}
+
+}  // namespace tests
+
+}  // namespace xrpl
@@ -0,0 +1,72 @@
+#ifndef VALIDATOR_KEYS_TEST_CORPUS_H_INCLUDED
+#define VALIDATOR_KEYS_TEST_CORPUS_H_INCLUDED
+
+#include <EntropySource.h>
+
+#include <xrpl/protocol/digest.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xrpl {
+
+namespace tests {
+
+/** Seeds that are the same on every run
+
+    Each seed is taken from the SHA-512Half of a number, a stream and a
+    counter. Parallel work gives every item its own stream, so the keys do
+    not depend on which thread made them.
+*/
+class DeterministicEntropy : public EntropySource
+{
+private:
+    std::uint64_t const seed_;
+    std::uint64_t const stream_;
+    std::uint64_t counter_ = 0;
+
+public:
+    explicit DeterministicEntropy(
+        std::uint64_t seed,
+        std::uint64_t stream = 0)
+        : seed_(seed), stream_(stream)
+    {
+    }
+
+    Seed
+    nextSeed() override
+    {
+        auto const h = sha512Half(seed_, stream_, counter_++);
+        return Seed(Slice(h.data(), 16));
+    }
+};
+
+/** Writes a reproducible corpus of count validators to dir
+
+    The same seed and count always give the same files, however many
+    threads make them:
+
+    - keys/validator-keys-<n>.json, key files alternating between ed25519
+      and secp256k1 master keys, every third with a domain, each with one
+      token issued
+    - manifests.txt, the base64 manifest of each token
+    - tokens.txt, each [validator_token]
+    - signatures.txt, each master public key, the record "record-<n>" and
+      its hex signature by that key
+
+    @param threads Number of threads, 0 for one per core
+*/
+void
+generateCorpus(
+    boost::filesystem::path const& dir,
+    std::size_t count,
+    std::uint64_t seed,
+    unsigned threads = 0);
+
+}  // namespace tests
+
+}  // namespace xrpl
+
+#endif
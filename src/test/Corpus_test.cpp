@@ -0,0 +1,97 @@
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+#include <test/Corpus.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/protocol/Sign.h>
+#include <xrpl/protocol/tokens.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace xrpl {
+
+namespace tests {
+
+class Corpus_test : public beast::unit_test::suite
+{
+private:
+    static std::string
+    read(boost::filesystem::path const& file)
+    {
+        std::ifstream ifs(file.string());
+        return {
+            std::istreambuf_iterator<char>(ifs),
+            std::istreambuf_iterator<char>()};
+    }
+
+    void
+    testReproducible()
+    {
+        if (!selectCase(*this, "Reproducible"))
+            return;
+
+        using namespace boost::filesystem;
+
+        KeyFileGuard const g(*this, "test_corpus");
+        generateCorpus("test_corpus/a", 5, 7, 1);
+        generateCorpus("test_corpus/b", 5, 7, 3);
+        generateCorpus("test_corpus/c", 5, 8, 1);
+
+        // However many threads made them, the files are the same
+        for (auto const file :
+             {"manifests.txt",
+              "tokens.txt",
+              "signatures.txt",
+              "keys/validator-keys-1.json",
+              "keys/validator-keys-5.json"})
+        {
+            auto const a = read(path("test_corpus/a") / file);
+            BEAST_EXPECT(!a.empty());
+            BEAST_EXPECT(a == read(path("test_corpus/b") / file));
+            BEAST_EXPECT(a != read(path("test_corpus/c") / file));
+        }
+
+        // Each signature is by the key of its key file
+        std::istringstream signatures(read("test_corpus/a/signatures.txt"));
+        std::string key, record, signature;
+        for (int i = 1; i <= 5; ++i)
+        {
+            if (!BEAST_EXPECT(signatures >> key >> record >> signature))
+                break;
+            auto const keys = ValidatorKeys::make_ValidatorKeys(
+                path("test_corpus/a/keys") /
+                ("validator-keys-" + std::to_string(i) + ".json"));
+            BEAST_EXPECT(
+                toBase58(TokenType::NodePublic, keys.publicKey()) == key);
+            BEAST_EXPECT(record == "record-" + std::to_string(i));
+            BEAST_EXPECT(keys.sequence() == 1);
+            BEAST_EXPECT((keys.domain() == "example.com") == (i % 3 == 1));
+
+            auto const sig = strUnHex(signature);
+            BEAST_EXPECT(
+                sig &&
+                verify(keys.publicKey(), makeSlice(record), makeSlice(*sig)));
+        }
+        BEAST_EXPECT(!(signatures >> key));
+    }
+
+public:
+    void
+    run() override
+    {
+        testReproducible();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Corpus, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
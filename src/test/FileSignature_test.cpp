@@ -0,0 +1,79 @@
+#include <FileSignature.h>
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/protocol/digest.h>
+
+namespace xrpl {
+
+namespace tests {
+
+class FileSignature_test : public beast::unit_test::suite
+{
+private:
+    static void
+    writeFile(boost::filesystem::path const& file, std::string const& data)
+    {
+        std::ofstream o(file.string(), std::ios_base::binary);
+        o << data;
+    }
+
+    void
+    testDigest()
+    {
+        if (!selectCase(*this, "Digest"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_file_signature";
+        KeyFileGuard const g(*this, subdir.string());
+        path const file = subdir / "artifact.bin";
+
+        std::string const prefix("VKF\0", 4);
+
+        // Empty, small, and spanning several read blocks
+        std::string big(2 * 1024 * 1024 + 17, '\0');
+        for (std::size_t i = 0; i < big.size(); ++i)
+            big[i] = static_cast<char>(i * 31 + (i >> 12));
+
+        for (auto const& data : {std::string(), std::string("abc"), big})
+        {
+            writeFile(file, data);
+            BEAST_EXPECT(
+                fileDigest(file) == sha512Half(makeSlice(prefix + data)));
+        }
+
+        // Domain separation: not the plain hash of the contents
+        BEAST_EXPECT(fileDigest(file) != sha512Half(makeSlice(big)));
+
+        std::string error;
+        try
+        {
+            fileDigest(subdir / "missing.bin");
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(
+            error ==
+            "Failed to open file: " + (subdir / "missing.bin").string());
+    }
+
+public:
+    void
+    run() override
+    {
+        testDigest();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FileSignature, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
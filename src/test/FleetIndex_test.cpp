@@ -0,0 +1,105 @@
+#include <FleetIndex.h>
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/protocol/tokens.h>
+
+#include <fstream>
+
+namespace xrpl {
+
+namespace tests {
+
+class FleetIndex_test : public beast::unit_test::suite
+{
+private:
+    void
+    testIndex()
+    {
+        if (!selectCase(*this, "Index"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_fleet_index";
+        KeyFileGuard const g(*this, subdir.string());
+
+        ValidatorKeys a(KeyType::secp256k1);
+        ValidatorKeys b(KeyType::ed25519);
+        b.domain("example.com");
+        b.createValidatorToken();
+        a.writeToFile(subdir / "a.json");
+        b.writeToFile(subdir / "b.json");
+        std::ofstream((subdir / "broken.json").string()) << "{";
+
+        auto const pk = [](ValidatorKeys const& k) {
+            return toBase58(TokenType::NodePublic, k.publicKey());
+        };
+
+        auto index = loadFleetIndex(subdir, 2);
+        BEAST_EXPECT(index.reloaded == 3);
+        BEAST_EXPECT(exists(fleetIndexFile(subdir)));
+        if (!BEAST_EXPECT(index.entries.size() == 2))
+            return;
+        BEAST_EXPECT(index.entries[0].keyFile == subdir / "a.json");
+        BEAST_EXPECT(index.entries[0].publicKey == pk(a));
+        BEAST_EXPECT(index.entries[0].keyType == KeyType::secp256k1);
+        BEAST_EXPECT(index.entries[0].sequence == 0);
+        BEAST_EXPECT(!index.entries[0].revoked);
+        BEAST_EXPECT(index.entries[1].publicKey == pk(b));
+        BEAST_EXPECT(index.entries[1].keyType == KeyType::ed25519);
+        BEAST_EXPECT(index.entries[1].sequence == 1);
+        BEAST_EXPECT(index.entries[1].domain == "example.com");
+        BEAST_EXPECT(
+            index.errors.size() == 1 &&
+            index.errors[0].path == subdir / "broken.json");
+
+        auto const found = index.find(pk(b));
+        BEAST_EXPECT(found && found->keyFile == subdir / "b.json");
+        BEAST_EXPECT(!index.find(pk(ValidatorKeys(KeyType::ed25519))));
+
+        // Unchanged key files come from the index
+        index = loadFleetIndex(subdir);
+        BEAST_EXPECT(index.reloaded == 1);
+        BEAST_EXPECT(index.entries.size() == 2);
+        BEAST_EXPECT(index.entries[1].domain == "example.com");
+
+        // Only the changed key file is parsed
+        remove(subdir / "broken.json");
+        a.revoke();
+        a.writeToFile(subdir / "a.json");
+        index = loadFleetIndex(subdir);
+        BEAST_EXPECT(index.reloaded == 1);
+        BEAST_EXPECT(index.errors.empty());
+        BEAST_EXPECT(index.entries.size() == 2 && index.entries[0].revoked);
+
+        // Removed key files are dropped
+        remove(subdir / "b.json");
+        index = loadFleetIndex(subdir);
+        BEAST_EXPECT(index.reloaded == 0);
+        BEAST_EXPECT(index.entries.size() == 1 && !index.find(pk(b)));
+
+        // An unreadable index is rebuilt
+        std::ofstream(fleetIndexFile(subdir).string()) << "not json";
+        index = loadFleetIndex(subdir);
+        BEAST_EXPECT(index.reloaded == 1);
+        BEAST_EXPECT(index.entries.size() == 1 && index.find(pk(a)));
+        BEAST_EXPECT(loadFleetIndex(subdir).reloaded == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testIndex();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FleetIndex, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
@@ -0,0 +1,172 @@
+#include <KeyFileLock.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace xrpl {
+
+namespace tests {
+
+class KeyFileLock_test : public beast::unit_test::suite
+{
+private:
+    std::string
+    lockError(
+        boost::filesystem::path const& keyFile,
+        KeyFileLock::Mode mode)
+    {
+        try
+        {
+            KeyFileLock const lock(
+                keyFile, mode, std::chrono::milliseconds(50));
+        }
+        catch (std::exception const& e)
+        {
+            return e.what();
+        }
+        return {};
+    }
+
+    void
+    testLockFile()
+    {
+        if (!selectCase(*this, "Lock File"))
+            return;
+
+        using namespace boost::filesystem;
+
+        KeyFileGuard const g(*this, "test_lock");
+        path const keyFile = "test_lock/keys/validator-keys.json";
+        BEAST_EXPECT(
+            KeyFileLock::lockFile(keyFile) ==
+            "test_lock/keys/validator-keys.json.lock");
+
+        // Reading a missing key file needs no lock file
+        BEAST_EXPECT(lockError(keyFile, KeyFileLock::shared).empty());
+        BEAST_EXPECT(!exists(KeyFileLock::lockFile(keyFile)));
+
+        // Creating one does, and its directory
+        BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive).empty());
+        BEAST_EXPECT(exists(KeyFileLock::lockFile(keyFile)));
+
+        std::ofstream(keyFile.string()) << "{}";
+        {
+            KeyFileLock const a(keyFile, KeyFileLock::shared);
+            KeyFileLock const b(keyFile, KeyFileLock::shared);
+        }
+
+        // Locks are released on destruction
+        BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive).empty());
+        BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive).empty());
+        BEAST_EXPECT(std::ifstream(keyFile.string()).get() == '{');
+
+        // Locks exclude each other within a process too, and releasing one
+        // leaves the others held
+        std::string const timeout =
+            "Timed out waiting for the lock on key file: " + keyFile.string();
+        {
+            KeyFileLock const a(keyFile, KeyFileLock::shared);
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive) == timeout);
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::shared).empty());
+            std::ifstream(KeyFileLock::lockFile(keyFile).string()).close();
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive) == timeout);
+        }
+        {
+            KeyFileLock const a(keyFile, KeyFileLock::exclusive);
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::shared) == timeout);
+        }
+        BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive).empty());
+    }
+
+    void
+    testOtherProcess()
+    {
+        if (!selectCase(*this, "Other Process"))
+            return;
+
+#ifndef _WIN32
+        using namespace boost::filesystem;
+
+        KeyFileGuard const g(*this, "test_lock_process");
+        path const keyFile = "test_lock_process/validator-keys.json";
+        std::ofstream(keyFile.string()) << "{}";
+
+        // A child process holds the lock until the pipe is closed
+        auto const hold = [&](KeyFileLock::Mode mode, auto&& check) {
+            int ready[2];
+            int release[2];
+            if (!BEAST_EXPECT(pipe(ready) == 0 && pipe(release) == 0))
+                return;
+
+            auto const pid = fork();
+            if (pid == 0)
+            {
+                close(ready[0]);
+                close(release[1]);
+                try
+                {
+                    KeyFileLock const lock(keyFile, mode);
+                    char c = 0;
+                    if (write(ready[1], &c, 1) == 1)
+                        while (read(release[0], &c, 1) > 0)
+                            ;
+                }
+                catch (std::exception const&)
+                {
+                }
+                _exit(0);
+            }
+
+            close(ready[1]);
+            close(release[0]);
+            char c;
+            if (BEAST_EXPECT(read(ready[0], &c, 1) == 1))
+                check();
+            close(release[1]);
+            close(ready[0]);
+            int status = 0;
+            waitpid(pid, &status, 0);
+        };
+
+        auto const timeout =
+            "Timed out waiting for the lock on key file: " + keyFile.string();
+
+        hold(KeyFileLock::shared, [&] {
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::shared).empty());
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive) == timeout);
+        });
+
+        hold(KeyFileLock::exclusive, [&] {
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::shared) == timeout);
+            BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive) == timeout);
+        });
+
+        BEAST_EXPECT(lockError(keyFile, KeyFileLock::exclusive).empty());
+#endif
+    }
+
+public:
+    void
+    run() override
+    {
+        testLockFile();
+        testOtherProcess();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(KeyFileLock, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
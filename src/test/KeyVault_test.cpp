@@ -0,0 +1,261 @@
+#include <KeyVault.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/json/json_reader.h>
+
+#include <fstream>
+
+namespace xrpl {
+
+namespace tests {
+
+class KeyVault_test : public beast::unit_test::suite
+{
+private:
+    // Cheap enough that the tests do not spend their time in the KDF
+    static VaultKdfParams
+    testParams()
+    {
+        VaultKdfParams params;
+        params.n = 1 << 10;
+        return params;
+    }
+
+    std::string
+    openError(boost::filesystem::path const& path, std::string const& password)
+    {
+        try
+        {
+            KeyVault::open(path, password);
+        }
+        catch (std::exception const& e)
+        {
+            return e.what();
+        }
+        return {};
+    }
+
+    static Json::Value
+    readJson(boost::filesystem::path const& path)
+    {
+        Json::Value jv;
+        std::ifstream in(path.string());
+        Json::Reader().parse(in, jv);
+        return jv;
+    }
+
+    static void
+    writeJson(boost::filesystem::path const& path, Json::Value const& jv)
+    {
+        std::ofstream o(path.string(), std::ios_base::trunc);
+        o << jv.toStyledString();
+    }
+
+    void
+    testRoundTrip()
+    {
+        if (!selectCase(*this, "Round Trip"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_vault";
+        KeyFileGuard const g(*this, subdir.string());
+        path const file = subdir / "vault.json";
+        std::string const password = "correct horse";
+
+        std::vector<ValidatorKeys> keys;
+        keys.emplace_back(KeyType::secp256k1);
+        keys.emplace_back(KeyType::ed25519);
+        keys[1].revoke();
+        keys[1].domain("example.com");
+
+        {
+            auto vault = KeyVault::create(file, password, testParams());
+            BEAST_EXPECT(vault.names().empty());
+            vault.put("b", keys[0]);
+            vault.put("a", keys[1]);
+            BEAST_EXPECT(!exists(file));
+            vault.save();
+        }
+        BEAST_EXPECT(exists(file));
+        BEAST_EXPECT(!exists(subdir / "vault.json.tmp"));
+
+        // Nothing secret is stored in the clear
+        {
+            std::ifstream in(file.string());
+            std::string const contents{
+                std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>()};
+            BEAST_EXPECT(contents.find("secret_key") == std::string::npos);
+            BEAST_EXPECT(contents.find("example.com") == std::string::npos);
+        }
+
+        auto const vault = KeyVault::open(file, password);
+        BEAST_EXPECT(vault.names() == std::vector<std::string>({"a", "b"}));
+        BEAST_EXPECT(vault.contains("a"));
+        BEAST_EXPECT(!vault.contains("c"));
+        BEAST_EXPECT(vault.get("a") == keys[1]);
+        BEAST_EXPECT(vault.get("a").revoked());
+        BEAST_EXPECT(vault.get("a").domain() == "example.com");
+        BEAST_EXPECT(vault.get("b") == keys[0]);
+
+        auto const entries = loadKeyVault(vault, 2);
+        if (BEAST_EXPECT(entries.size() == 2))
+        {
+            BEAST_EXPECT(entries[0].path == "a");
+            BEAST_EXPECT(entries[0].keys && *entries[0].keys == keys[1]);
+            BEAST_EXPECT(entries[1].path == "b");
+            BEAST_EXPECT(entries[1].keys && *entries[1].keys == keys[0]);
+        }
+
+        std::string error;
+        try
+        {
+            KeyVault::create(file, password, testParams());
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(
+            error == "Refusing to overwrite existing vault: " + file.string());
+    }
+
+    void
+    testBadVaults()
+    {
+        if (!selectCase(*this, "Bad Vaults"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_vault";
+        KeyFileGuard const g(*this, subdir.string());
+        path const file = subdir / "vault.json";
+        std::string const password = "correct horse";
+
+        {
+            auto vault = KeyVault::create(file, password, testParams());
+            vault.put("a", ValidatorKeys(KeyType::ed25519));
+            vault.put("b", ValidatorKeys(KeyType::secp256k1));
+            vault.save();
+        }
+
+        BEAST_EXPECT(
+            openError(file, "wrong horse") ==
+            "Wrong password for vault: " + file.string());
+        BEAST_EXPECT(
+            openError(subdir / "missing.json", password) ==
+            "Failed to open vault: " + (subdir / "missing.json").string());
+
+        path const other = subdir / "other.json";
+        std::ofstream(other.string()) << "{}";
+        BEAST_EXPECT(
+            openError(other, password) ==
+            "Not a key vault: " + other.string());
+
+        auto const good = readJson(file);
+
+        // Entries are bound to their names
+        {
+            auto jv = good;
+            std::swap(jv["entries"]["a"], jv["entries"]["b"]);
+            writeJson(file, jv);
+
+            auto const vault = KeyVault::open(file, password);
+            auto const entries = loadKeyVault(vault);
+            BEAST_EXPECT(entries.size() == 2);
+            for (auto const& entry : entries)
+            {
+                BEAST_EXPECT(!entry.keys);
+                BEAST_EXPECT(
+                    entry.error ==
+                    "Unable to decrypt vault entry: " + file.string() + ":" +
+                        entry.path.string());
+            }
+        }
+
+        // A changed ciphertext does not decrypt
+        {
+            auto jv = good;
+            auto ct = jv["entries"]["a"]["ciphertext"].asString();
+            ct[0] = ct[0] == '0' ? '1' : '0';
+            jv["entries"]["a"]["ciphertext"] = ct;
+            writeJson(file, jv);
+
+            auto const vault = KeyVault::open(file, password);
+            std::string error;
+            try
+            {
+                vault.get("a");
+            }
+            catch (std::exception const& e)
+            {
+                error = e.what();
+            }
+            BEAST_EXPECT(
+                error ==
+                "Unable to decrypt vault entry: " + file.string() + ":a");
+            BEAST_EXPECT(vault.get("b").keyType() == KeyType::secp256k1);
+        }
+
+        // Nor does a changed data key
+        {
+            auto jv = good;
+            auto ct = jv["data_key"]["ciphertext"].asString();
+            ct[0] = ct[0] == '0' ? '1' : '0';
+            jv["data_key"]["ciphertext"] = ct;
+            writeJson(file, jv);
+
+            BEAST_EXPECT(
+                openError(file, password) ==
+                "Wrong password for vault: " + file.string());
+        }
+
+        // Parameters that would take too much memory or time are refused
+        // before any is spent
+        for (auto const& [field, value] :
+             {std::make_pair("n", Json::UInt(1) << 30),
+              std::make_pair("r", Json::UInt(1024)),
+              std::make_pair("p", Json::UInt(1) << 20)})
+        {
+            auto jv = good;
+            jv["kdf"][field] = value;
+            writeJson(file, jv);
+
+            BEAST_EXPECT(
+                openError(file, password) ==
+                "Vault key derivation parameters are too large");
+        }
+
+        // As are those within the limits that need more memory than allowed
+        {
+            auto jv = good;
+            jv["kdf"]["n"] = Json::UInt(1) << 20;
+            jv["kdf"]["r"] = 16;
+            writeJson(file, jv);
+
+            BEAST_EXPECT(
+                openError(file, password) ==
+                "Invalid vault key derivation parameters");
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testRoundTrip();
+        testBadVaults();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(KeyVault, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
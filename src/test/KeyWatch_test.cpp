@@ -0,0 +1,150 @@
+#include <AtomicFile.h>
+#include <KeyWatch.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+
+#include <fstream>
+
+namespace xrpl {
+
+namespace tests {
+
+class KeyWatch_test : public beast::unit_test::suite
+{
+private:
+    static std::string
+    readFile(boost::filesystem::path const& file)
+    {
+        std::ifstream in(file.string(), std::ios_base::binary);
+        return {
+            std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()};
+    }
+
+    void
+    testWriteFileAtomic()
+    {
+        if (!selectCase(*this, "Write File Atomic"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_watch";
+        KeyFileGuard const g(*this, subdir.string());
+        path const file = subdir / "out" / "val.cfg";
+
+        writeFileAtomic(file, "first\n");
+        BEAST_EXPECT(readFile(file) == "first\n");
+
+        writeFileAtomic(file, std::string_view("second\0", 7), true);
+        BEAST_EXPECT(readFile(file) == std::string("second\0", 7));
+        BEAST_EXPECT(!exists(file.string() + ".tmp"));
+        BEAST_EXPECT(
+            (status(file).permissions() & (group_all | others_all)) == 0);
+    }
+
+    void
+    testWatch()
+    {
+        if (!selectCase(*this, "Watch"))
+            return;
+
+        using namespace boost::filesystem;
+        using namespace std::chrono_literals;
+
+        path const subdir = "test_key_watch";
+        KeyFileGuard const g(*this, subdir.string());
+        std::ofstream((subdir / "old.json").string()) << "{}";
+
+        KeyFileWatcher watcher(subdir);
+        BEAST_EXPECT(watcher.wait(10ms, 10ms).empty());
+
+        // Only key files are reported, once however often they change
+        std::ofstream((subdir / "notes.txt").string()) << "x";
+        std::ofstream((subdir / "b.json").string()) << "{}";
+        std::ofstream((subdir / "a.json").string()) << "{}";
+        std::ofstream((subdir / "a.json").string()) << "{ }";
+        auto changed = watcher.wait(5s);
+        BEAST_EXPECT(
+            changed ==
+            std::vector<path>({subdir / "a.json", subdir / "b.json"}));
+
+        // Atomic replacement and removal
+        writeFileAtomic(subdir / "b.json", "{}");
+        remove(subdir / "old.json");
+        changed = watcher.wait(5s);
+        BEAST_EXPECT(
+            changed ==
+            std::vector<path>({subdir / "b.json", subdir / "old.json"}));
+
+        BEAST_EXPECT(watcher.wait(10ms, 10ms).empty());
+
+        std::string error;
+        try
+        {
+            KeyFileWatcher(subdir / "missing");
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(
+            error == "Unable to watch " + (subdir / "missing").string());
+    }
+
+    void
+    testOverflow()
+    {
+        if (!selectCase(*this, "Overflow"))
+            return;
+
+#ifdef __linux__
+        using namespace boost::filesystem;
+        using namespace std::chrono_literals;
+
+        std::size_t queued = 0;
+        std::ifstream("/proc/sys/fs/inotify/max_queued_events") >> queued;
+        if (queued == 0 || queued > (1 << 20))
+        {
+            log << "inotify queue size unknown, skipped" << std::endl;
+            return;
+        }
+
+        path const subdir = "test_key_watch";
+        KeyFileGuard const g(*this, subdir.string());
+        std::ofstream((subdir / "a.json").string()) << "{}";
+        std::ofstream((subdir / "b.json").string()) << "{}";
+
+        KeyFileWatcher watcher(subdir);
+
+        // More events than the queue holds, alternating between two files
+        // so they are not merged. Once events are lost any key file may
+        // have changed, so a.json is reported as well as b.json.
+        std::ofstream((subdir / "b.json").string()) << "{ }";
+        for (std::size_t i = 0; i <= queued; ++i)
+            std::ofstream((subdir / (i % 2 ? "x.txt" : "y.txt")).string());
+        auto const changed = watcher.wait(5s);
+        BEAST_EXPECT(
+            changed ==
+            std::vector<path>({subdir / "a.json", subdir / "b.json"}));
+#endif
+    }
+
+public:
+    void
+    run() override
+    {
+        testWriteFileAtomic();
+        testWatch();
+        testOverflow();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(KeyWatch, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
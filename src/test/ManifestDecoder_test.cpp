@@ -0,0 +1,218 @@
+#include <ManifestDecoder.h>
+#include <ValidatorKeys.h>
+
+#include <test/Bench.h>
+#include <test/CaseFilter.h>
+#include <test/Corpus.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/basics/base64.h>
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/protocol/Sign.h>
+
+namespace xrpl {
+
+namespace tests {
+
+// Manifests for both key types, with and without domain, and revocations,
+// the same on every run
+static std::vector<std::string>
+makeManifests(std::size_t count)
+{
+    DeterministicEntropy entropy(count);
+    ScopedEntropySource const scope(entropy);
+
+    std::array<KeyType, 2> const keyTypes{
+        {KeyType::ed25519, KeyType::secp256k1}};
+
+    std::vector<std::string> manifests;
+    manifests.reserve(count);
+    for (std::size_t i = 0; manifests.size() < count; ++i)
+    {
+        ValidatorKeys keys(keyTypes[i % 2]);
+        if (i % 3 == 0)
+            keys.domain("example.com");
+        auto const token = keys.createValidatorToken(keyTypes[(i / 2) % 2]);
+        manifests.push_back(base64_decode(token->manifest));
+        if (i % 5 == 0 && manifests.size() < count)
+            manifests.push_back(base64_decode(keys.revoke()));
+    }
+    return manifests;
+}
+
+class ManifestDecoder_test : public beast::unit_test::suite
+{
+private:
+    void
+    testDecode()
+    {
+        if (!selectCase(*this, "Decode"))
+            return;
+
+        for (auto const& blob : makeManifests(20))
+        {
+            auto const m = decodeManifest(makeSlice(blob));
+            if (!BEAST_EXPECT(m))
+                continue;
+
+            STObject st(sfGeneric);
+            SerialIter sit(blob.data(), blob.size());
+            st.set(sit);
+
+            BEAST_EXPECT(m->sequence == st.getFieldU32(sfSequence));
+            BEAST_EXPECT(!m->version);
+            BEAST_EXPECT(m->masterKey == makeSlice(st.getFieldVL(sfPublicKey)));
+            BEAST_EXPECT(
+                m->masterSignature ==
+                makeSlice(st.getFieldVL(sfMasterSignature)));
+            BEAST_EXPECT(
+                verify(
+                    st,
+                    HashPrefix::manifest,
+                    PublicKey(m->masterKey),
+                    sfMasterSignature));
+
+            if (m->revoked())
+            {
+                BEAST_EXPECT(!st.isFieldPresent(sfSigningPubKey));
+                BEAST_EXPECT(m->signingKey.empty());
+                BEAST_EXPECT(m->signature.empty());
+                continue;
+            }
+
+            BEAST_EXPECT(
+                m->signingKey == makeSlice(st.getFieldVL(sfSigningPubKey)));
+            BEAST_EXPECT(m->signature == makeSlice(st.getFieldVL(sfSignature)));
+            if (st.isFieldPresent(sfDomain))
+                BEAST_EXPECT(m->domain == makeSlice(st.getFieldVL(sfDomain)));
+            else
+                BEAST_EXPECT(m->domain.empty());
+        }
+    }
+
+    void
+    testMalformed()
+    {
+        if (!selectCase(*this, "Malformed"))
+            return;
+
+        auto const blob = makeManifests(1).front();
+        BEAST_EXPECT(decodeManifest(makeSlice(blob)));
+
+        // Every truncation is rejected
+        for (std::size_t size = 0; size < blob.size(); ++size)
+            BEAST_EXPECT(!decodeManifest(Slice(blob.data(), size)));
+
+        // Trailing garbage
+        BEAST_EXPECT(!decodeManifest(makeSlice(blob + '\x01')));
+
+        // Duplicate sequence
+        std::string const sequence = blob.substr(0, 5);
+        BEAST_EXPECT(sequence[0] == '\x24');
+        BEAST_EXPECT(!decodeManifest(makeSlice(sequence + blob)));
+
+        // Field a manifest does not carry (sfFlags)
+        std::string const flags("\x22\0\0\0\0", 5);
+        BEAST_EXPECT(!decodeManifest(makeSlice(flags + blob)));
+
+        // Version is optional
+        std::string const version("\x10\x10\0\0", 4);
+        auto const m = decodeManifest(makeSlice(version + blob));
+        if (BEAST_EXPECT(m))
+            BEAST_EXPECT(m->version && *m->version == 0);
+
+        // Not a valid public key
+        auto corrupt = blob;
+        auto const pos = corrupt.find('\x71');
+        BEAST_EXPECT(pos == 5);
+        corrupt[pos + 2] = '\x07';
+        BEAST_EXPECT(!decodeManifest(makeSlice(corrupt)));
+    }
+
+    void
+    testUnwrap()
+    {
+        if (!selectCase(*this, "Unwrap"))
+            return;
+
+        auto const blob = makeManifests(1).front();
+        std::string out;
+
+        BEAST_EXPECT(unwrapManifest(strHex(blob), out));
+        BEAST_EXPECT(out == blob);
+
+        BEAST_EXPECT(unwrapManifest(base64_encode(blob), out));
+        BEAST_EXPECT(out == blob);
+
+        BEAST_EXPECT(!unwrapManifest("", out));
+        BEAST_EXPECT(!unwrapManifest("not a manifest", out));
+        BEAST_EXPECT(!unwrapManifest("JAAA\x01", out));
+    }
+
+public:
+    void
+    run() override
+    {
+        testDecode();
+        testMalformed();
+        testUnwrap();
+    }
+};
+
+/** Compares decodeManifest with deserializing through STObject */
+class ManifestDecoderBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        if (!selectCase(*this, "Decode throughput"))
+            return;
+
+        auto const manifests = makeManifests(2000);
+        std::size_t const rounds = 50;
+        std::uint64_t sink = 0;
+
+        auto const direct = measure(rounds, [&] {
+            for (auto const& blob : manifests)
+            {
+                auto const m = decodeManifest(makeSlice(blob));
+                sink += m->sequence + m->masterKey.size() +
+                    m->signingKey.size() + m->signature.size();
+            }
+        });
+
+        auto const stobject = measure(rounds, [&] {
+            for (auto const& blob : manifests)
+            {
+                STObject st(sfGeneric);
+                SerialIter sit(blob.data(), blob.size());
+                st.set(sit);
+                sink += st.getFieldU32(sfSequence) +
+                    st.getFieldVL(sfPublicKey).size() +
+                    (st.isFieldPresent(sfSigningPubKey)
+                         ? st.getFieldVL(sfSigningPubKey).size() +
+                             st.getFieldVL(sfSignature).size()
+                         : 0);
+            }
+        });
+
+        auto const perManifest = [&](std::chrono::nanoseconds d) {
+            return d.count() / static_cast<double>(manifests.size());
+        };
+        log << "decodeManifest: " << perManifest(direct) << " ns/manifest\n"
+            << "STObject:       " << perManifest(stobject)
+            << " ns/manifest\n"
+            << "speedup:        "
+            << stobject.count() / static_cast<double>(direct.count()) << "x"
+            << " (" << sink % 2 << ")" << std::endl;
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ManifestDecoder, keys, xrpl);
+BEAST_DEFINE_TESTSUITE_MANUAL(ManifestDecoderBench, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
@@ -0,0 +1,269 @@
+#include <ManifestHistory.h>
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/basics/base64.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace xrpl {
+
+namespace tests {
+
+class ManifestHistory_test : public beast::unit_test::suite
+{
+private:
+    void
+    testAppendAndFind()
+    {
+        if (!selectCase(*this, "Append and Find"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFile = subdir / "validator_keys.json";
+
+        ValidatorKeys keys(KeyType::ed25519);
+        ManifestHistory const history(keyFile);
+
+        {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.size() == 0);
+            BEAST_EXPECT(!reader.find(1));
+        }
+
+        std::vector<std::string> manifests;
+        for (int i = 0; i < 5; ++i)
+        {
+            auto const token = keys.createValidatorToken();
+            if (!BEAST_EXPECT(token))
+                return;
+            manifests.push_back(token->manifest);
+            history.append(
+                keys.publicKey(), keys.sequence(), makeSlice(keys.manifest()));
+        }
+        auto const revocation = keys.revoke();
+        history.append(
+            keys.publicKey(),
+            std::numeric_limits<std::uint32_t>::max(),
+            makeSlice(keys.manifest()));
+
+        auto check = [&]() {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.size() == manifests.size() + 1);
+            BEAST_EXPECT(
+                reader.masterKey() && *reader.masterKey() == keys.publicKey());
+            for (std::uint32_t seq = 1; seq <= manifests.size(); ++seq)
+            {
+                auto const m = reader.find(seq);
+                if (BEAST_EXPECT(m))
+                    BEAST_EXPECT(
+                        base64_encode(m->data(), m->size()) ==
+                        manifests[seq - 1]);
+            }
+            auto const m =
+                reader.find(std::numeric_limits<std::uint32_t>::max());
+            if (BEAST_EXPECT(m))
+                BEAST_EXPECT(base64_encode(m->data(), m->size()) == revocation);
+            BEAST_EXPECT(!reader.find(0));
+            BEAST_EXPECT(!reader.find(manifests.size() + 1));
+        };
+
+        check();
+
+        // A lost index is rebuilt from the log on the next append
+        remove(history.indexPath());
+        history.append(
+            keys.publicKey(),
+            std::numeric_limits<std::uint32_t>::max(),
+            makeSlice(keys.manifest()));
+        {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.size() == manifests.size() + 2);
+        }
+
+        // A record cut short in the log is not visible
+        {
+            std::ofstream o(
+                history.indexPath().string(),
+                std::ios::binary | std::ios::app);
+            std::array<char, ManifestHistory::indexEntrySize> junk{};
+            junk[0] = 42;
+            junk[4] = 100;
+            junk[15] = 0x7F;
+            o.write(junk.data(), junk.size());
+        }
+        {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.size() == manifests.size() + 2);
+            BEAST_EXPECT(!reader.find(42));
+        }
+
+        // An entry that points outside the log is refused, even where the
+        // offset and length overflow when added
+        {
+            std::fstream f(
+                history.indexPath().string(),
+                std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(
+                ManifestHistory::indexHeaderSize +
+                2 * ManifestHistory::indexEntrySize + 8);
+            std::array<char, 8> offset;
+            offset.fill('\xFF');
+            offset[0] = '\xF0';
+            f.write(offset.data(), offset.size());
+        }
+        {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.find(2));
+            std::string error;
+            try
+            {
+                reader.find(3);
+            }
+            catch (std::runtime_error const& e)
+            {
+                error = e.what();
+            }
+            BEAST_EXPECT(
+                error ==
+                "Corrupt manifest history: " + history.logPath().string());
+        }
+    }
+
+    void
+    testWrongMasterKey()
+    {
+        if (!selectCase(*this, "Wrong Master Key"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFile = subdir / "validator_keys.json";
+
+        ValidatorKeys keys(KeyType::ed25519);
+        ValidatorKeys other(KeyType::secp256k1);
+        keys.createValidatorToken();
+        other.createValidatorToken();
+
+        ManifestHistory const history(keyFile);
+        history.append(keys.publicKey(), 1, makeSlice(keys.manifest()));
+
+        std::string const expectedError = "Manifest history " +
+            history.logPath().string() + " belongs to a different master key";
+        std::string error;
+        try
+        {
+            history.append(other.publicKey(), 1, makeSlice(other.manifest()));
+        }
+        catch (std::runtime_error& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(error == expectedError);
+
+        ManifestHistoryReader const reader(keyFile);
+        BEAST_EXPECT(reader.size() == 1);
+    }
+
+    void
+    testInterruptedAppend()
+    {
+        if (!selectCase(*this, "Interrupted Append"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFile = subdir / "validator_keys.json";
+
+        ValidatorKeys keys(KeyType::ed25519);
+        keys.createValidatorToken();
+        auto const manifest = makeSlice(keys.manifest());
+
+        ManifestHistory const history(keyFile);
+        history.append(keys.publicKey(), 1, manifest);
+
+        auto const read = [](path const& file) {
+            std::ifstream in(file.string(), std::ios::binary);
+            return std::string(
+                std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>{});
+        };
+        auto const write = [](path const& file, std::string const& data) {
+            std::ofstream(file.string(), std::ios::binary | std::ios::trunc)
+                << data;
+        };
+
+        // The record of sequence 2 made it into the log but not the index
+        auto const index = read(history.indexPath());
+        history.append(keys.publicKey(), 2, manifest);
+        write(history.indexPath(), index);
+        {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.size() == 1);
+        }
+
+        // The log ends in part of a record
+        {
+            std::ofstream o(
+                history.logPath().string(), std::ios::binary | std::ios::app);
+            o.write("\x03\0\0\0\xFF\0\0\0abc", 11);
+        }
+
+        // The next append catches the index up and drops the partial record
+        history.append(keys.publicKey(), 3, manifest);
+        {
+            ManifestHistoryReader const reader(keyFile);
+            BEAST_EXPECT(reader.size() == 3);
+            for (std::uint32_t seq = 1; seq <= 3; ++seq)
+            {
+                auto const m = reader.find(seq);
+                BEAST_EXPECT(m && *m == manifest);
+            }
+        }
+
+        // A header whose key is not a public key is corrupt
+        auto log = read(history.logPath());
+        log[9] = 0;
+        write(history.logPath(), log);
+        {
+            ManifestHistoryReader const reader(keyFile);
+            std::string error;
+            try
+            {
+                reader.masterKey();
+            }
+            catch (std::runtime_error const& e)
+            {
+                error = e.what();
+            }
+            BEAST_EXPECT(
+                error ==
+                "Corrupt manifest history: " + history.logPath().string());
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testAppendAndFind();
+        testWrongMasterKey();
+        testInterruptedAppend();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ManifestHistory, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
@@ -0,0 +1,173 @@
+#include <MerkleBatch.h>
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/beast/unit_test.h>
+
+namespace xrpl {
+
+namespace tests {
+
+class MerkleBatch_test : public beast::unit_test::suite
+{
+private:
+    static std::vector<std::string>
+    makeRecords(std::size_t count)
+    {
+        std::vector<std::string> records;
+        for (std::size_t i = 0; i < count; ++i)
+            records.push_back("record " + std::to_string(i));
+        return records;
+    }
+
+    static std::vector<uint256>
+    makeLeaves(std::vector<std::string> const& records)
+    {
+        std::vector<uint256> leaves;
+        for (auto const& r : records)
+            leaves.push_back(merkleLeaf(makeSlice(r)));
+        return leaves;
+    }
+
+    void
+    testTree()
+    {
+        if (!selectCase(*this, "Tree"))
+            return;
+
+        for (std::size_t count = 1; count <= 33; ++count)
+        {
+            auto const leaves = makeLeaves(makeRecords(count));
+            MerkleTree const tree(leaves, 2);
+            BEAST_EXPECT(tree.size() == count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto const path = tree.path(i);
+                BEAST_EXPECT(
+                    merkleRootFromPath(leaves[i], i, count, path) ==
+                    tree.root());
+
+                // The leaf only fits its own position
+                if (count > 1)
+                    BEAST_EXPECT(
+                        merkleRootFromPath(
+                            leaves[i], (i + 1) % count, count, path) !=
+                        tree.root());
+
+                auto longer = path;
+                longer.push_back(leaves[i]);
+                BEAST_EXPECT(
+                    !merkleRootFromPath(leaves[i], i, count, longer));
+            }
+            BEAST_EXPECT(!merkleRootFromPath(leaves[0], count, count, {}));
+        }
+
+        // An odd node out is carried up, not paired with itself
+        auto const leaves = makeLeaves(makeRecords(3));
+        MerkleTree const three(leaves);
+        MerkleTree const pair({leaves[0], leaves[1]});
+        MerkleTree const top({pair.root(), leaves[2]});
+        BEAST_EXPECT(three.root() == top.root());
+
+        MerkleTree const four({leaves[0], leaves[1], leaves[2], leaves[2]});
+        BEAST_EXPECT(four.root() != three.root());
+
+        // A single record is its own root
+        MerkleTree const one({leaves[0]});
+        BEAST_EXPECT(one.root() == leaves[0]);
+        BEAST_EXPECT(one.path(0).empty());
+
+        std::string error;
+        try
+        {
+            MerkleTree const empty(std::vector<uint256>{});
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(error == "No records to sign");
+    }
+
+    void
+    testProof()
+    {
+        if (!selectCase(*this, "Proof"))
+            return;
+
+        auto const records = makeRecords(11);
+        MerkleTree const tree(makeLeaves(records));
+
+        for (auto const keyType : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            ValidatorKeys const keys(keyType);
+            auto const signature = strUnHex(
+                keys.signDigest(merkleRootDigest(tree.root(), tree.size())));
+
+            for (std::size_t i = 0; i < records.size(); ++i)
+            {
+                InclusionProof proof;
+                proof.count = tree.size();
+                proof.index = i;
+                proof.path = tree.path(i);
+                proof.signature = Buffer(signature->data(), signature->size());
+
+                auto const decoded = InclusionProof::decode(proof.encode());
+                if (!BEAST_EXPECT(decoded))
+                    continue;
+                BEAST_EXPECT(decoded->count == proof.count);
+                BEAST_EXPECT(decoded->index == i);
+                BEAST_EXPECT(decoded->path == proof.path);
+                BEAST_EXPECT(decoded->signature == proof.signature);
+
+                BEAST_EXPECT(verifyInclusion(
+                    *decoded, keys.publicKey(), makeSlice(records[i])));
+                BEAST_EXPECT(!verifyInclusion(
+                    *decoded,
+                    keys.publicKey(),
+                    makeSlice(records[(i + 1) % records.size()])));
+                BEAST_EXPECT(!verifyInclusion(
+                    *decoded,
+                    ValidatorKeys(keyType).publicKey(),
+                    makeSlice(records[i])));
+
+                // The signature covers the batch size
+                auto shrunk = *decoded;
+                shrunk.count = i + 1;
+                shrunk.path = MerkleTree(
+                                  makeLeaves(std::vector<std::string>(
+                                      records.begin(),
+                                      records.begin() + i + 1)))
+                                  .path(i);
+                BEAST_EXPECT(!verifyInclusion(
+                    shrunk, keys.publicKey(), makeSlice(records[i])));
+            }
+        }
+
+        BEAST_EXPECT(!InclusionProof::decode(""));
+        BEAST_EXPECT(!InclusionProof::decode("not a proof"));
+
+        // No signature
+        InclusionProof proof;
+        proof.count = 2;
+        proof.path.resize(1);
+        BEAST_EXPECT(!InclusionProof::decode(proof.encode()));
+    }
+
+public:
+    void
+    run() override
+    {
+        testTree();
+        testProof();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MerkleBatch, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
@@ -0,0 +1,236 @@
+#include <Metrics.h>
+#include <ValidatorKeys.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace xrpl {
+
+namespace tests {
+
+class Metrics_test : public beast::unit_test::suite
+{
+private:
+    static std::uint64_t
+    count(Operation op)
+    {
+        return metrics().latency(op).snapshot().count;
+    }
+
+    void
+    testBuckets()
+    {
+        if (!selectCase(*this, "Buckets"))
+            return;
+
+        using H = LatencyHistogram;
+
+        // Every value lies in the bucket just above the previous one's
+        // bound, and the bound is within 12.5% of it
+        bool ordered = true;
+        bool close = true;
+        auto const check = [&](std::uint64_t v) {
+            auto const i = H::bucketIndex(v);
+            ordered = ordered && H::bucketUpperBound(i) >= v &&
+                (i == 0 || H::bucketUpperBound(i - 1) < v);
+            close = close && H::bucketUpperBound(i) - v <= v / 8;
+        };
+        for (std::uint64_t v = 0; v < 100000; ++v)
+            check(v);
+        for (unsigned bit = 17; bit < H::maxBits; ++bit)
+        {
+            check((std::uint64_t(1) << bit) - 1);
+            check(std::uint64_t(1) << bit);
+            check((std::uint64_t(3) << (bit - 1)) + 1);
+        }
+        BEAST_EXPECT(ordered);
+        BEAST_EXPECT(close);
+
+        BEAST_EXPECT(H::bucketIndex(7) == 7);
+        BEAST_EXPECT(H::bucketIndex(8) == 8);
+        BEAST_EXPECT(H::bucketIndex(16) == 16 && H::bucketIndex(17) == 16);
+        BEAST_EXPECT(H::bucketUpperBound(16) == 17);
+        auto const tooLarge = std::uint64_t(1) << H::maxBits;
+        BEAST_EXPECT(H::bucketIndex(tooLarge - 1) == H::bucketCount - 1);
+        BEAST_EXPECT(H::bucketUpperBound(H::bucketCount - 1) == tooLarge - 1);
+        BEAST_EXPECT(H::bucketIndex(tooLarge) == H::bucketCount);
+        BEAST_EXPECT(H::bucketIndex(~std::uint64_t(0)) == H::bucketCount);
+
+        H h;
+        h.record(5);
+        h.record(1000);
+        h.record(1001);
+        auto const s = h.snapshot();
+        BEAST_EXPECT(s.count == 3 && s.sum == 2006);
+        BEAST_EXPECT(
+            s.buckets ==
+            (std::vector<std::pair<std::uint64_t, std::uint64_t>>{
+                {5, 1}, {H::bucketUpperBound(H::bucketIndex(1000)), 2}}));
+
+        // Latencies too large for any bucket are only in the count and sum
+        H large;
+        large.record(5);
+        large.record(tooLarge);
+        auto const l = large.snapshot();
+        BEAST_EXPECT(l.count == 2 && l.sum == tooLarge + 5);
+        BEAST_EXPECT(
+            l.buckets ==
+            (std::vector<std::pair<std::uint64_t, std::uint64_t>>{{5, 1}}));
+    }
+
+    void
+    testTimers()
+    {
+        if (!selectCase(*this, "Timers"))
+            return;
+
+        auto const signs = count(Operation::sign);
+        auto const tokens = count(Operation::createToken);
+        auto const revokes = count(Operation::revoke);
+        auto const loads = count(Operation::loadKeys);
+        auto const failedLoads = metrics().failures(Operation::loadKeys);
+        auto const writes = count(Operation::writeKeys);
+
+        // Signing a payload with an ed25519 key signs its data, which is
+        // counted once
+        ValidatorKeys keys(KeyType::ed25519);
+        keys.sign(SigningPayload("data"));
+        keys.sign("data");
+        BEAST_EXPECT(count(Operation::sign) == signs + 2);
+
+        keys.createValidatorToken();
+        keys.revoke();
+        BEAST_EXPECT(count(Operation::createToken) == tokens + 1);
+        BEAST_EXPECT(count(Operation::revoke) == revokes + 1);
+
+        KeyFileGuard const g(*this, "test_metrics");
+        boost::filesystem::path const keyFile = "test_metrics/keys.json";
+        keys.writeToFile(keyFile);
+        ValidatorKeys::make_ValidatorKeys(keyFile);
+        BEAST_EXPECT(count(Operation::writeKeys) == writes + 1);
+        BEAST_EXPECT(count(Operation::loadKeys) == loads + 1);
+        BEAST_EXPECT(metrics().failures(Operation::loadKeys) == failedLoads);
+
+        try
+        {
+            ValidatorKeys::make_ValidatorKeys("test_metrics/missing.json");
+            fail();
+        }
+        catch (std::runtime_error const&)
+        {
+        }
+        BEAST_EXPECT(count(Operation::loadKeys) == loads + 2);
+        BEAST_EXPECT(
+            metrics().failures(Operation::loadKeys) == failedLoads + 1);
+    }
+
+    void
+    testPrometheus()
+    {
+        if (!selectCase(*this, "Prometheus"))
+            return;
+
+        ValidatorKeys(KeyType::secp256k1).sign("data");
+
+        auto const text = metrics().prometheus();
+        auto const has = [&](std::string const& line) {
+            return text.find(line + "\n") != std::string::npos;
+        };
+        std::string const latency = "validator_keys_operation_duration_seconds";
+        auto const signs = std::to_string(count(Operation::sign));
+
+        BEAST_EXPECT(has("# TYPE " + latency + " histogram"));
+        BEAST_EXPECT(
+            has(latency + "_bucket{operation=\"sign\",le=\"+Inf\"} " + signs));
+        BEAST_EXPECT(has(latency + "_count{operation=\"sign\"} " + signs));
+        BEAST_EXPECT(
+            has("validator_keys_operations_total{operation=\"sign\"} " +
+                signs));
+        BEAST_EXPECT(
+            has("validator_keys_operation_failures_total"
+                "{operation=\"sign\"} 0"));
+        BEAST_EXPECT(
+            has(latency + "_count{operation=\"write_keys\"} " +
+                std::to_string(count(Operation::writeKeys))));
+
+        // Bucket bounds are in seconds
+        BEAST_EXPECT(
+            text.find(latency + "_bucket{operation=\"sign\",le=\"0.") !=
+            std::string::npos);
+
+        KeyFileGuard const g(*this, "test_metrics_dump");
+        dumpMetrics("test_metrics_dump/metrics.prom");
+        std::ifstream ifs("test_metrics_dump/metrics.prom");
+        std::string const dumped{
+            std::istreambuf_iterator<char>(ifs),
+            std::istreambuf_iterator<char>()};
+        BEAST_EXPECT(dumped.find("# TYPE " + latency) == 0);
+
+#ifndef _WIN32
+        // The socket buffers the metrics until they are read
+        std::string const socketPath = "test_metrics_dump/metrics.sock";
+        int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, socketPath.c_str());
+        if (!BEAST_EXPECT(
+                fd >= 0 &&
+                ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+                    0 &&
+                ::listen(fd, 1) == 0))
+            return;
+
+        dumpMetrics("unix:" + socketPath);
+        int const conn = ::accept(fd, nullptr, nullptr);
+        std::string received;
+        char buffer[4096];
+        for (ssize_t n; (n = ::read(conn, buffer, sizeof(buffer))) > 0;)
+            received.append(buffer, n);
+        ::close(conn);
+        ::close(fd);
+        BEAST_EXPECT(received.find("# TYPE " + latency) == 0);
+
+        try
+        {
+            dumpMetrics("unix:test_metrics_dump/none.sock");
+            fail();
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                e.what() ==
+                std::string("Cannot write metrics to socket: "
+                            "test_metrics_dump/none.sock"));
+        }
+#endif
+    }
+
+public:
+    void
+    run() override
+    {
+        testBuckets();
+        testTimers();
+        testPrometheus();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Metrics, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
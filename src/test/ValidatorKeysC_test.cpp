@@ -0,0 +1,299 @@
+#include <ValidatorKeys.h>
+#include <ValidatorKeysC.h>
+#include <ValidatorKeysTool.h>
+
+#include <test/CaseFilter.h>
+#include <test/KeyFileGuard.h>
+
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/json/json_reader.h>
+#include <xrpl/protocol/tokens.h>
+
+#include <array>
+#include <string>
+
+namespace xrpl {
+
+namespace tests {
+
+class ValidatorKeysC_test : public beast::unit_test::suite
+{
+private:
+    // Returns the output of a call that fills a buffer, or "" on failure
+    template <class F>
+    std::string
+    fill(F&& f)
+    {
+        std::array<char, 4096> buffer;
+        std::size_t length = 0;
+        if (!BEAST_EXPECT(f(buffer.data(), buffer.size(), &length) == VK_OK))
+            return {};
+        BEAST_EXPECT(buffer[length] == '\0');
+        return std::string(buffer.data(), length);
+    }
+
+    // Returns the keys as the library sees them
+    ValidatorKeys
+    toKeys(vk_keys const* keys)
+    {
+        auto const json = fill([&](char* b, std::size_t s, std::size_t* l) {
+            return vk_keys_serialize(keys, b, s, l);
+        });
+        Json::Value jv;
+        Json::Reader().parse(json, jv);
+        return ValidatorKeys::make_ValidatorKeys(jv, "test");
+    }
+
+    void
+    testKeys()
+    {
+        if (!selectCase(*this, "Keys"))
+            return;
+
+        BEAST_EXPECT(vk_version() == getVersionString());
+
+        for (auto const type : {VK_KEY_TYPE_SECP256K1, VK_KEY_TYPE_ED25519})
+        {
+            vk_keys* keys = nullptr;
+            BEAST_EXPECT(vk_keys_create(type, &keys) == VK_OK);
+            if (!BEAST_EXPECT(keys))
+                continue;
+
+            auto const expected = toKeys(keys);
+            BEAST_EXPECT(
+                expected.keyType() ==
+                (type == VK_KEY_TYPE_ED25519 ? KeyType::ed25519
+                                             : KeyType::secp256k1));
+            BEAST_EXPECT(
+                fill([&](char* b, std::size_t s, std::size_t* l) {
+                    return vk_keys_public_key(keys, b, s, l);
+                }) == toBase58(TokenType::NodePublic, expected.publicKey()));
+            BEAST_EXPECT(vk_keys_sequence(keys) == 0);
+            BEAST_EXPECT(vk_keys_revoked(keys) == 0);
+
+            // Parsed and loaded keys are the same keys
+            auto const json = fill([&](char* b, std::size_t s, std::size_t* l) {
+                return vk_keys_serialize(keys, b, s, l);
+            });
+            vk_keys* parsed = nullptr;
+            BEAST_EXPECT(
+                vk_keys_parse(json.data(), json.size(), &parsed) == VK_OK);
+            BEAST_EXPECT(parsed && toKeys(parsed) == expected);
+            vk_keys_free(parsed);
+
+            KeyFileGuard const g(*this, "test_c_api");
+            std::string const file = "test_c_api/keys.json";
+            BEAST_EXPECT(vk_keys_save(keys, file.c_str()) == VK_OK);
+            vk_keys* loaded = nullptr;
+            BEAST_EXPECT(vk_keys_load(file.c_str(), &loaded) == VK_OK);
+            BEAST_EXPECT(loaded && toKeys(loaded) == expected);
+            vk_keys_free(loaded);
+
+            vk_keys_free(keys);
+        }
+    }
+
+    void
+    testOperations()
+    {
+        if (!selectCase(*this, "Operations"))
+            return;
+
+        vk_keys* keys = nullptr;
+        BEAST_EXPECT(vk_keys_create(VK_KEY_TYPE_ED25519, &keys) == VK_OK);
+        if (!BEAST_EXPECT(keys))
+            return;
+
+        std::string const data = "data to sign";
+        BEAST_EXPECT(
+            fill([&](char* b, std::size_t s, std::size_t* l) {
+                return vk_keys_sign(keys, data.data(), data.size(), b, s, l);
+            }) == toKeys(keys).sign(data));
+
+        // Tokens advance the sequence and record the manifest
+        auto const token = fill([&](char* b, std::size_t s, std::size_t* l) {
+            return vk_keys_create_token(keys, b, s, l);
+        });
+        BEAST_EXPECT(!token.empty());
+        BEAST_EXPECT(vk_keys_sequence(keys) == 1);
+        BEAST_EXPECT(!toKeys(keys).manifest().empty());
+
+        // Attestation needs a domain
+        std::size_t length = 0;
+        std::array<char, 512> buffer;
+        BEAST_EXPECT(
+            vk_keys_attest(keys, buffer.data(), buffer.size(), &length) ==
+            VK_ERROR);
+        BEAST_EXPECT(vk_last_error() == std::string("The keys have no domain"));
+
+        std::string const domain = "example.com";
+        BEAST_EXPECT(
+            vk_keys_set_domain(keys, domain.data(), domain.size()) == VK_OK);
+        BEAST_EXPECT(toKeys(keys).domain() == domain);
+        BEAST_EXPECT(
+            fill([&](char* b, std::size_t s, std::size_t* l) {
+                return vk_keys_attest(keys, b, s, l);
+            }) ==
+            toKeys(keys).sign(
+                "[domain-attestation-blob:" + domain + ":" +
+                toBase58(TokenType::NodePublic, toKeys(keys).publicKey()) +
+                "]"));
+
+        std::string const bad = "bad";
+        BEAST_EXPECT(
+            vk_keys_set_domain(keys, bad.data(), bad.size()) == VK_ERROR);
+        BEAST_EXPECT(toKeys(keys).domain() == domain);
+
+        // Revoked keys make no tokens and take no domain
+        BEAST_EXPECT(!fill([&](char* b, std::size_t s, std::size_t* l) {
+                          return vk_keys_revoke(keys, b, s, l);
+                      }).empty());
+        BEAST_EXPECT(vk_keys_revoked(keys) == 1);
+        BEAST_EXPECT(
+            vk_keys_create_token(
+                keys, buffer.data(), buffer.size(), &length) == VK_REVOKED);
+        BEAST_EXPECT(vk_keys_set_domain(keys, nullptr, 0) == VK_REVOKED);
+        BEAST_EXPECT(
+            vk_keys_attest(keys, buffer.data(), buffer.size(), &length) ==
+            VK_REVOKED);
+
+        vk_keys_free(keys);
+    }
+
+    void
+    testBuffers()
+    {
+        if (!selectCase(*this, "Buffers"))
+            return;
+
+        vk_keys* keys = nullptr;
+        BEAST_EXPECT(vk_keys_create(VK_KEY_TYPE_SECP256K1, &keys) == VK_OK);
+        if (!BEAST_EXPECT(keys))
+            return;
+
+        // A short buffer reports the length needed and changes nothing
+        std::array<char, 8> small;
+        small.fill('x');
+        std::size_t length = 0;
+        BEAST_EXPECT(
+            vk_keys_create_token(keys, small.data(), small.size(), &length) ==
+            VK_BUFFER_TOO_SMALL);
+        BEAST_EXPECT(length > small.size());
+        BEAST_EXPECT(small[0] == 'x');
+        BEAST_EXPECT(vk_keys_sequence(keys) == 0);
+
+        // A retry sized from the reported length gets the same token, even
+        // though the length of a fresh secp256k1 token varies
+        for (std::uint32_t sequence = 1; sequence <= 20; ++sequence)
+        {
+            std::size_t needed = 0;
+            BEAST_EXPECT(
+                vk_keys_create_token(keys, nullptr, 0, &needed) ==
+                VK_BUFFER_TOO_SMALL);
+            std::string token(needed + 1, '\0');
+            BEAST_EXPECT(
+                vk_keys_create_token(
+                    keys, token.data(), token.size(), &length) == VK_OK);
+            BEAST_EXPECT(length == needed);
+            BEAST_EXPECT(vk_keys_sequence(keys) == sequence);
+        }
+
+        BEAST_EXPECT(
+            vk_keys_revoke(keys, small.data(), small.size(), &length) ==
+            VK_BUFFER_TOO_SMALL);
+        BEAST_EXPECT(vk_keys_revoked(keys) == 0);
+
+        // The terminator needs room too
+        auto const key = fill([&](char* b, std::size_t s, std::size_t* l) {
+            return vk_keys_public_key(keys, b, s, l);
+        });
+        std::string exact(key.size(), '\0');
+        BEAST_EXPECT(
+            vk_keys_public_key(keys, exact.data(), exact.size(), &length) ==
+            VK_BUFFER_TOO_SMALL);
+        BEAST_EXPECT(length == key.size());
+
+        // Sizing calls may pass no buffer
+        BEAST_EXPECT(
+            vk_keys_public_key(keys, nullptr, 0, &length) ==
+            VK_BUFFER_TOO_SMALL);
+        BEAST_EXPECT(length == key.size());
+
+        // The metrics are sized the same way, and count the signature made
+        // through the library
+        vk_keys_sign(keys, "data", 4, small.data(), small.size(), &length);
+        BEAST_EXPECT(vk_metrics(nullptr, 0, &length) == VK_BUFFER_TOO_SMALL);
+        std::string metrics(length + 1, '\0');
+        BEAST_EXPECT(
+            vk_metrics(metrics.data(), metrics.size(), &length) == VK_OK);
+        metrics.resize(length);
+        BEAST_EXPECT(
+            metrics.find("validator_keys_operations_total"
+                         "{operation=\"sign\"} ") != std::string::npos);
+        BEAST_EXPECT(
+            metrics.find("validator_keys_operations_total"
+                         "{operation=\"sign\"} 0\n") == std::string::npos);
+
+        vk_keys_free(keys);
+    }
+
+    void
+    testErrors()
+    {
+        if (!selectCase(*this, "Errors"))
+            return;
+
+        vk_keys* keys = nullptr;
+        std::size_t length = 0;
+        std::array<char, 64> buffer;
+
+        BEAST_EXPECT(
+            vk_keys_create(static_cast<vk_key_type>(7), &keys) ==
+            VK_INVALID_ARGUMENT);
+        BEAST_EXPECT(
+            vk_keys_create(VK_KEY_TYPE_ED25519, nullptr) ==
+            VK_INVALID_ARGUMENT);
+        BEAST_EXPECT(vk_keys_load(nullptr, &keys) == VK_INVALID_ARGUMENT);
+        BEAST_EXPECT(
+            vk_keys_sign(
+                nullptr, "", 0, buffer.data(), buffer.size(), &length) ==
+            VK_INVALID_ARGUMENT);
+        BEAST_EXPECT(vk_keys_sequence(nullptr) == 0);
+        vk_keys_free(nullptr);
+
+        std::string const file = "test_c_api_missing.json";
+        BEAST_EXPECT(vk_keys_load(file.c_str(), &keys) == VK_ERROR);
+        BEAST_EXPECT(vk_last_error() == "Failed to open key file: " + file);
+        BEAST_EXPECT(keys == nullptr);
+
+        std::string const json = "{\"key_type\": \"ed25519\"}";
+        BEAST_EXPECT(
+            vk_keys_parse(json.data(), json.size(), &keys) == VK_ERROR);
+        BEAST_EXPECT(
+            vk_last_error() ==
+            std::string(
+                "Key file '<memory>' is missing \"secret_key\" field"));
+
+        std::string const garbage = "{";
+        BEAST_EXPECT(
+            vk_keys_parse(garbage.data(), garbage.size(), &keys) == VK_ERROR);
+        BEAST_EXPECT(
+            vk_last_error() == std::string("Unable to parse json key file"));
+    }
+
+public:
+    void
+    run() override
+    {
+        testKeys();
+        testOperations();
+        testBuffers();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ValidatorKeysC, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
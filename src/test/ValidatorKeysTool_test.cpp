@@ -1,8 +1,16 @@
+#include <FileSignature.h>
+#include <KeyVault.h>
+#include <ManifestDecoder.h>
 #include <ValidatorKeys.h>
 #include <ValidatorKeysTool.h>
+#include <ValidatorList.h>
 
+#include <test/CaseFilter.h>
 #include <test/KeyFileGuard.h>
 
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/basics/base64.h>
+#include <xrpl/json/json_reader.h>
 #include <xrpl/protocol/SecretKey.h>
 
 namespace xrpl {
@@ -33,7 +41,8 @@ private:
     void
     testCreateKeyFile()
     {
-        testcase("Create Key File");
+        if (!selectCase(*this, "Create Key File"))
+            return;
 
         std::stringstream coutCapture;
         CoutRedirect coutRedirect{coutCapture};
@@ -61,10 +70,85 @@ private:
         BEAST_EXPECT(error == expectedError);
     }
 
+    void
+    testCreateKeyFiles()
+    {
+        if (!selectCase(*this, "Create Key Files"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFileDir = subdir / "keys";
+
+        CommandOptions options;
+        options.keyFileDir = keyFileDir.string();
+        options.count = 12;
+        options.threads = 3;
+
+        std::stringstream coutCapture;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand("create_keys", {}, {}, options);
+        }
+
+        std::set<PublicKey> publicKeys;
+        for (int i = 1; i <= 12; ++i)
+        {
+            auto const n = (i < 10 ? "0" : "") + std::to_string(i);
+            path const keyFile = keyFileDir / ("validator-keys-" + n + ".json");
+            if (!BEAST_EXPECT(exists(keyFile)))
+                continue;
+
+            Json::Value jv;
+            std::ifstream in(keyFile.string());
+            BEAST_EXPECT(Json::Reader().parse(in, jv));
+            BEAST_EXPECT(jv["key_type"] == "ed25519");
+
+            // The stored public key belongs to the stored secret key
+            auto const sk = parseBase58<SecretKey>(
+                TokenType::NodePrivate, jv["secret_key"].asString());
+            auto const pk = parseBase58<PublicKey>(
+                TokenType::NodePublic, jv["public_key"].asString());
+            if (BEAST_EXPECT(sk && pk))
+            {
+                BEAST_EXPECT(derivePublicKey(KeyType::ed25519, *sk) == *pk);
+                publicKeys.insert(*pk);
+            }
+        }
+        BEAST_EXPECT(publicKeys.size() == 12);
+
+        auto const expectError = [&](std::string const& expected) {
+            std::string error;
+            try
+            {
+                runCommand("create_keys", {}, {}, options);
+            }
+            catch (std::exception const& e)
+            {
+                error = e.what();
+            }
+            BEAST_EXPECT(error == expected);
+        };
+
+        expectError(
+            "Refusing to overwrite existing key file: " +
+            (keyFileDir / "validator-keys-01.json").string());
+
+        options.count = 0;
+        expectError("Syntax error: --count must be at least 1");
+
+        options.count = 2;
+        options.keyFileDir.reset();
+        expectError("Syntax error: --count needs --keyfile-dir");
+    }
+
     void
     testCreateToken()
     {
-        testcase("Create Token");
+        if (!selectCase(*this, "Create Token"))
+            return;
 
         std::stringstream coutCapture;
         CoutRedirect coutRedirect{coutCapture};
@@ -126,7 +210,8 @@ private:
     void
     testCreateRevocation()
     {
-        testcase("Create Revocation");
+        if (!selectCase(*this, "Create Revocation"))
+            return;
 
         std::stringstream coutCapture;
         CoutRedirect coutRedirect{coutCapture};
@@ -159,7 +244,8 @@ private:
     void
     testSign()
     {
-        testcase("Sign");
+        if (!selectCase(*this, "Sign"))
+            return;
 
         std::stringstream coutCapture;
         CoutRedirect coutRedirect{coutCapture};
@@ -206,12 +292,683 @@ private:
             std::string const expectedError = "";
             testSign(data, keyFile, expectedError);
         }
+
+        // Sign a file
+        path const file = subdir / "artifact.bin";
+        std::ofstream(file.string()) << data;
+
+        CommandOptions options;
+        options.format = OutputFormat::jsonl;
+        options.file = file.string();
+
+        std::stringstream fileCapture;
+        {
+            CoutRedirect redirect{fileCapture};
+            runCommand("sign", {}, keyFile, options);
+        }
+        Json::Value jv;
+        BEAST_EXPECT(Json::Reader().parse(fileCapture.str(), jv));
+        BEAST_EXPECT(jv["file"] == file.string());
+        BEAST_EXPECT(jv["digest"] == to_string(fileDigest(file)));
+
+        auto const keys = ValidatorKeys::make_ValidatorKeys(keyFile);
+        auto const signature = strUnHex(jv["signature"].asString());
+        BEAST_EXPECT(
+            signature &&
+            verifySignedDigest(
+                keys.publicKey(), fileDigest(file), makeSlice(*signature)));
+
+        std::string error;
+        try
+        {
+            runCommand("sign", {data}, keyFile, options);
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(error == "Syntax error: Wrong number of arguments");
+    }
+
+    void
+    testSignKeyDirectory()
+    {
+        if (!selectCase(*this, "Sign Key Directory"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+
+        std::vector<ValidatorKeys> keys;
+        keys.emplace_back(KeyType::secp256k1);
+        keys.emplace_back(KeyType::ed25519);
+        keys.emplace_back(KeyType::secp256k1);
+        keys[2].revoke();
+        keys[0].writeToFile(subdir / "b.json");
+        keys[1].writeToFile(subdir / "a.json");
+        keys[2].writeToFile(subdir / "c.json");
+        std::ofstream((subdir / "broken.json").string()) << "{";
+
+        std::string const data = "data to sign";
+        CommandOptions options;
+        options.format = OutputFormat::jsonl;
+        options.keyFileDir = subdir.string();
+
+        std::stringstream coutCapture;
+        int rc;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            rc = runCommand("sign", {data}, {}, options);
+        }
+        BEAST_EXPECT(rc == EXIT_FAILURE);
+
+        // Key file path order: a, b, c
+        std::vector<std::size_t> const order = {1, 0, 2};
+        std::size_t n = 0;
+        std::string line;
+        while (std::getline(coutCapture, line))
+        {
+            Json::Value jv;
+            if (!BEAST_EXPECT(Json::Reader().parse(line, jv)) ||
+                !BEAST_EXPECT(n < order.size()))
+                break;
+
+            auto const& k = keys[order[n++]];
+            BEAST_EXPECT(
+                jv["public_key"] ==
+                toBase58(TokenType::NodePublic, k.publicKey()));
+            BEAST_EXPECT(jv["revoked"] == k.revoked());
+            BEAST_EXPECT(jv["signature"] == k.sign(data));
+            auto const sig = strUnHex(jv["signature"].asString());
+            BEAST_EXPECT(
+                sig &&
+                verify(k.publicKey(), makeSlice(data), makeSlice(*sig)));
+        }
+        BEAST_EXPECT(n == order.size());
+
+        remove(subdir / "broken.json");
+        options.format = OutputFormat::text;
+        coutCapture.str("");
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            rc = runCommand("sign", {data}, {}, options);
+        }
+        BEAST_EXPECT(rc == 0);
+        std::getline(coutCapture, line);
+        BEAST_EXPECT(
+            line ==
+            toBase58(TokenType::NodePublic, keys[1].publicKey()) + " " +
+                keys[1].sign(data));
+    }
+
+    void
+    testKeyVault()
+    {
+        if (!selectCase(*this, "Key Vault"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const vault = subdir / "vault.json";
+
+        // A cheap KDF keeps the test fast; vault_import opens existing vaults
+        VaultKdfParams params;
+        params.n = 1 << 10;
+        KeyVault::create(vault, "password", params).save();
+
+        std::vector<ValidatorKeys> keys;
+        keys.emplace_back(KeyType::secp256k1);
+        keys.emplace_back(KeyType::ed25519);
+        keys[0].writeToFile(subdir / "b.json");
+        keys[1].writeToFile(subdir / "a.json");
+
+        CommandOptions options;
+        auto const syntaxError = [&](std::string const& command,
+                                     std::vector<std::string> const& args) {
+            try
+            {
+                runCommand(command, args, {}, options);
+            }
+            catch (std::exception const& e)
+            {
+                return std::string(e.what());
+            }
+            return std::string();
+        };
+
+        BEAST_EXPECT(
+            syntaxError("vault_list", {}) ==
+            "Syntax error: vault_list needs --vault");
+        options.vault = vault.string();
+        BEAST_EXPECT(
+            syntaxError("vault_list", {}) ==
+            "Syntax error: Missing vault password");
+        options.vaultPassword = "wrong";
+        BEAST_EXPECT(
+            syntaxError("vault_list", {}) ==
+            "Wrong password for vault: " + vault.string());
+        options.vaultPassword = "password";
+
+        // Files of the same name in different directories are refused
+        // rather than one replacing the other in the vault
+        create_directories(subdir / "other");
+        keys[0].writeToFile(subdir / "other" / "a.json");
+        BEAST_EXPECT(
+            syntaxError(
+                "vault_import",
+                {(subdir / "a.json").string(),
+                 (subdir / "other" / "a.json").string()}) ==
+            "Key files " + (subdir / "a.json").string() + " and " +
+                (subdir / "other" / "a.json").string() +
+                " would both be vault entry a");
+        BEAST_EXPECT(KeyVault::open(vault, "password").names().empty());
+
+        std::stringstream coutCapture;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand(
+                "vault_import",
+                {(subdir / "b.json").string(), (subdir / "a.json").string()},
+                {},
+                options);
+        }
+
+        coutCapture.str("");
+        int rc;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            rc = runCommand("vault_list", {}, {}, options);
+        }
+        BEAST_EXPECT(rc == 0);
+        BEAST_EXPECT(
+            coutCapture.str() ==
+            toBase58(TokenType::NodePublic, keys[1].publicKey()) + " a\n" +
+                toBase58(TokenType::NodePublic, keys[0].publicKey()) +
+                " b\n");
+
+        std::string const data = "data to sign";
+        options.format = OutputFormat::jsonl;
+        coutCapture.str("");
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            rc = runCommand("sign", {data}, {}, options);
+        }
+        BEAST_EXPECT(rc == 0);
+
+        // Entry name order: a, b
+        std::vector<std::size_t> const order = {1, 0};
+        std::size_t n = 0;
+        std::string line;
+        while (std::getline(coutCapture, line))
+        {
+            Json::Value jv;
+            if (!BEAST_EXPECT(Json::Reader().parse(line, jv)) ||
+                !BEAST_EXPECT(n < order.size()))
+                break;
+
+            auto const& k = keys[order[n++]];
+            BEAST_EXPECT(
+                jv["public_key"] ==
+                toBase58(TokenType::NodePublic, k.publicKey()));
+            BEAST_EXPECT(jv["signature"] == k.sign(data));
+        }
+        BEAST_EXPECT(n == order.size());
+        BEAST_EXPECT(KeyVault::open(vault, "password").get("a") == keys[1]);
+    }
+
+    void
+    testKeyArtifacts()
+    {
+        if (!selectCase(*this, "Key Artifacts"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const outDir = subdir / "out";
+
+        ValidatorKeys keys(KeyType::ed25519);
+        path const keyFile = subdir / "val.json";
+        keys.writeToFile(keyFile);
+        std::ofstream((subdir / "broken.json").string()) << "{";
+
+        auto const update = [&](std::vector<path> const& keyFiles) {
+            std::stringstream coutCapture;
+            CoutRedirect coutRedirect{coutCapture};
+            auto const rc = updateKeyArtifacts(keyFiles, outDir);
+            return std::make_pair(rc, coutCapture.str());
+        };
+        auto const contents = [&](std::string const& name) {
+            std::ifstream in((outDir / name).string());
+            return std::string(
+                std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+        };
+
+        auto const publicKey =
+            toBase58(TokenType::NodePublic, keys.publicKey());
+
+        // No domain, so no attestation
+        auto [rc, out] = update({keyFile});
+        BEAST_EXPECT(rc == 0);
+        BEAST_EXPECT(out == "updated " + (outDir / "val.cfg").string() + "\n");
+        BEAST_EXPECT(
+            contents("val.cfg") ==
+            "# validator public key: " + publicKey + "\n\n[validators]\n" +
+                publicKey + "\n");
+        BEAST_EXPECT(!exists(outDir / "val.attestation"));
+
+        // Nothing changed, nothing written
+        std::tie(rc, out) = update({keyFile});
+        BEAST_EXPECT(rc == 0 && out.empty());
+
+        std::tie(rc, out) = update({keyFile, subdir / "broken.json"});
+        BEAST_EXPECT(rc == EXIT_FAILURE && out.empty());
+
+        {
+            std::stringstream coutCapture;
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand("set_domain", {"example.com"}, keyFile);
+        }
+        keys = ValidatorKeys::make_ValidatorKeys(keyFile);
+        std::tie(rc, out) = update({keyFile});
+        BEAST_EXPECT(
+            out ==
+            "updated " + (outDir / "val.attestation").string() + "\n");
+        BEAST_EXPECT(
+            contents("val.attestation") ==
+            "attestation=\"" +
+                keys.sign(
+                    "[domain-attestation-blob:example.com:" + publicKey +
+                    "]") +
+                "\"\n");
+
+        // Revoked keys have no attestation and a revocation fragment
+        auto const revocation = keys.revoke();
+        keys.writeToFile(keyFile);
+        std::tie(rc, out) = update({keyFile});
+        BEAST_EXPECT(
+            out ==
+            "removed " + (outDir / "val.attestation").string() + "\n" +
+                "updated " + (outDir / "val.cfg").string() + "\n");
+        auto const cfg = contents("val.cfg");
+        BEAST_EXPECT(
+            cfg.find("[validator_key_revocation]\n") != std::string::npos);
+        BEAST_EXPECT(
+            cfg.find(revocation.substr(0, 72)) != std::string::npos);
+
+        remove(keyFile);
+        std::tie(rc, out) = update({keyFile});
+        BEAST_EXPECT(
+            out == "removed " + (outDir / "val.cfg").string() + "\n");
+        BEAST_EXPECT(!exists(outDir / "val.cfg"));
+
+        std::string error;
+        try
+        {
+            runCommand("watch", {}, {}, {});
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(
+            error ==
+            "Syntax error: watch needs --keyfile-dir and --output-dir");
+    }
+
+    void
+    testFleetStatus()
+    {
+        if (!selectCase(*this, "Fleet Status"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+
+        ValidatorKeys keys(KeyType::ed25519);
+        keys.domain("example.com");
+        keys.writeToFile(subdir / "val.json");
+        auto const publicKey =
+            toBase58(TokenType::NodePublic, keys.publicKey());
+
+        CommandOptions options;
+        options.keyFileDir = subdir.string();
+
+        auto const run = [&](std::string const& command,
+                             std::vector<std::string> const& args) {
+            std::stringstream coutCapture;
+            CoutRedirect coutRedirect{coutCapture};
+            auto const rc = runCommand(command, args, {}, options);
+            return std::make_pair(rc, coutCapture.str());
+        };
+
+        auto [rc, out] = run("fleet_status", {});
+        BEAST_EXPECT(rc == 0);
+        BEAST_EXPECT(
+            out ==
+            publicKey + " ed25519 sequence 0 domain example.com " +
+                (subdir / "val.json").string() +
+                "\n1 keys, 0 revoked, 0 unreadable.\n");
+
+        std::tie(rc, out) = run("find_key", {publicKey});
+        BEAST_EXPECT(rc == 0);
+        BEAST_EXPECT(out == (subdir / "val.json").string() + "\n");
+
+        options.format = OutputFormat::jsonl;
+        std::tie(rc, out) = run("find_key", {publicKey});
+        Json::Value jv;
+        BEAST_EXPECT(Json::Reader().parse(out, jv));
+        BEAST_EXPECT(jv["key_file"] == (subdir / "val.json").string());
+        BEAST_EXPECT(jv["domain"] == "example.com");
+
+        std::tie(rc, out) = run(
+            "find_key",
+            {toBase58(
+                TokenType::NodePublic,
+                ValidatorKeys(KeyType::ed25519).publicKey())});
+        BEAST_EXPECT(rc == EXIT_FAILURE && out.empty());
+    }
+
+    void
+    testSignBatch()
+    {
+        if (!selectCase(*this, "Sign Batch"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFile = subdir / "validator_keys.json";
+        path const recordFile = subdir / "records.log";
+
+        ValidatorKeys const keys(KeyType::ed25519);
+        keys.writeToFile(keyFile);
+        auto const publicKey =
+            toBase58(TokenType::NodePublic, keys.publicKey());
+
+        std::vector<std::string> const records = {
+            "first", "", "third record", "fourth", "fifth"};
+        {
+            std::ofstream o(recordFile.string());
+            for (auto const& r : records)
+                o << r << "\n";
+        }
+
+        CommandOptions options;
+        std::string error;
+        try
+        {
+            runCommand("sign_batch", {recordFile.string()}, keyFile, options);
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(error == "Syntax error: sign_batch needs --merkle");
+
+        options.merkle = true;
+        options.threads = 2;
+        std::stringstream coutCapture;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand("sign_batch", {recordFile.string()}, keyFile, options);
+        }
+
+        std::vector<std::string> proofs;
+        std::string line;
+        while (std::getline(coutCapture, line))
+            proofs.push_back(line);
+        if (!BEAST_EXPECT(proofs.size() == records.size()))
+            return;
+
+        auto const verifyProof = [&](std::string const& proof,
+                                     std::string const& record) {
+            std::stringstream capture;
+            CoutRedirect coutRedirect{capture};
+            return runCommand(
+                "verify_inclusion", {publicKey, proof, record}, {}, {});
+        };
+
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            BEAST_EXPECT(verifyProof(proofs[i], records[i]) == 0);
+            BEAST_EXPECT(
+                verifyProof(proofs[i], records[(i + 1) % records.size()]) ==
+                EXIT_FAILURE);
+        }
+
+        // The record can also come from a file
+        path const recordCopy = subdir / "record.txt";
+        std::ofstream(recordCopy.string()) << records[2];
+        CommandOptions fromFile;
+        fromFile.file = recordCopy.string();
+        fromFile.format = OutputFormat::jsonl;
+        coutCapture.str("");
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            BEAST_EXPECT(
+                runCommand(
+                    "verify_inclusion",
+                    {publicKey, proofs[2]},
+                    {},
+                    fromFile) == 0);
+        }
+        Json::Value jv;
+        BEAST_EXPECT(Json::Reader().parse(coutCapture.str(), jv));
+        BEAST_EXPECT(jv["valid"] == true);
+        BEAST_EXPECT(jv["index"].isIntegral() && jv["index"].asUInt() == 2);
+        BEAST_EXPECT(jv["count"].isIntegral() && jv["count"].asUInt() == 5);
+
+        // One line break ending the file is not part of the record, as in
+        // sign_batch, but a second one is
+        auto const verifyFile = [&](std::string const& contents) {
+            std::ofstream(recordCopy.string(), std::ios_base::binary)
+                << contents;
+            std::stringstream capture;
+            CoutRedirect coutRedirect{capture};
+            return runCommand(
+                "verify_inclusion", {publicKey, proofs[2]}, {}, fromFile);
+        };
+        BEAST_EXPECT(verifyFile(records[2] + "\n") == 0);
+        BEAST_EXPECT(verifyFile(records[2] + "\r\n") == 0);
+        BEAST_EXPECT(verifyFile(records[2] + "\n\n") == EXIT_FAILURE);
+
+        // Records of a file with "\r\n" line breaks have the same proofs
+        std::string crlf;
+        for (auto const& record : records)
+            crlf += record + "\r\n";
+        std::ofstream(recordFile.string(), std::ios_base::binary) << crlf;
+        std::stringstream crlfCapture;
+        {
+            CoutRedirect coutRedirect{crlfCapture};
+            runCommand("sign_batch", {recordFile.string()}, keyFile, options);
+        }
+        for (auto const& proof : proofs)
+        {
+            if (!BEAST_EXPECT(std::getline(crlfCapture, line)))
+                break;
+            BEAST_EXPECT(line == proof);
+        }
+    }
+
+    void
+    testPublishList()
+    {
+        if (!selectCase(*this, "Publish List"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFile = subdir / "publisher.json";
+        path const manifestFile = subdir / "manifests.txt";
+
+        ValidatorKeys const publisher(KeyType::ed25519);
+        publisher.writeToFile(keyFile);
+
+        std::vector<std::string> manifests;
+        std::set<std::string> validatorKeys;
+        for (int i = 0; i < 3; ++i)
+        {
+            ValidatorKeys v(i == 0 ? KeyType::secp256k1 : KeyType::ed25519);
+            manifests.push_back(v.createValidatorToken()->manifest);
+            validatorKeys.insert(strHex(v.publicKey()));
+        }
+
+        auto const writeManifests = [&](std::vector<std::string> const& m) {
+            std::ofstream o(manifestFile.string());
+            for (auto const& line : m)
+                o << line << "\n\n";
+        };
+
+        auto const error = [&](CommandOptions const& options) {
+            try
+            {
+                std::stringstream capture;
+                CoutRedirect coutRedirect{capture};
+                runCommand(
+                    "publish_list", {manifestFile.string()}, keyFile, options);
+            }
+            catch (std::exception const& e)
+            {
+                return std::string(e.what());
+            }
+            return std::string();
+        };
+
+        writeManifests(manifests);
+        CommandOptions options;
+        options.sequence = 7;
+        BEAST_EXPECT(
+            error(options) ==
+            "Syntax error: publish_list needs --sequence and --expiration");
+
+        // A list that expires as soon as it is published is refused
+        options.expiration = 0;
+        BEAST_EXPECT(
+            error(options) == "Syntax error: --expiration must be at least 1");
+
+        options.expiration = 30;
+        options.threads = 2;
+        std::stringstream coutCapture;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand(
+                "publish_list", {manifestFile.string()}, keyFile, options);
+        }
+
+        // Publishing used a new token of the publisher keys
+        auto const updated = ValidatorKeys::make_ValidatorKeys(keyFile);
+        BEAST_EXPECT(updated.sequence() == 1);
+
+        Json::Value list;
+        if (!BEAST_EXPECT(Json::Reader().parse(coutCapture.str(), list)))
+            return;
+        BEAST_EXPECT(list["version"] == 1);
+        BEAST_EXPECT(list["public_key"] == strHex(publisher.publicKey()));
+        auto const publisherManifest =
+            base64_decode(list["manifest"].asString());
+        BEAST_EXPECT(
+            publisherManifest ==
+            std::string(
+                updated.manifest().begin(), updated.manifest().end()));
+
+        // The blob is signed by the signing key of the publisher manifest
+        auto const m = decodeManifest(makeSlice(publisherManifest));
+        if (!BEAST_EXPECT(m))
+            return;
+        auto const blob = base64_decode(list["blob"].asString());
+        auto const signature = strUnHex(list["signature"].asString());
+        BEAST_EXPECT(
+            signature &&
+            verify(
+                PublicKey(m->signingKey),
+                makeSlice(blob),
+                makeSlice(*signature)));
+
+        Json::Value jBlob;
+        BEAST_EXPECT(Json::Reader().parse(blob, jBlob));
+        BEAST_EXPECT(jBlob["sequence"] == 7);
+        using namespace std::chrono;
+        auto const now =
+            duration_cast<seconds>(system_clock::now().time_since_epoch())
+                .count() -
+            rippleEpochOffset;
+        BEAST_EXPECT(
+            jBlob["expiration"].asUInt() > now + 29 * 86400 &&
+            jBlob["expiration"].asUInt() <= now + 30 * 86400);
+        std::set<std::string> listedKeys;
+        for (auto const& v : jBlob["validators"])
+        {
+            listedKeys.insert(v["validation_public_key"].asString());
+            BEAST_EXPECT(
+                std::find(
+                    manifests.begin(),
+                    manifests.end(),
+                    v["manifest"].asString()) != manifests.end());
+        }
+        BEAST_EXPECT(listedKeys == validatorKeys);
+
+        // The published list verifies, also against its publisher key
+        path const listFile = subdir / "vl.json";
+        std::ofstream(listFile.string()) << coutCapture.str();
+        auto const verifyList = [&](std::vector<std::string> const& args) {
+            std::stringstream capture;
+            CoutRedirect coutRedirect{capture};
+            auto const rc = runCommand("verify_list", args, {}, options);
+            return std::make_pair(rc, capture.str());
+        };
+        auto [rc, out] = verifyList({listFile.string()});
+        BEAST_EXPECT(rc == 0);
+        BEAST_EXPECT(
+            out.find("Signature:  valid\nSequence:   7\n") !=
+            std::string::npos);
+        BEAST_EXPECT(
+            out.find("3 listed: 3 effective, 0 duplicate, 0 revoked, 0 "
+                     "invalid.") != std::string::npos);
+        std::tie(rc, out) =
+            verifyList({listFile.string(), strHex(publisher.publicKey())});
+        BEAST_EXPECT(rc == 0);
+        std::tie(rc, out) = verifyList(
+            {listFile.string(),
+             strHex(ValidatorKeys(KeyType::ed25519).publicKey())});
+        BEAST_EXPECT(rc == EXIT_FAILURE);
+        BEAST_EXPECT(
+            out.find("(not the expected publisher)") != std::string::npos);
+
+        // Lists are checked before a token is spent
+        writeManifests({manifests[0], manifests[1], manifests[0]});
+        BEAST_EXPECT(error(options).find("Validator listed twice: ") == 0);
+
+        auto tampered = base64_decode(manifests[1]);
+        tampered.back() ^= 1;
+        writeManifests({manifests[0], strHex(tampered)});
+        BEAST_EXPECT(
+            error(options) ==
+            manifestFile.string() + ":3: bad master signature");
+
+        writeManifests({"not a manifest"});
+        BEAST_EXPECT(
+            error(options) == manifestFile.string() + ":1: not hex or base64");
+        BEAST_EXPECT(
+            ValidatorKeys::make_ValidatorKeys(keyFile).sequence() == 1);
     }
 
     void
     testRunCommand()
     {
-        testcase("Run Command");
+        if (!selectCase(*this, "Run Command"))
+            return;
 
         std::stringstream coutCapture;
         CoutRedirect coutRedirect{coutCapture};
@@ -276,6 +1033,298 @@ private:
         }
     }
 
+    void
+    testJsonLines()
+    {
+        if (!selectCase(*this, "JSON Lines Output"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const keyFile = subdir / "validator_keys.json";
+
+        CommandOptions options;
+        options.format = OutputFormat::jsonl;
+
+        // Run a command and return the records it printed
+        auto run = [&](std::string const& command,
+                       std::vector<std::string> const& args) {
+            std::stringstream coutCapture;
+            {
+                CoutRedirect coutRedirect{coutCapture};
+                runCommand(command, args, keyFile, options);
+            }
+
+            std::vector<Json::Value> records;
+            std::string line;
+            while (std::getline(coutCapture, line))
+            {
+                Json::Value jv;
+                BEAST_EXPECT(Json::Reader().parse(line, jv));
+                BEAST_EXPECT(jv.isObject());
+                records.push_back(jv);
+            }
+            return records;
+        };
+
+        auto records = run("create_keys", {});
+        auto const keys = ValidatorKeys::make_ValidatorKeys(keyFile);
+        auto const publicKey =
+            toBase58(TokenType::NodePublic, keys.publicKey());
+        if (BEAST_EXPECT(records.size() == 1))
+        {
+            BEAST_EXPECT(records[0]["command"] == "create_keys");
+            BEAST_EXPECT(records[0]["public_key"] == publicKey);
+            BEAST_EXPECT(records[0]["key_file"] == keyFile.string());
+        }
+
+        records = run("create_token", {});
+        if (BEAST_EXPECT(records.size() == 1))
+        {
+            BEAST_EXPECT(records[0]["public_key"] == publicKey);
+            BEAST_EXPECT(records[0]["sequence"].asUInt() == 1);
+            BEAST_EXPECT(records[0]["token"].isString());
+            BEAST_EXPECT(records[0]["manifest"].isString());
+        }
+
+        records = run("set_domain", {"example.com"});
+        if (BEAST_EXPECT(records.size() == 1))
+        {
+            BEAST_EXPECT(records[0]["sequence"].asUInt() == 2);
+            BEAST_EXPECT(records[0]["domain"] == "example.com");
+            BEAST_EXPECT(records[0]["attestation"].isString());
+        }
+
+        records = run("show_manifest", {"hex"});
+        if (BEAST_EXPECT(records.size() == 1))
+        {
+            BEAST_EXPECT(records[0]["sequence"].asUInt() == 2);
+            BEAST_EXPECT(records[0]["encoding"] == "hex");
+            BEAST_EXPECT(records[0]["manifest"].isString());
+        }
+
+        // Earlier manifests come from the manifest history
+        options.sequence = 1;
+        auto const first = run("show_manifest", {"hex"});
+        options.sequence.reset();
+        if (BEAST_EXPECT(first.size() == 1 && records.size() == 1))
+        {
+            BEAST_EXPECT(first[0]["sequence"].asUInt() == 1);
+            BEAST_EXPECT(first[0]["manifest"].isString());
+            BEAST_EXPECT(first[0]["manifest"] != records[0]["manifest"]);
+        }
+
+        options.sequence = 3;
+        try
+        {
+            run("show_manifest", {"hex"});
+            fail();
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                e.what() ==
+                "No manifest with sequence 3 in the manifest history of " +
+                    keyFile.string());
+        }
+        options.sequence.reset();
+
+        records = run("sign", {"data to sign"});
+        if (BEAST_EXPECT(records.size() == 1))
+            BEAST_EXPECT(
+                records[0]["signature"] == keys.sign("data to sign"));
+
+        records = run("revoke_keys", {});
+        if (BEAST_EXPECT(records.size() == 1))
+        {
+            BEAST_EXPECT(records[0]["previously_revoked"] == false);
+            BEAST_EXPECT(records[0]["manifest"].isString());
+        }
+
+        // New keys at the same path do not inherit the history
+        ValidatorKeys(KeyType::ed25519).writeToFile(keyFile);
+        options.sequence = 1;
+        try
+        {
+            run("show_manifest", {"hex"});
+            fail();
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                e.what() ==
+                "Manifest history " + keyFile.string() +
+                    ".history belongs to a different master key");
+        }
+        options.sequence.reset();
+    }
+
+    void
+    testDecodeManifest()
+    {
+        if (!selectCase(*this, "Decode Manifest"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const manifestFile = subdir / "manifests.txt";
+
+        ValidatorKeys keys(KeyType::secp256k1);
+        keys.domain("example.com");
+        auto const token = keys.createValidatorToken();
+        auto const revocation = keys.revoke();
+        auto const publicKey =
+            toBase58(TokenType::NodePublic, keys.publicKey());
+
+        {
+            std::ofstream o(manifestFile.string());
+            o << token->manifest << "\n\n  "
+              << strHex(base64_decode(revocation)) << "\r\n"
+              << "garbage\n";
+        }
+
+        CommandOptions options;
+        options.format = OutputFormat::jsonl;
+        options.threads = 2;
+
+        std::stringstream coutCapture;
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand(
+                "decode_manifest", {manifestFile.string()}, {}, options);
+        }
+
+        std::vector<Json::Value> records;
+        std::string line;
+        while (std::getline(coutCapture, line))
+        {
+            Json::Value jv;
+            BEAST_EXPECT(Json::Reader().parse(line, jv));
+            records.push_back(jv);
+        }
+
+        if (BEAST_EXPECT(records.size() == 3))
+        {
+            BEAST_EXPECT(records[0]["line"].asUInt() == 1);
+            BEAST_EXPECT(records[0]["sequence"].asUInt() == 1);
+            BEAST_EXPECT(records[0]["master_key"] == publicKey);
+            BEAST_EXPECT(records[0]["domain"] == "example.com");
+            BEAST_EXPECT(records[0]["revoked"] == false);
+
+            BEAST_EXPECT(records[1]["line"].asUInt() == 3);
+            BEAST_EXPECT(records[1]["master_key"] == publicKey);
+            BEAST_EXPECT(records[1]["revoked"] == true);
+            BEAST_EXPECT(!records[1].isMember("signing_key"));
+
+            BEAST_EXPECT(records[2]["line"].asUInt() == 4);
+            BEAST_EXPECT(records[2]["error"] == "not hex or base64");
+        }
+
+        options.format = OutputFormat::csv;
+        coutCapture.str("");
+        {
+            CoutRedirect coutRedirect{coutCapture};
+            runCommand(
+                "decode_manifest", {manifestFile.string()}, {}, options);
+        }
+        std::getline(coutCapture, line);
+        BEAST_EXPECT(
+            line ==
+            "source,line,sequence,master_key,signing_key,domain,"
+            "signature,master_signature,error");
+        std::size_t rows = 0;
+        while (std::getline(coutCapture, line))
+            ++rows;
+        BEAST_EXPECT(rows == 3);
+
+        std::string error;
+        try
+        {
+            runCommand("sign", {"data"}, {}, options);
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(error == "Output format csv is not supported by sign");
+    }
+
+    void
+    testAuditConfigs()
+    {
+        if (!selectCase(*this, "Audit Configs"))
+            return;
+
+        using namespace boost::filesystem;
+
+        path const subdir = "test_key_file";
+        KeyFileGuard const g(*this, subdir.string());
+        path const configs = subdir / "configs";
+        path const keysDir = subdir / "keys";
+        create_directories(configs);
+        create_directories(keysDir);
+
+        ValidatorKeys keys(KeyType::secp256k1);
+        {
+            std::ofstream o((configs / "rippled.cfg").string());
+            o << "[validator_token]\n"
+              << keys.createValidatorToken()->toString() << "\n";
+        }
+        keys.writeToFile(keysDir / "validator-keys.json");
+
+        CommandOptions options;
+        options.format = OutputFormat::jsonl;
+
+        std::string error;
+        try
+        {
+            runCommand("audit_configs", {}, {}, options);
+        }
+        catch (std::exception const& e)
+        {
+            error = e.what();
+        }
+        BEAST_EXPECT(
+            error == "Syntax error: audit_configs needs --configs and --keys");
+
+        options.configsDir = configs.string();
+        options.keysDir = keysDir.string();
+
+        auto const audit = [&] {
+            std::stringstream coutCapture;
+            CoutRedirect coutRedirect{coutCapture};
+            auto const rc = runCommand("audit_configs", {}, {}, options);
+            Json::Value jv;
+            BEAST_EXPECT(Json::Reader().parse(coutCapture.str(), jv));
+            return std::make_pair(rc, jv);
+        };
+
+        auto const [ok, current] = audit();
+        BEAST_EXPECT(ok == 0);
+        BEAST_EXPECT(current["ok"] == true);
+        BEAST_EXPECT(current["token_sequence"].asUInt() == 1);
+        BEAST_EXPECT(current["key_sequence"].asUInt() == 1);
+        BEAST_EXPECT(
+            current["public_key"] ==
+            toBase58(TokenType::NodePublic, keys.publicKey()));
+        BEAST_EXPECT(current["issues"].size() == 0);
+
+        keys.createValidatorToken();
+        keys.writeToFile(keysDir / "validator-keys.json");
+
+        auto const [failed, stale] = audit();
+        BEAST_EXPECT(failed == EXIT_FAILURE);
+        BEAST_EXPECT(stale["ok"] == false);
+        BEAST_EXPECT(stale["key_sequence"].asUInt() == 2);
+        BEAST_EXPECT(
+            stale["issues"].size() == 1 &&
+            stale["issues"][0u] == "stale_token");
+    }
+
 public:
     void
     run() override
@@ -283,10 +1332,20 @@ public:
         getVersionString();
 
         testCreateKeyFile();
+        testCreateKeyFiles();
         testCreateToken();
         testCreateRevocation();
         testSign();
+        testSignKeyDirectory();
+        testKeyVault();
+        testKeyArtifacts();
+        testFleetStatus();
+        testSignBatch();
+        testPublishList();
         testRunCommand();
+        testJsonLines();
+        testDecodeManifest();
+        testAuditConfigs();
     }
 };
 
@@ -1,11 +1,20 @@
 #include <ValidatorKeys.h>
+#include <ValidatorKeysTool.h>
 
+#include <test/AllocationCounter.h>
+#include <test/Bench.h>
+#include <test/CaseFilter.h>
+#include <test/Corpus.h>
 #include <test/KeyFileGuard.h>
 
 #include <xrpl/basics/StringUtilities.h>
 #include <xrpl/basics/base64.h>
 #include <xrpl/protocol/HashPrefix.h>
 #include <xrpl/protocol/Sign.h>
+#include <xrpl/protocol/digest.h>
+
+#include <iomanip>
+#include <memory>
 
 namespace xrpl {
 
@@ -43,7 +52,8 @@ private:
     void
     testMakeValidatorKeys()
     {
-        testcase("Make Validator Keys");
+        if (!selectCase(*this, "Make Validator Keys"))
+            return;
 
         using namespace boost::filesystem;
 
@@ -166,7 +176,8 @@ private:
     void
     testCreateValidatorToken()
     {
-        testcase("Create Validator Token");
+        if (!selectCase(*this, "Create Validator Token"))
+            return;
 
         for (auto const keyType : keyTypes)
         {
@@ -223,7 +234,8 @@ private:
     void
     testRevoke()
     {
-        testcase("Revoke");
+        if (!selectCase(*this, "Revoke"))
+            return;
 
         for (auto const keyType : keyTypes)
         {
@@ -251,7 +263,8 @@ private:
     void
     testSign()
     {
-        testcase("Sign");
+        if (!selectCase(*this, "Sign"))
+            return;
 
         std::map<KeyType, std::string> expected(
             {{KeyType::ed25519,
@@ -278,13 +291,45 @@ private:
             BEAST_EXPECT(ret->size());
             BEAST_EXPECT(
                 verify(keys.publicKey(), makeSlice(data), makeSlice(*ret)));
+
+            // Signing a prehashed payload gives the same signature
+            SigningPayload const payload(data);
+            BEAST_EXPECT(keys.sign(payload) == signature);
+        }
+    }
+
+    void
+    testSignDigest()
+    {
+        if (!selectCase(*this, "Sign Digest"))
+            return;
+
+        auto const digest = sha512Half(makeSlice(std::string("contents")));
+        auto const other = sha512Half(makeSlice(std::string("other")));
+
+        for (auto const keyType : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            ValidatorKeys const keys(keyType);
+            auto const signature = strUnHex(keys.signDigest(digest));
+            if (!BEAST_EXPECT(signature))
+                continue;
+
+            BEAST_EXPECT(verifySignedDigest(
+                keys.publicKey(), digest, makeSlice(*signature)));
+            BEAST_EXPECT(!verifySignedDigest(
+                keys.publicKey(), other, makeSlice(*signature)));
+            BEAST_EXPECT(!verifySignedDigest(
+                ValidatorKeys(keyType).publicKey(),
+                digest,
+                makeSlice(*signature)));
         }
     }
 
     void
     testWriteToFile()
     {
-        testcase("Write to File");
+        if (!selectCase(*this, "Write to File"))
+            return;
 
         using namespace boost::filesystem;
 
@@ -337,6 +382,17 @@ private:
 
             auto const fileKeys = ValidatorKeys::make_ValidatorKeys(keyFile);
             BEAST_EXPECT(keys == fileKeys);
+
+            // Rewriting replaces the file whole, leaving no temporary file,
+            // and only the owner may read the secret key
+            keys.writeToFile(keyFile);
+            BEAST_EXPECT(
+                std::distance(
+                    directory_iterator(keyFile.parent_path()),
+                    directory_iterator()) == 1);
+            BEAST_EXPECT(
+                (status(keyFile).permissions() & (group_all | others_all)) ==
+                no_perms);
         }
         {
             // Fail if file cannot be opened for write
@@ -374,6 +430,118 @@ private:
         }
     }
 
+    void
+    testAllocations()
+    {
+        if (!selectCase(*this, "Allocations"))
+            return;
+
+        ValidatorKeys keys(KeyType::ed25519);
+        keys.createValidatorToken();
+
+        // The counter sees what it is meant to
+        {
+            AllocationCounter const counter;
+            auto const p = std::make_unique<int>(1);
+            BEAST_EXPECT(counter.count() == 1);
+        }
+
+        // Longer than any small string buffer
+        std::string domain = "validator.long-subdomain.example.com";
+        auto const buffer = domain.data();
+        keys.domain(std::move(domain));
+        BEAST_EXPECT(keys.domain().data() == buffer);
+
+        {
+            AllocationCounter const counter;
+            std::size_t size = 0;
+            size += keys.domain().size();
+            size += keys.manifest().size();
+            size += keys.publicKey().size();
+            BEAST_EXPECT(size > 0);
+            BEAST_EXPECT(counter.count() == 0);
+        }
+
+        // Copies are seen
+        {
+            AllocationCounter const counter;
+            auto const manifest = keys.manifest();
+            BEAST_EXPECT(manifest == keys.manifest());
+            BEAST_EXPECT(counter.count() == 1);
+        }
+
+        // Per-operation budgets, each taken after a first call has done
+        // any one-time setup. A failure here means an operation started
+        // copying again.
+        auto const budget = [&](std::size_t limit, auto&& f) {
+            f();
+            AllocationCounter const counter;
+            f();
+            return counter.count() <= limit;
+        };
+
+        // show_manifest: only the encoded manifest is allocated
+        BEAST_EXPECT(budget(1, [&] {
+            auto const& m = keys.manifest();
+            return base64_encode(m.data(), m.size());
+        }));
+        BEAST_EXPECT(budget(1, [&] { return strHex(keys.manifest()); }));
+
+        // sign: the signature and its hex encoding
+        std::string const data = "data to sign";
+        BEAST_EXPECT(budget(2, [&] { return keys.sign(data); }));
+
+        // attestDomain: the blob, the base58 public key and the signature
+        BEAST_EXPECT(budget(8, [&] { return makeAttestation(keys); }));
+    }
+
+    void
+    testEntropySource()
+    {
+        if (!selectCase(*this, "Entropy Source"))
+            return;
+
+        // Returns the public key and first token manifest of keys made
+        // from a seed
+        auto const make = [&](KeyType type, std::uint64_t seed) {
+            DeterministicEntropy entropy(seed);
+            ScopedEntropySource const scope(entropy);
+            ValidatorKeys keys(type);
+            return std::make_pair(
+                keys.publicKey(), keys.createValidatorToken()->manifest);
+        };
+
+        for (auto const keyType : keyTypes)
+        {
+            auto const a = make(keyType, 1);
+            BEAST_EXPECT(make(keyType, 1) == a);
+            BEAST_EXPECT(make(keyType, 2).first != a.first);
+
+            // Each seed drawn is new, and the source ends with its scope
+            DeterministicEntropy entropy(1);
+            auto const first = entropy.nextSeed();
+            auto const second = entropy.nextSeed();
+            BEAST_EXPECT(
+                Slice(first.data(), first.size()) !=
+                Slice(second.data(), second.size()));
+            BEAST_EXPECT(ValidatorKeys(keyType).publicKey() != a.first);
+        }
+
+        // Scopes nest
+        DeterministicEntropy outer(1);
+        DeterministicEntropy inner(2);
+        ScopedEntropySource const scope(outer);
+        {
+            ScopedEntropySource const nested(inner);
+            BEAST_EXPECT(
+                ValidatorKeys(KeyType::ed25519).publicKey() ==
+                make(KeyType::ed25519, 2).first);
+        }
+        BEAST_EXPECT(
+            ValidatorKeys(KeyType::ed25519).publicKey() ==
+            make(KeyType::ed25519, 1).first);
+    }
+
 public:
     void
     run() override
@@ -382,11 +550,130 @@ public:
         testCreateValidatorToken();
         testRevoke();
         testSign();
+        testSignDigest();
         testWriteToFile();
+        testAllocations();
+        testEntropySource();
+    }
+};
+
+/** Times token generation and its secp256k1 and ed25519 building blocks
+
+    secp256k1 key generation and signing go through libxrpl's process-wide
+    secp256k1 context, whose generator tables are built once on first use,
+    so these are steady-state costs of the per-call path.
+*/
+class TokenBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        if (!selectCase(*this, "Token generation"))
+            return;
+
+        std::size_t const rounds = 2000;
+        std::uint64_t sink = 0;
+        std::string const payload = "payload";
+        auto const digest = sha512Half(makeSlice(payload));
+
+        auto const time = [&](std::string const& name, auto&& f) {
+            f();  // warm up, including the secp256k1 context
+            auto const ns = measure(rounds, f);
+            log << std::left << std::setw(30) << name << std::right
+                << std::setw(10) << ns.count() << " ns" << std::endl;
+        };
+
+        for (auto const keyType : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            std::string const type = to_string(keyType);
+            auto const keyPair = randomKeyPair(keyType);
+
+            time(type + " keygen", [&] {
+                sink += randomKeyPair(keyType).first.size();
+            });
+            time(type + " sign", [&] {
+                sink += keyType == KeyType::secp256k1
+                    ? signDigest(keyPair.first, keyPair.second, digest).size()
+                    : sign(keyPair.first, keyPair.second, makeSlice(payload))
+                          .size();
+            });
+
+            ValidatorKeys keys(KeyType::ed25519);
+            time(type + " token", [&] {
+                sink += keys.createValidatorToken(keyType)->manifest.size();
+            });
+        }
+
+        log << "(" << sink % 2 << ")" << std::endl;
+        pass();
+    }
+};
+
+/** Times ValidatorKeys signing against the bare signing primitive
+
+    Neither key type has signing state worth caching: secp256k1 signs with
+    libxrpl's process-wide context, and ed25519 only re-derives its
+    expanded key with one SHA-512 of the 32 byte secret, timed here as
+    "key expansion" for comparison.
+*/
+class SignBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        if (!selectCase(*this, "Sign throughput"))
+            return;
+
+        std::size_t const rounds = 5000;
+        std::uint64_t sink = 0;
+        std::string const payload(256, 'x');
+
+        auto const time = [&](std::string const& name, auto&& f) {
+            f();
+            auto const ns =
+                std::max<std::int64_t>(measure(rounds, f).count(), 1);
+            log << std::left << std::setw(30) << name << std::right
+                << std::setw(10) << ns << " ns" << std::setw(12)
+                << 1000000000 / ns << " /s" << std::endl;
+        };
+
+        for (auto const keyType : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            std::string const type = to_string(keyType);
+            auto const keyPair =
+                generateKeyPair(keyType, DeterministicEntropy(1).nextSeed());
+            ValidatorKeys const keys(keyType, keyPair.second, 0);
+            SigningPayload const signingPayload(payload);
+
+            time(type + " primitive", [&] {
+                sink += sign(keyPair.first, keyPair.second, makeSlice(payload))
+                            .size();
+            });
+            time(type + " ValidatorKeys", [&] {
+                sink += keys.sign(payload).size();
+            });
+            time(type + " SigningPayload", [&] {
+                sink += keys.sign(signingPayload).size();
+            });
+            if (keyType == KeyType::ed25519)
+                time(type + " key expansion", [&] {
+                    // The full SHA-512 that ed25519 expands a secret with
+                    sha512_hasher h;
+                    h(keyPair.second.data(), keyPair.second.size());
+                    sink += static_cast<sha512_hasher::result_type>(h)[0];
+                });
+        }
+
+        log << "(" << sink % 2 << ")" << std::endl;
+        pass();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(ValidatorKeys, keys, xrpl);
+BEAST_DEFINE_TESTSUITE_MANUAL(TokenBench, keys, xrpl);
+BEAST_DEFINE_TESTSUITE_MANUAL(SignBench, keys, xrpl);
 
 }  // namespace tests
 
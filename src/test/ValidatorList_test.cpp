@@ -0,0 +1,314 @@
+#include <OutputWriter.h>
+#include <ValidatorKeys.h>
+#include <ValidatorList.h>
+
+#include <test/CaseFilter.h>
+
+#include <xrpl/basics/StringUtilities.h>
+#include <xrpl/basics/base64.h>
+#include <xrpl/beast/unit_test.h>
+#include <xrpl/json/json_reader.h>
+#include <xrpl/protocol/Sign.h>
+
+#include <sstream>
+
+namespace xrpl {
+
+namespace tests {
+
+class ValidatorList_test : public beast::unit_test::suite
+{
+private:
+    static std::string
+    checkError(std::string const& manifest)
+    {
+        try
+        {
+            checkListedManifest(manifest);
+        }
+        catch (std::exception const& e)
+        {
+            return e.what();
+        }
+        return {};
+    }
+
+    void
+    testCheckManifest()
+    {
+        if (!selectCase(*this, "Check Manifest"))
+            return;
+
+        for (auto const type : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            ValidatorKeys keys(type);
+            auto const manifest =
+                base64_decode(keys.createValidatorToken()->manifest);
+
+            auto const listed = checkListedManifest(manifest);
+            BEAST_EXPECT(listed.masterKey == keys.publicKey());
+            BEAST_EXPECT(listed.manifest == manifest);
+
+            // The signing key signature covers everything but the
+            // signatures, the master signature everything but itself
+            auto tampered = manifest;
+            tampered.back() ^= 1;
+            BEAST_EXPECT(checkError(tampered) == "bad master signature");
+
+            BEAST_EXPECT(
+                checkError(manifest.substr(0, manifest.size() / 2)) ==
+                "malformed manifest");
+            BEAST_EXPECT(
+                checkError(base64_decode(keys.revoke())) ==
+                "revoked master key");
+        }
+    }
+
+    void
+    testBlob()
+    {
+        if (!selectCase(*this, "Blob"))
+            return;
+
+        std::vector<ListedValidator> validators;
+        for (int i = 0; i < 3; ++i)
+        {
+            ValidatorKeys keys(KeyType::ed25519);
+            validators.push_back(checkListedManifest(
+                base64_decode(keys.createValidatorToken()->manifest)));
+        }
+
+        Json::Value jv;
+        BEAST_EXPECT(
+            Json::Reader().parse(makeListBlob(3, 1000, validators), jv));
+        BEAST_EXPECT(jv["sequence"] == 3);
+        BEAST_EXPECT(jv["expiration"] == 1000);
+        if (!BEAST_EXPECT(jv["validators"].size() == validators.size()))
+            return;
+        for (unsigned i = 0; i < validators.size(); ++i)
+        {
+            auto const& v = jv["validators"][i];
+            BEAST_EXPECT(
+                v["validation_public_key"] ==
+                strHex(validators[i].masterKey));
+            BEAST_EXPECT(
+                base64_decode(v["manifest"].asString()) ==
+                validators[i].manifest);
+        }
+
+        BEAST_EXPECT(
+            makeListBlob(1, 2, {}) ==
+            "{\"sequence\":1,\"expiration\":2,\"validators\":[]}");
+    }
+
+    void
+    testWriteList()
+    {
+        if (!selectCase(*this, "Write List"))
+            return;
+
+        ValidatorKeys const keys(KeyType::ed25519);
+
+        // Long enough to be encoded in several pieces, with a remainder
+        std::string blob;
+        for (int i = 0; blob.size() < 200 * 1024 + 1; ++i)
+            blob += std::to_string(i);
+
+        std::ostringstream os;
+        {
+            OutputWriter out(os);
+            writeValidatorList(
+                out,
+                makeSlice(blob),
+                "manifest",
+                keys.publicKey(),
+                makeSlice(std::string("\x01\x02")));
+        }
+
+        Json::Value jv;
+        BEAST_EXPECT(Json::Reader().parse(os.str(), jv));
+        BEAST_EXPECT(jv["blob"] == base64_encode(blob));
+        BEAST_EXPECT(jv["manifest"] == "manifest");
+        BEAST_EXPECT(jv["public_key"] == strHex(keys.publicKey()));
+        BEAST_EXPECT(jv["signature"] == "0102");
+        BEAST_EXPECT(jv["version"] == 1);
+    }
+
+    // Returns a list of blob signed with a new token of the publisher
+    static std::string
+    signedList(ValidatorKeys& publisher, std::string const& blob)
+    {
+        auto const token = publisher.createValidatorToken();
+        auto const signature = sign(
+            derivePublicKey(KeyType::secp256k1, token->secretKey),
+            token->secretKey,
+            makeSlice(blob));
+
+        std::ostringstream os;
+        {
+            OutputWriter out(os);
+            writeValidatorList(
+                out,
+                makeSlice(blob),
+                token->manifest,
+                publisher.publicKey(),
+                signature);
+        }
+        return os.str();
+    }
+
+    static std::string
+    verifyError(std::string const& json)
+    {
+        try
+        {
+            verifyValidatorList(json);
+        }
+        catch (std::exception const& e)
+        {
+            return e.what();
+        }
+        return {};
+    }
+
+    void
+    testVerify()
+    {
+        if (!selectCase(*this, "Verify"))
+            return;
+
+        ValidatorKeys publisher(KeyType::ed25519);
+
+        std::vector<ValidatorKeys> keys;
+        std::vector<ListedValidator> listed;
+        for (int i = 0; i < 6; ++i)
+        {
+            keys.emplace_back(KeyType::ed25519);
+            listed.push_back(checkListedManifest(
+                base64_decode(keys.back().createValidatorToken()->manifest)));
+        }
+
+        // A good list of the first three
+        auto v = verifyValidatorList(
+            signedList(
+                publisher,
+                makeListBlob(
+                    5, 1000, {listed.begin(), listed.begin() + 3})),
+            2);
+        BEAST_EXPECT(v.publisherKey == publisher.publicKey());
+        BEAST_EXPECT(v.manifestSequence == 1u);
+        BEAST_EXPECT(v.manifestError.empty());
+        BEAST_EXPECT(v.signatureValid);
+        BEAST_EXPECT(v.sequence == 5 && v.expiration == 1000);
+        BEAST_EXPECT(v.listed == 3);
+        BEAST_EXPECT(
+            v.effective ==
+            std::vector<PublicKey>(
+                {keys[0].publicKey(), keys[1].publicKey(),
+                 keys[2].publicKey()}));
+        BEAST_EXPECT(
+            v.duplicates.empty() && v.revoked.empty() && v.invalid.empty());
+
+        // Listed twice, revoked, the manifest of another key, a bad key,
+        // and an entry without a manifest, which stands on its key alone
+        auto entries = listed;
+        entries.push_back(listed[0]);
+        entries.push_back(listed[0]);
+        entries[3].manifest = base64_decode(keys[3].revoke());
+        entries[4].manifest = listed[5].manifest;
+        auto blob = makeListBlob(6, 1000, entries);
+        auto const key5 = strHex(keys[5].publicKey());
+        blob.replace(blob.find(key5), key5.size(), "00");
+        blob.insert(
+            blob.rfind(']'), ",{\"validation_public_key\":\"" + key5 + "\"}");
+
+        v = verifyValidatorList(signedList(publisher, blob), 2);
+        BEAST_EXPECT(v.signatureValid);
+        BEAST_EXPECT(v.manifestSequence == 2u);
+        BEAST_EXPECT(v.listed == 9);
+        BEAST_EXPECT(
+            v.effective ==
+            std::vector<PublicKey>(
+                {keys[0].publicKey(), keys[1].publicKey(),
+                 keys[2].publicKey(), keys[5].publicKey()}));
+        BEAST_EXPECT(
+            v.duplicates == std::vector<PublicKey>({keys[0].publicKey()}));
+        BEAST_EXPECT(
+            v.revoked == std::vector<PublicKey>({keys[3].publicKey()}));
+        BEAST_EXPECT(
+            v.invalid ==
+            (std::vector<std::pair<std::size_t, std::string>>{
+                {4, "manifest of another key"},
+                {5, "bad validation_public_key"}}));
+
+        // Manifests that are not strings or not manifests at all are
+        // reported per entry instead of failing the list
+        Json::Value jBlob;
+        Json::Reader().parse(makeListBlob(9, 1000, listed), jBlob);
+        jBlob["validators"][0u]["manifest"] = 42;
+        jBlob["validators"][1u]["manifest"] = Json::objectValue;
+        jBlob["validators"][2u]["manifest"] = "!!not base64!!";
+        jBlob["validators"][3u]["manifest"] = base64_encode("garbage");
+        v = verifyValidatorList(signedList(publisher, toJsonLine(jBlob)), 2);
+        BEAST_EXPECT(v.signatureValid);
+        BEAST_EXPECT(v.listed == 6);
+        BEAST_EXPECT(
+            v.effective ==
+            std::vector<PublicKey>(
+                {keys[4].publicKey(), keys[5].publicKey()}));
+        BEAST_EXPECT(
+            v.invalid ==
+            (std::vector<std::pair<std::size_t, std::string>>{
+                {0, "malformed manifest"},
+                {1, "malformed manifest"},
+                {2, "malformed manifest"},
+                {3, "malformed manifest"}}));
+
+        // A changed blob or another publisher key fails the checks
+        auto const good =
+            signedList(publisher, makeListBlob(7, 1000, listed));
+        Json::Value jv;
+        Json::Reader().parse(good, jv);
+        auto changed = jv;
+        changed["blob"] = base64_encode(makeListBlob(8, 1000, listed));
+        v = verifyValidatorList(toJsonLine(changed));
+        BEAST_EXPECT(v.manifestError.empty() && !v.signatureValid);
+
+        changed = jv;
+        changed["public_key"] = strHex(keys[0].publicKey());
+        v = verifyValidatorList(toJsonLine(changed));
+        BEAST_EXPECT(v.manifestError == "manifest of another key");
+        BEAST_EXPECT(!v.signatureValid);
+
+        changed = jv;
+        changed["version"] = 2;
+        BEAST_EXPECT(
+            verifyError(toJsonLine(changed)) ==
+            "Unsupported validator list version");
+        BEAST_EXPECT(
+            verifyError("[]") ==
+            "Malformed validator list: not a JSON object");
+        changed = jv;
+        changed["blob"] = base64_encode("{\"sequence\":1}");
+        BEAST_EXPECT(
+            verifyError(toJsonLine(changed)) ==
+            "Malformed validator list blob: needs sequence, expiration and "
+            "validators");
+    }
+
+public:
+    void
+    run() override
+    {
+        testCheckManifest();
+        testBlob();
+        testWriteList();
+        testVerify();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ValidatorList, keys, xrpl);
+
+}  // namespace tests
+
+}  // namespace xrpl
@@ -0,0 +1,90 @@
+#include <UnitTestRunner.h>
+
+#include <test/Corpus.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+// LCOV_EXCL_START
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+
+    po::options_description general("Unit Test Options");
+    general.add_options()("help,h", "Display this message.")(
+        "unittest,u",
+        po::value<std::string>()->default_value("")->implicit_value(""),
+        "Only run the suites matching the argument.")(
+        "unittest-case",
+        po::value<std::string>()->default_value(""),
+        "Only run unit test cases whose name contains the argument.")(
+        "unittest-jobs",
+        po::value<unsigned>()->default_value(1),
+        "Unit test suites to run concurrently, 0 for one per core.")(
+        "gen-corpus",
+        po::value<std::string>(),
+        "Write a reproducible corpus of key files, manifests, tokens and "
+        "signatures to this directory instead of running tests.")(
+        "corpus-count",
+        po::value<std::size_t>()->default_value(1000),
+        "Number of validators in the corpus.")(
+        "corpus-seed",
+        po::value<std::uint64_t>()->default_value(0),
+        "Seed the corpus is derived from.");
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, general), vm);
+        po::notify(vm);
+    }
+    catch (std::exception const&)
+    {
+        std::cerr << "validator-keys-tests: Incorrect command line syntax."
+                  << std::endl;
+        std::cerr << "Use '--help' for a list of options." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cerr << "validator-keys-tests [options]\n" << general << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    if (vm.count("gen-corpus"))
+    {
+        try
+        {
+            xrpl::tests::generateCorpus(
+                vm["gen-corpus"].as<std::string>(),
+                vm["corpus-count"].as<std::size_t>(),
+                vm["corpus-seed"].as<std::uint64_t>());
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    UnitTestOptions options;
+    options.pattern = vm["unittest"].as<std::string>();
+    options.testCase = vm["unittest-case"].as<std::string>();
+    options.jobs = vm["unittest-jobs"].as<unsigned>();
+
+    // Workers are started from another working directory
+    boost::filesystem::path const program = argv[0];
+    options.program = program.has_parent_path()
+        ? boost::filesystem::absolute(program).string()
+        : program.string();
+
+    return runUnitTests(options);
+}
+// LCOV_EXCL_STOP
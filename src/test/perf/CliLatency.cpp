@@ -0,0 +1,464 @@
+//------------------------------------------------------------------------------
+/*
+    Times complete invocations of the validator-keys command line tool and
+    compares them with a checked-in baseline.
+
+    Unit tests and benchmarks run inside one process. This driver starts the
+    tool once per measurement, so start-up, key file I/O and output are
+    included, and it fails if any command got slower than its baseline by
+    more than the threshold, or has no baseline at all.
+*/
+//==============================================================================
+
+#include <xrpl/json/json_reader.h>
+#include <xrpl/json/json_value.h>
+#include <xrpl/json/to_string.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using boost::filesystem::path;
+
+#ifdef _WIN32
+char const* const nullDevice = "NUL";
+#else
+char const* const nullDevice = "/dev/null";
+#endif
+
+std::string
+quote(std::string const& s)
+{
+    std::string out = "\"";
+    for (auto const c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+/** Runs the tool with the given arguments
+
+    @param output File for standard output, discarded by default
+*/
+void
+run(path const& tool,
+    std::vector<std::string> const& args,
+    std::string const& output = nullDevice)
+{
+    std::string command = quote(tool.string());
+    for (auto const& arg : args)
+        command += " " + quote(arg);
+    command += " >" + quote(output) + " 2>" + nullDevice;
+
+    if (std::system(command.c_str()) != 0)
+        throw std::runtime_error("Command failed: " + command);
+}
+
+/** A command to time
+
+    Before every run the key file fixture, if any, is copied to a fresh
+    directory, so commands that modify the key file start from the same
+    state each time.
+*/
+struct Scenario
+{
+    std::string name;
+    std::vector<std::string> args;
+    std::string fixture;
+};
+
+double
+median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    auto const mid = v.size() / 2;
+    return v.size() % 2 ? v[mid] : (v[mid - 1] + v[mid]) / 2;
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+    using namespace boost::filesystem;
+
+    po::variables_map vm;
+    po::options_description desc("validator-keys-perf options");
+    desc.add_options()("help,h", "Display this message.")(
+        "tool", po::value<std::string>()->required(), "validator-keys binary.")(
+        "baseline",
+        po::value<std::string>()->required(),
+        "Baseline JSON file.")(
+        "threshold",
+        po::value<double>()->default_value(25),
+        "Allowed slowdown over the baseline, in percent.")(
+        "noise",
+        po::value<double>()->default_value(2),
+        "Slowdowns below this many milliseconds are never regressions.")(
+        "iterations",
+        po::value<unsigned>()->default_value(15),
+        "Timed runs per command; the median is compared.")(
+        "update-baseline", "Write the measured times to the baseline.");
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.count("help"))
+        {
+            std::cerr << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << "\n" << desc << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        path const tool = absolute(vm["tool"].as<std::string>());
+        path const baselineFile = vm["baseline"].as<std::string>();
+        auto const threshold = vm["threshold"].as<double>();
+        auto const noise = vm["noise"].as<double>();
+        auto const iterations = std::max(1u, vm["iterations"].as<unsigned>());
+
+        path const work = temp_directory_path() /
+            unique_path("validator-keys-perf-%%%%-%%%%-%%%%");
+        create_directories(work);
+        struct Cleanup
+        {
+            path dir;
+            ~Cleanup()
+            {
+                boost::system::error_code ec;
+                remove_all(dir, ec);
+            }
+        } const cleanup{work};
+
+        // Key file fixtures, made with the tool itself
+        path const fixtures = work / "fixtures";
+        create_directories(fixtures);
+        auto const fixture = [&](std::string const& name) {
+            return (fixtures / (name + ".json")).string();
+        };
+        run(tool, {"--keyfile", fixture("keys"), "create_keys"});
+        copy_file(fixture("keys"), fixture("token"));
+        run(tool, {"--keyfile", fixture("token"), "create_token"});
+        copy_file(fixture("token"), fixture("domain"));
+        run(tool, {"--keyfile", fixture("domain"), "set_domain", "ex.com"});
+
+        // Inputs for the batch commands
+        path const manifests = work / "manifests.txt";
+        path const configs = work / "configs";
+        path const keysDir = work / "keys";
+        create_directories(configs);
+        create_directories(keysDir);
+        path const created = work / "create_token.jsonl";
+        copy_file(fixture("token"), keysDir / "validator.json");
+        run(tool,
+            {"--keyfile",
+             (keysDir / "validator.json").string(),
+             "--format=jsonl",
+             "create_token"},
+            created.string());
+        {
+            Json::Value record;
+            std::ifstream i(created.string());
+            if (!Json::Reader().parse(i, record))
+                throw std::runtime_error("Unable to parse create_token output");
+
+            std::ofstream o(manifests.string());
+            for (int n = 0; n < 1000; ++n)
+                o << record["manifest"].asString() << "\n";
+            std::ofstream((configs / "rippled.cfg").string())
+                << "[validator_token]\n"
+                << record["token"].asString() << "\n";
+        }
+
+        // A fleet of key files with a token each, and a vault, list,
+        // batch and proof made from them
+        path const fleet = work / "fleet";
+        path const listed = work / "listed.txt";
+        path const list = work / "list.json";
+        path const password = work / "password";
+        path const vault = work / "vault";
+        path const records = work / "records.log";
+        path const proofs = work / "records.proofs";
+        std::size_t const fleetSize = 20;
+        run(tool,
+            {"--keyfile-dir",
+             fleet.string(),
+             "--count",
+             std::to_string(fleetSize),
+             "create_keys"});
+        std::vector<std::string> fleetFiles;
+        for (auto const& entry : directory_iterator(fleet))
+            fleetFiles.push_back(entry.path().string());
+        std::sort(fleetFiles.begin(), fleetFiles.end());
+        {
+            std::ofstream o(listed.string());
+            for (auto const& file : fleetFiles)
+            {
+                path const out = work / "token.jsonl";
+                run(tool,
+                    {"--keyfile", file, "--format=jsonl", "create_token"},
+                    out.string());
+                Json::Value record;
+                std::ifstream i(out.string());
+                if (!Json::Reader().parse(i, record))
+                    throw std::runtime_error(
+                        "Unable to parse create_token output");
+                o << record["manifest"].asString() << "\n";
+            }
+        }
+        std::string fleetKey;
+        {
+            path const out = work / "fleet_status.jsonl";
+            run(tool,
+                {"--keyfile-dir",
+                 fleet.string(),
+                 "--format=jsonl",
+                 "fleet_status"},
+                out.string());
+            Json::Value record;
+            std::ifstream i(out.string());
+            std::string line;
+            if (!std::getline(i, line) || !Json::Reader().parse(line, record))
+                throw std::runtime_error(
+                    "Unable to parse fleet_status output");
+            fleetKey = record["public_key"].asString();
+        }
+        std::ofstream(password.string()) << "perf password\n";
+        {
+            std::vector<std::string> args = {
+                "--vault",
+                vault.string(),
+                "--vault-password-file",
+                password.string(),
+                "vault_import"};
+            args.insert(args.end(), fleetFiles.begin(), fleetFiles.end());
+            run(tool, args);
+        }
+        run(tool,
+            {"--keyfile",
+             fixture("token"),
+             "--sequence",
+             "1",
+             "--expiration",
+             "30",
+             "publish_list",
+             listed.string()},
+            list.string());
+        {
+            std::ofstream o(records.string());
+            for (int n = 0; n < 10000; ++n)
+                o << "record " << n << "\n";
+        }
+        run(tool,
+            {"--keyfile",
+             fixture("token"),
+             "--merkle",
+             "sign_batch",
+             records.string()},
+            proofs.string());
+        std::string proof;
+        std::string publicKey;
+        {
+            std::ifstream i(proofs.string());
+            std::getline(i, proof);
+
+            path const out = work / "show_manifest.jsonl";
+            run(tool,
+                {"--keyfile",
+                 fixture("token"),
+                 "--format=jsonl",
+                 "show_manifest",
+                 "base64"},
+                out.string());
+            Json::Value record;
+            std::ifstream s(out.string());
+            if (!Json::Reader().parse(s, record))
+                throw std::runtime_error(
+                    "Unable to parse show_manifest output");
+            publicKey = record["public_key"].asString();
+        }
+
+        // Commands that write somewhere other than the key file write into
+        // the run directory, which is made afresh for every run
+        path const runDir = work / "run";
+        std::vector<std::string> importArgs = {
+            "--vault",
+            (runDir / "vault").string(),
+            "--vault-password-file",
+            password.string(),
+            "vault_import"};
+        importArgs.insert(
+            importArgs.end(), fleetFiles.begin(), fleetFiles.end());
+
+        std::vector<Scenario> const scenarios = {
+            {"create_keys", {"create_keys"}, ""},
+            {"create_token", {"create_token"}, "keys"},
+            {"revoke_keys", {"revoke_keys"}, "token"},
+            {"set_domain", {"set_domain", "example.com"}, "token"},
+            {"clear_domain", {"clear_domain"}, "domain"},
+            {"attest_domain", {"attest_domain"}, "domain"},
+            {"show_manifest", {"show_manifest", "base64"}, "token"},
+            {"sign", {"sign", "data"}, "token"},
+            {"decode_manifest",
+             {"--format=jsonl", "decode_manifest", manifests.string()},
+             ""},
+            {"audit_configs",
+             {"audit_configs",
+              "--configs",
+              configs.string(),
+              "--keys",
+              keysDir.string()},
+             ""},
+            {"create_keys_count",
+             {"--keyfile-dir",
+              (runDir / "fleet").string(),
+              "--count",
+              std::to_string(fleetSize),
+              "create_keys"},
+             ""},
+            {"sign_keyfile_dir",
+             {"--keyfile-dir", fleet.string(), "sign", "data"},
+             ""},
+            {"fleet_status",
+             {"--keyfile-dir", fleet.string(), "fleet_status"},
+             ""},
+            {"find_key",
+             {"--keyfile-dir", fleet.string(), "find_key", fleetKey},
+             ""},
+            {"vault_import", importArgs, ""},
+            {"vault_list",
+             {"--vault",
+              vault.string(),
+              "--vault-password-file",
+              password.string(),
+              "vault_list"},
+             ""},
+            {"sign_batch",
+             {"--merkle", "sign_batch", records.string()},
+             "token"},
+            {"verify_inclusion",
+             {"verify_inclusion", publicKey, proof, "record 0"},
+             ""},
+            {"publish_list",
+             {"--sequence",
+              "2",
+              "--expiration",
+              "30",
+              "publish_list",
+              listed.string()},
+             "token"},
+            {"verify_list", {"verify_list", list.string()}, ""},
+        };
+
+        Json::Value baseline;
+        if (exists(baselineFile))
+        {
+            std::ifstream i(baselineFile.string());
+            if (!Json::Reader().parse(i, baseline) || !baseline.isObject())
+                throw std::runtime_error(
+                    "Unable to parse baseline: " + baselineFile.string());
+        }
+
+        Json::Value measured(Json::objectValue);
+        bool regressed = false;
+        bool missing = false;
+        for (auto const& scenario : scenarios)
+        {
+            std::vector<double> times;
+            // The first run warms the page cache and is not counted
+            for (unsigned i = 0; i <= iterations; ++i)
+            {
+                path const dir = runDir;
+                remove_all(dir);
+                create_directories(dir);
+                path const keyFile = dir / "validator-keys.json";
+                if (!scenario.fixture.empty())
+                    copy_file(fixture(scenario.fixture), keyFile);
+
+                auto args = scenario.args;
+                args.insert(args.begin(), {"--keyfile", keyFile.string()});
+
+                auto const start = std::chrono::steady_clock::now();
+                run(tool, args);
+                std::chrono::duration<double, std::milli> const elapsed =
+                    std::chrono::steady_clock::now() - start;
+                if (i > 0)
+                    times.push_back(elapsed.count());
+            }
+
+            auto const ms = median(times);
+            measured[scenario.name]["median_ms"] = ms;
+
+            std::cout << std::left << std::setw(16) << scenario.name
+                      << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(9) << ms << " ms";
+
+            auto const& base = baseline["commands"][scenario.name];
+            if (base.isObject() && base["median_ms"].isNumeric())
+            {
+                auto const expected = base["median_ms"].asDouble();
+                auto const limit = std::max(
+                    expected * (1 + threshold / 100), expected + noise);
+                std::cout << "  baseline " << std::setw(9) << expected
+                          << " ms";
+                if (ms > limit)
+                {
+                    std::cout << "  REGRESSION (limit " << limit << " ms)";
+                    regressed = true;
+                }
+            }
+            else
+            {
+                std::cout << "  NO BASELINE";
+                missing = true;
+            }
+            std::cout << std::endl;
+        }
+
+        if (vm.count("update-baseline"))
+        {
+            baseline = Json::Value(Json::objectValue);
+            baseline["iterations"] = iterations;
+            baseline["commands"] = measured;
+            std::ofstream o(baselineFile.string());
+            o << to_string(baseline) << "\n";
+            std::cout << "Baseline written to " << baselineFile.string()
+                      << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        // A command without a baseline could get slower unnoticed
+        if (missing)
+            std::cerr << "Commands without a baseline; record one with "
+                         "--update-baseline"
+                      << std::endl;
+
+        return regressed || missing ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}